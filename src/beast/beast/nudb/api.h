@@ -102,6 +102,18 @@ struct api
         return nudb::visit<Codec>(
             path, BufferSize, f);
     }
+
+    template <class Function>
+    static
+    bool
+    visit(
+        path_type const& path,
+        Function&& f,
+        Codec const& codec)
+    {
+        return nudb::visit(
+            path, BufferSize, f, codec);
+    }
 };
 
 } // nudb
@@ -50,7 +50,9 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #if DOXYGEN
 #include <beast/nudb/README.md>
@@ -133,7 +135,8 @@ private:
             path_type const& dp_, path_type const& kp_,
                 path_type const& lp_,
                     detail::key_file_header const& kh_,
-                        std::size_t arena_alloc_size);
+                        std::size_t arena_alloc_size,
+                            Codec const& codec_);
     };
 
     bool open_ = false;
@@ -142,6 +145,8 @@ private:
     //        move construction so we use unique_ptr instead.
     std::unique_ptr <state> s_;     // State of an open database
 
+    Codec codec_;                   // Codec given at construction
+
     std::size_t frac_;              // accumulates load
     std::size_t thresh_;            // split threshold
     std::size_t buckets_;           // number of buckets
@@ -165,6 +170,15 @@ private:
 
 public:
     store() = default;
+
+    /** Create a database which uses a copy of codec.
+
+        The codec is used for all values inserted or
+        fetched while the database is open.
+    */
+    explicit
+    store (Codec const& codec);
+
     store (store const&) = delete;
     store& operator= (store const&) = delete;
 
@@ -253,6 +267,24 @@ public:
     bool
     fetch (void const* key, Handler&& handler);
 
+    /** Fetch a batch of values.
+
+        Keys which are not in memory are grouped by bucket, so
+        each bucket is read once and in file order.
+
+        For each key found, Handler will be called as:
+            `(void)()(std::size_t i, void const* data, std::size_t size)`
+
+        where i is the index of the key in the array and data and
+        size represent the value.
+
+        @return The number of keys found.
+    */
+    template <class Handler>
+    std::size_t
+    fetch_batch (std::size_t n, void const* const* keys,
+        Handler&& handler);
+
     /** Insert a value.
 
         Returns:
@@ -310,7 +342,8 @@ store<Hasher, Codec, File>::state::state (
         path_type const& dp_, path_type const& kp_,
             path_type const& lp_,
                 detail::key_file_header const& kh_,
-                    std::size_t arena_alloc_size)
+                    std::size_t arena_alloc_size,
+                        Codec const& codec_)
     : df (std::move(df_))
     , kf (std::move(kf_))
     , lf (std::move(lf_))
@@ -321,12 +354,19 @@ store<Hasher, Codec, File>::state::state (
     , p1 (kh_.key_size, arena_alloc_size)
     , c0 (kh_.key_size, kh_.block_size)
     , c1 (kh_.key_size, kh_.block_size)
+    , codec (codec_)
     , kh (kh_)
 {
 }
 
 //------------------------------------------------------------------------------
 
+template <class Hasher, class Codec, class File>
+store<Hasher, Codec, File>::store (Codec const& codec)
+    : codec_ (codec)
+{
+}
+
 template <class Hasher, class Codec, class File>
 store<Hasher, Codec, File>::~store()
 {
@@ -378,7 +418,7 @@ store<Hasher, Codec, File>::open (
     auto s = std::make_unique<state>(
         std::move(df), std::move(kf), std::move(lf),
             dat_path, key_path, log_path, kh,
-                arena_alloc_size);
+                arena_alloc_size, codec_);
     thresh_ = std::max<std::size_t>(65536UL,
         kh.load_factor * kh.capacity);
     frac_ = thresh_ / 2;
@@ -459,6 +499,94 @@ next:
     return fetch(h, key, b, handler);
 }
 
+template <class Hasher, class Codec, class File>
+template <class Handler>
+std::size_t
+store<Hasher, Codec, File>::fetch_batch (
+    std::size_t n, void const* const* keys,
+        Handler&& handler)
+{
+    using namespace detail;
+    rethrow();
+    std::size_t found = 0;
+    // Bucket index, hash and key index
+    // of each key not in the pools
+    using entry = std::tuple<std::size_t,
+        std::size_t, std::size_t>;
+    std::vector<entry> v;
+    v.reserve(n);
+    shared_lock_type m (m_);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto iter = s_->p1.find(keys[i]);
+        if (iter == s_->p1.end())
+        {
+            iter = s_->p0.find(keys[i]);
+            if (iter == s_->p0.end())
+            {
+                auto const h = hash<Hasher>(
+                    keys[i], s_->kh.key_size, s_->kh.salt);
+                v.emplace_back(bucket_index(
+                    h, buckets_, modulus_), h, i);
+                continue;
+            }
+        }
+        buffer buf;
+        auto const result =
+            s_->codec.decompress(
+                iter->first.data,
+                    iter->first.size, buf);
+        handler(i, result.first, result.second);
+        ++found;
+    }
+    if (v.empty())
+        return found;
+    std::sort(v.begin(), v.end());
+    auto const fetch_one =
+        [&](entry const& e, bucket const& b)
+        {
+            auto const i = std::get<2>(e);
+            if (fetch(std::get<1>(e), keys[i], b,
+                [&](void const* data, std::size_t size)
+                {
+                    handler(i, data, size);
+                }))
+                ++found;
+        };
+    // Keys in cached buckets
+    auto last = v.begin();
+    for (auto const& e : v)
+    {
+        auto const iter = s_->c1.find(std::get<0>(e));
+        if (iter != s_->c1.end())
+            fetch_one(e, iter->second);
+        else
+            *last++ = e;
+    }
+    v.erase(last, v.end());
+    if (v.empty())
+        return found;
+    // VFALCO Audit for concurrency
+    genlock <gentex> g (g_);
+    m.unlock();
+    buffer buf (s_->kh.block_size);
+    bucket b (s_->kh.block_size,
+        buf.get());
+    std::size_t loaded = 0;
+    for (auto const& e : v)
+    {
+        auto const bn = std::get<0>(e);
+        if (loaded != bn + 1)
+        {
+            b.read (s_->kf,
+                (bn + 1) * b.block_size());
+            loaded = bn + 1;
+        }
+        fetch_one(e, b);
+    }
+    return found;
+}
+
 template <class Hasher, class Codec, class File>
 bool
 store<Hasher, Codec, File>::insert (
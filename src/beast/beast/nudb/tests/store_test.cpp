@@ -28,6 +28,7 @@
 #include <memory>
 #include <random>
 #include <utility>
+#include <vector>
 
 namespace beast {
 namespace nudb {
@@ -99,6 +100,32 @@ public:
                 expect (db.insert(&v.key, v.data, v.size),
                     "insert 2");
             }
+            // fetch batch, the last N are missing
+            {
+                std::vector<key_type> keys;
+                keys.reserve(3 * N);
+                for (std::size_t i = 0; i < 3 * N; ++i)
+                    keys.push_back(seq[i].key);
+                std::vector<void const*> pk;
+                for (auto const& key : keys)
+                    pk.push_back(&key);
+                std::vector<std::size_t> seen(3 * N);
+                auto const found = db.fetch_batch(
+                    pk.size(), pk.data(),
+                    [&](std::size_t i,
+                        void const* data, std::size_t size)
+                    {
+                        auto const v = seq[i];
+                        ++seen[i];
+                        expect (size == v.size, "wrong size");
+                        expect (std::memcmp(data,
+                            v.data, v.size) == 0, "wrong data");
+                    });
+                expect (found == 2 * N, "wrong count");
+                for (std::size_t i = 0; i < 3 * N; ++i)
+                    expect (seen[i] == (i < 2 * N ? 1 : 0),
+                        "wrong batch");
+            }
             db.close();
             //auto const stats = test_api::verify(dp, kp);
             auto const stats = verify<test_api::hash_type>(
@@ -40,6 +40,8 @@ namespace nudb {
 
     If Function returns false, the visit is terminated.
 
+    Values are decompressed using a copy of codec.
+
     @return `true` if the visit completed
     This only requires the data file.
 */
@@ -48,7 +50,8 @@ bool
 visit(
     path_type const& path,
     std::size_t read_size,
-    Function&& f)
+    Function&& f,
+    Codec const& codec)
 {
     using namespace detail;
     using File = native_file;
@@ -57,7 +60,6 @@ visit(
     dat_file_header dh;
     read (df, dh);
     verify (dh);
-    Codec codec;
     // Iterate Data File
     bulk_reader<File> r(
         df, dat_file_header::size,
@@ -105,6 +107,20 @@ visit(
     return true;
 }
 
+/** Visit each key/data pair in a database file.
+
+    This uses a default constructed Codec.
+*/
+template <class Codec, class Function>
+bool
+visit(
+    path_type const& path,
+    std::size_t read_size,
+    Function&& f)
+{
+    return visit(path, read_size, f, Codec{});
+}
+
 } // nudb
 } // beast
 
@@ -28,8 +28,10 @@
 #include <ripple/basics/Log.h>
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/core/Config.h>
+#include <ripple/protocol/TER.h>
 #include <beast/container/aged_unordered_map.h>
 #include <beast/utility/Journal.h>
+#include <boost/optional.hpp>
 #include <cassert>
 #include <mutex>
 
@@ -47,6 +49,56 @@ using OrderedTxs = CanonicalTXSet;
 
 //------------------------------------------------------------------------------
 
+/** Remembers preflight results by transaction ID.
+
+    Preflight, which includes checking the signature, depends only
+    on the transaction, the rules and the apply flags. Transactions
+    carried from one open ledger to the next are checked once while
+    the rules stay the same.
+
+    Results not used between two calls to rotate() are dropped.
+*/
+class PreflightCache
+{
+private:
+    struct Entry
+    {
+        TER result;
+        ApplyFlags flags;
+    };
+
+    std::mutex mutable mutex_;
+    boost::optional<Rules> rules_;
+    hash_map<uint256, Entry> recent_;
+    hash_map<uint256, Entry> current_;
+    std::size_t hits_ = 0;
+
+public:
+    /** Start building a new open ledger.
+
+        Drops the results not used since the last call, or all
+        of them if the rules changed.
+    */
+    void
+    rotate (Rules const& rules);
+
+    /** Preflight a transaction, reusing an earlier result. */
+    TER
+    preflight (Rules const& rules, STTx const& tx,
+        ApplyFlags flags, SigVerify verify,
+            Config const& config, beast::Journal j);
+
+    /** Returns the number of results held. */
+    std::size_t
+    size() const;
+
+    /** Returns the number of results reused. */
+    std::size_t
+    hits() const;
+};
+
+//------------------------------------------------------------------------------
+
 /** Represents the open ledger. */
 class OpenLedger
 {
@@ -57,6 +109,7 @@ private:
     std::mutex mutable modify_mutex_;
     std::mutex mutable current_mutex_;
     std::shared_ptr<OpenView const> current_;
+    PreflightCache preflights_;
 
 public:
     OpenLedger() = delete;
@@ -158,6 +211,9 @@ public:
 
         This has the retry logic and ordering semantics
         used for consensus and building the open ledger.
+
+        If `preflights` is not null, preflight results
+        are taken from it when possible.
     */
     template <class FwdRange>
     static
@@ -165,7 +221,8 @@ public:
     apply (OpenView& view, ReadView const& check,
         FwdRange const& txs, OrderedTxs& retries,
             ApplyFlags flags, HashRouter& router,
-                Config const& config, beast::Journal j);
+                Config const& config, beast::Journal j,
+                    PreflightCache* preflights = nullptr);
 
 private:
     enum Result
@@ -184,7 +241,13 @@ private:
     apply_one (OpenView& view, std::shared_ptr<
         STTx const> const& tx, bool retry,
             ApplyFlags flags, HashRouter& router,
-                Config const& config, beast::Journal j);
+                Config const& config, beast::Journal j,
+                    PreflightCache* preflights);
+
+    // Returns the result of a transaction which wasn't applied
+    static
+    Result
+    classify (TER ter);
 
 public:
     //--------------------------------------------------------------------------
@@ -206,7 +269,7 @@ OpenLedger::apply (OpenView& view,
     ReadView const& check, FwdRange const& txs,
         OrderedTxs& retries, ApplyFlags flags,
             HashRouter& router, Config const& config,
-                beast::Journal j)
+                beast::Journal j, PreflightCache* preflights)
 {
     for (auto iter = txs.begin();
         iter != txs.end(); ++iter)
@@ -219,7 +282,8 @@ OpenLedger::apply (OpenView& view,
             if (check.txExists(tx->getTransactionID()))
                 continue;
             auto const result = apply_one(view,
-                tx, true, flags, router, config, j);
+                tx, true, flags, router, config, j,
+                    preflights);
             if (result == Result::retry)
                 retries.insert(tx);
         }
@@ -240,7 +304,7 @@ OpenLedger::apply (OpenView& view,
         {
             switch (apply_one(view,
                 iter->second, retry, flags,
-                    router, config, j))
+                    router, config, j, preflights))
             {
             case Result::success:
                 ++changes;
@@ -33,6 +33,7 @@
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/protocol/JsonFields.h>
 #include <ripple/nodestore/Database.h>
+#include <ripple/nodestore/ScopedReadPriority.h>
 
 namespace ripple {
 
@@ -388,11 +389,33 @@ bool InboundLedger::addOnComplete (
     return true;
 }
 
+// The priority of the node store reads made to find missing nodes
+static
+NodeStore::ReadPriority
+readPriority (InboundLedger::fcReason reason)
+{
+    switch (reason)
+    {
+    case InboundLedger::fcHISTORY:
+        return NodeStore::readBackground;
+
+    case InboundLedger::fcVALIDATION:
+    case InboundLedger::fcCURRENT:
+    case InboundLedger::fcCONSENSUS:
+        return NodeStore::readUrgent;
+
+    default:
+        break;
+    }
+    return NodeStore::readNormal;
+}
+
 /** Request more nodes, perhaps from a specific peer
 */
 void InboundLedger::trigger (Peer::ptr const& peer)
 {
     ScopedLockType sl (mLock);
+    NodeStore::ScopedReadPriority priority (readPriority (mReason));
 
     if (isDone ())
     {
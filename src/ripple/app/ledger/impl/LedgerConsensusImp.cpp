@@ -31,6 +31,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/Validations.h>
+#include <ripple/app/tx/ParallelApply.h>
 #include <ripple/app/tx/TransactionAcquire.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/CountedObject.h>
@@ -1034,9 +1035,11 @@ void LedgerConsensusImp::accept (std::shared_ptr<SHAMap> set)
     newLCL->updateSkipList ();
 
     int asf = newLCL->stateMap().flushDirty (
-        hotACCOUNT_NODE, newLCL->info().seq);
+        hotACCOUNT_NODE, newLCL->info().seq,
+            getConfig().LEDGER_FLUSH_THREADS);
     int tmf = newLCL->txMap().flushDirty (
-        hotTRANSACTION_NODE, newLCL->info().seq);
+        hotTRANSACTION_NODE, newLCL->info().seq,
+            getConfig().LEDGER_FLUSH_THREADS);
     WriteLog (lsDEBUG, LedgerConsensus) << "Flushed " <<
         asf << " accounts and " <<
         tmf << " transaction nodes";
@@ -1876,6 +1879,7 @@ void applyTransactions (
 {
     if (set)
     {
+        std::vector<std::shared_ptr<STTx const>> txns;
         for (auto const& item : *set)
         {
             if (checkLedger->txExists (item.key()))
@@ -1884,27 +1888,38 @@ void applyTransactions (
             // The transaction isn't in the check ledger, try to apply it
             WriteLog (lsDEBUG, LedgerConsensus) <<
                 "Processing candidate transaction: " << item.key();
-            std::shared_ptr<STTx const> txn;
             try
             {
-                txn = std::make_shared<STTx const>(SerialIter{item.slice()});
+                txns.push_back (std::make_shared<STTx const>(
+                    SerialIter{item.slice()}));
             }
             catch (...)
             {
                 WriteLog (lsWARNING, LedgerConsensus) << "  Throws";
             }
+        }
 
-            if (txn)
+        ParallelApply parallel (
+            [flags](OpenView& v, std::shared_ptr<STTx const> const& txn)
             {
-                if (applyTransaction(view, txn, true, flags) ==
-                    LedgerConsensusImp::resultRetry)
-                {
-                    // On failure, stash the failed transaction for
-                    // later retry.
-                    retriableTransactions.insert (txn);
-                }
+                return applyTransaction (v, txn, true, flags);
+            }, getConfig().LEDGER_APPLY_THREADS);
+        auto const results = parallel (view, txns);
+
+        for (std::size_t i = 0; i < txns.size (); ++i)
+        {
+            if (results[i] == LedgerConsensusImp::resultRetry)
+            {
+                // On failure, stash the failed transaction for
+                // later retry.
+                retriableTransactions.insert (txns[i]);
             }
         }
+
+        if (parallel.reapplied () != 0)
+            WriteLog (lsDEBUG, LedgerConsensus) << "Reapplied " <<
+                parallel.reapplied () << " of " << txns.size () <<
+                    " transactions";
     }
 
     bool certainRetry = true;
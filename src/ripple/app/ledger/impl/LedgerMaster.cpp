@@ -25,6 +25,7 @@
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/ledger/impl/LedgerCleaner.h>
+#include <ripple/app/ledger/impl/LedgerPrefetcher.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/AmendmentTable.h>
@@ -138,6 +139,9 @@ public:
 
     std::uint32_t fetch_seq_;
 
+    // Loads nodes the next open ledger is likely to need
+    LedgerPrefetcher prefetcher_;
+
     //--------------------------------------------------------------------------
 
     LedgerMasterImp (Config const& config, Stopwatch& stopwatch,
@@ -170,6 +174,8 @@ public:
         , fetch_packs_ ("FetchPack", 65536, 45, stopwatch,
             deprecatedLogs().journal("TaggedCache"))
         , fetch_seq_ (0)
+        , prefetcher_ (getApp().getJobQueue (),
+            deprecatedLogs().journal("LedgerPrefetcher"))
     {
     }
 
@@ -353,6 +359,8 @@ public:
             mCurrentLedger.set (newOL);
         }
 
+        prefetcher_.onLedgerClosed (newLCL);
+
         if (standalone_)
         {
             setFullLedger(newLCL, true, false);
@@ -379,6 +387,7 @@ public:
 
             assert (current->info().open);
         }
+        prefetcher_.onLedgerClosed (lastClosed);
         checkAccept (lastClosed);
     }
 
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/ledger/impl/LedgerPrefetcher.h>
+#include <ripple/protocol/SField.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
+#include <algorithm>
+
+namespace ripple {
+
+LedgerPrefetcher::LedgerPrefetcher (
+        JobQueue& jobQueue, beast::Journal journal)
+    : jobQueue_ (jobQueue)
+    , journal_ (journal)
+{
+}
+
+void
+LedgerPrefetcher::onLedgerClosed (
+    std::shared_ptr<Ledger const> const& ledger)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    pending_ = ledger;
+    ++generation_;
+    if (running_)
+        return;
+    running_ = true;
+    jobQueue_.addJob (jtPREFETCH, "prefetchLedger",
+        [this] (Job&) { run (); });
+}
+
+std::vector<uint256>
+LedgerPrefetcher::touchedKeys (ReadView const& ledger, std::size_t maxKeys)
+{
+    std::vector<uint256> keys;
+    for (auto const& item : ledger.txs)
+    {
+        auto const& meta = item.second;
+        if (! meta || ! meta->isFieldPresent (sfAffectedNodes))
+            continue;
+        for (auto const& node : meta->getFieldArray (sfAffectedNodes))
+        {
+            if (node.getFName () != sfDeletedNode)
+                keys.push_back (node.getFieldH256 (sfLedgerIndex));
+        }
+    }
+    std::sort (keys.begin (), keys.end ());
+    keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+
+    // Keys are hashes, so dropping the highest ones
+    // leaves an unbiased sample.
+    if (keys.size () > maxKeys)
+        keys.resize (maxKeys);
+    return keys;
+}
+
+void
+LedgerPrefetcher::run ()
+{
+    for (;;)
+    {
+        std::shared_ptr<Ledger const> ledger;
+        std::uint32_t generation;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            ledger = std::move (pending_);
+            pending_.reset ();
+            if (! ledger)
+            {
+                running_ = false;
+                return;
+            }
+            generation = generation_;
+        }
+
+        try
+        {
+            auto touched = touchedKeys (*ledger, maxKeysPerLedger);
+
+            std::vector<uint256> keys;
+            {
+                std::lock_guard<std::mutex> lock (mutex_);
+                recent_.push_front (std::move (touched));
+                while (recent_.size () > ledgerCount)
+                    recent_.pop_back ();
+                for (auto const& v : recent_)
+                    keys.insert (keys.end (), v.begin (), v.end ());
+            }
+            std::sort (keys.begin (), keys.end ());
+            keys.erase (std::unique (keys.begin (), keys.end ()), keys.end ());
+
+            prefetch (*ledger, keys, generation);
+        }
+        catch (std::exception const& e)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Prefetch for ledger " << ledger->info().seq <<
+                    " failed: " << e.what ();
+        }
+    }
+}
+
+// Keys are visited in order, so paths which share
+// inner nodes are walked one after the other.
+void
+LedgerPrefetcher::prefetch (Ledger const& ledger,
+    std::vector<uint256> const& keys, std::uint32_t generation)
+{
+    auto const& map = ledger.stateMap ();
+    std::size_t visited = 0;
+    try
+    {
+        for (auto const& key : keys)
+        {
+            // A newer ledger has closed
+            if (generation_ != generation)
+                break;
+            map.hasItem (key);
+            ++visited;
+        }
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        // The ledger isn't complete locally, so give up on it
+        if (journal_.debug) journal_.debug <<
+            "Prefetch for ledger " << ledger.info().seq <<
+                " stopped: " << e;
+    }
+
+    if (journal_.trace) journal_.trace <<
+        "Prefetched " << visited << " of " << keys.size () <<
+            " entries in ledger " << ledger.info().seq;
+}
+
+} // ripple
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_LEDGERPREFETCHER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERPREFETCHER_H_INCLUDED
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/core/JobQueue.h>
+#include <beast/utility/Journal.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Loads state nodes which the next ledgers are likely to need.
+
+    Transactions tend to touch the same accounts and offers as the
+    transactions in the ledgers just before them. Each time a ledger
+    closes, the keys of the state entries created or modified by its
+    transactions are remembered, and a background job walks the new
+    ledger's state map to the entries touched in the last few ledgers.
+
+    Walking a path brings any inner and leaf nodes which were not in
+    memory in from the node store, so transactions applied to the next
+    open ledger find them without a synchronous read.
+
+    Thread safety:
+        Safe to call from any thread at any time.
+*/
+class LedgerPrefetcher
+{
+public:
+    enum
+    {
+        // Number of recent ledgers whose keys are prefetched
+        ledgerCount = 8,
+
+        // Most keys remembered from one ledger
+        maxKeysPerLedger = 4096
+    };
+
+    LedgerPrefetcher (JobQueue& jobQueue, beast::Journal journal);
+
+    LedgerPrefetcher (LedgerPrefetcher const&) = delete;
+    LedgerPrefetcher& operator= (LedgerPrefetcher const&) = delete;
+
+    /** Prefetch for the ledger that follows a closed ledger.
+        A prefetch still running for an older ledger is cut short.
+    */
+    void
+    onLedgerClosed (std::shared_ptr<Ledger const> const& ledger);
+
+    /** Returns the keys of the state entries a ledger's
+        transactions created or modified, without duplicates.
+    */
+    static
+    std::vector<uint256>
+    touchedKeys (ReadView const& ledger, std::size_t maxKeys);
+
+private:
+    void
+    run ();
+
+    void
+    prefetch (Ledger const& ledger, std::vector<uint256> const& keys,
+        std::uint32_t generation);
+
+    JobQueue& jobQueue_;
+    beast::Journal journal_;
+
+    std::mutex mutex_;
+    std::shared_ptr<Ledger const> pending_;
+    std::deque<std::vector<uint256>> recent_;
+    bool running_ = false;
+    std::atomic<std::uint32_t> generation_ {0};
+};
+
+} // ripple
+
+#endif
@@ -25,6 +25,80 @@
 
 namespace ripple {
 
+void
+PreflightCache::rotate (Rules const& rules)
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    if (rules_ && *rules_ == rules)
+    {
+        recent_.swap(current_);
+        current_.clear();
+        return;
+    }
+    rules_.emplace(rules);
+    recent_.clear();
+    current_.clear();
+}
+
+TER
+PreflightCache::preflight (Rules const& rules,
+    STTx const& tx, ApplyFlags flags, SigVerify verify,
+        Config const& config, beast::Journal j)
+{
+    // Only the last pass is affected by tapRETRY
+    flags = static_cast<ApplyFlags>(flags & ~tapRETRY);
+    auto const id = tx.getTransactionID();
+    {
+        std::lock_guard<
+            std::mutex> lock(mutex_);
+        if (! rules_ || *rules_ != rules)
+            return ripple::preflight(rules,
+                tx, flags, verify, config, j);
+        auto iter = current_.find(id);
+        if (iter == current_.end())
+        {
+            auto const old = recent_.find(id);
+            if (old != recent_.end())
+                iter = current_.insert(*old).first;
+        }
+        if (iter != current_.end() &&
+            iter->second.flags == flags)
+        {
+            ++hits_;
+            return iter->second.result;
+        }
+    }
+    auto const result = ripple::preflight(
+        rules, tx, flags, verify, config, j);
+    if (result != tefEXCEPTION)
+    {
+        std::lock_guard<
+            std::mutex> lock(mutex_);
+        if (rules_ && *rules_ == rules)
+            current_[id] = { result, flags };
+    }
+    return result;
+}
+
+std::size_t
+PreflightCache::size() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return current_.size() + recent_.size();
+}
+
+std::size_t
+PreflightCache::hits() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return hits_;
+}
+
+//------------------------------------------------------------------------------
+
 OpenLedger::OpenLedger(std::shared_ptr<
     Ledger const> const& ledger,
         Config const& config, CachedSLEs& cache,
@@ -82,6 +156,7 @@ OpenLedger::accept(Rules const& rules,
     JLOG(j_.error) <<
         "accept ledger " << ledger->seq() << " " << suffix;
     auto next = create(rules, ledger);
+    preflights_.rotate(rules);
     if (retriesFirst)
     {
         // Handle disputed tx, outside lock
@@ -89,7 +164,8 @@ OpenLedger::accept(Rules const& rules,
             std::vector<std::shared_ptr<
                 STTx const>>;
         apply (*next, *ledger, empty{},
-            retries, flags, router, config_, j_);
+            retries, flags, router, config_, j_,
+                &preflights_);
     }
     // Block calls to modify, otherwise
     // new tx going into the open ledger
@@ -107,12 +183,17 @@ OpenLedger::accept(Rules const& rules,
             {
                 return p.first;
             }),
-                retries, flags, router, config_, j_);
+                retries, flags, router, config_, j_,
+                    &preflights_);
     // Apply local tx
     for (auto const& item : locals)
-        ripple::apply(*next, *item.second,
-            flags, router.sigVerify(),
-                config_, j_);
+    {
+        if (preflights_.preflight(next->rules(),
+                *item.second, flags, router.sigVerify(),
+                    config_, j_) == tesSUCCESS)
+            doapply(*next, *item.second,
+                flags, config_, j_);
+    }
     // Switch to the new open view
     std::lock_guard<
         std::mutex> lock2(current_mutex_);
@@ -136,7 +217,7 @@ OpenLedger::apply_one (OpenView& view,
     std::shared_ptr<STTx const> const& tx,
         bool retry, ApplyFlags flags,
             HashRouter& router, Config const& config,
-                beast::Journal j) -> Result
+                beast::Journal j, PreflightCache* preflights) -> Result
 {
     if (retry)
         flags = flags | tapRETRY;
@@ -144,14 +225,38 @@ OpenLedger::apply_one (OpenView& view,
         tx->getTransactionID()) & SF_SIGGOOD) ==
             SF_SIGGOOD)
         flags = flags | tapNO_CHECK_SIGN;
-    auto const result = ripple::apply(
-        view, *tx, flags, router.
-            sigVerify(), config, j);
+    auto const pfresult = preflights ?
+        preflights->preflight(view.rules(), *tx,
+            flags, router.sigVerify(), config, j) :
+        ripple::preflight(view.rules(), *tx,
+            flags, router.sigVerify(), config, j);
+    if (pfresult != tesSUCCESS)
+        return classify(pfresult);
+    // Once the account exists, its sequence is the first
+    // thing the transactor checks. When that fails, the
+    // result is known without building the transactor.
+    if (auto const sle = view.read(keylet::account(
+        tx->getAccountID(sfAccount))))
+    {
+        auto const seq = sle->getFieldU32(sfSequence);
+        if (seq > tx->getSequence())
+            return Result::failure;
+        if (seq < tx->getSequence())
+            return Result::retry;
+    }
+    auto const result = doapply(
+        view, *tx, flags, config, j);
     if (result.second)
         return Result::success;
-    if (isTefFailure (result.first) ||
-        isTemMalformed (result.first) ||
-            isTelLocal (result.first))
+    return classify(result.first);
+}
+
+auto
+OpenLedger::classify (TER ter) -> Result
+{
+    if (isTefFailure (ter) ||
+        isTemMalformed (ter) ||
+            isTelLocal (ter))
         return Result::failure;
     return Result::retry;
 }
@@ -56,6 +56,7 @@
 #include <ripple/ledger/CachedSLEs.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Importer.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/overlay/make_Overlay.h>
 #include <ripple/protocol/Indexes.h>
@@ -63,6 +64,7 @@
 #include <ripple/protocol/STParsedJSON.h>
 #include <ripple/protocol/types.h>
 #include <ripple/server/make_ServerHandler.h>
+#include <ripple/shamap/CacheSnapshot.h>
 #include <ripple/shamap/Family.h>
 #include <ripple/unity/git_id.h>
 #include <ripple/websocket/MakeServer.h>
@@ -71,6 +73,7 @@
 #include <beast/module/core/text/LexicalCast.h>
 #include <beast/module/core/thread/DeadlineTimer.h>
 #include <boost/asio/signal_set.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/optional.hpp>
 #include <fstream>
 
@@ -266,6 +269,12 @@ public:
     NodeStoreScheduler m_nodeStoreScheduler;
     std::unique_ptr <SHAMapStore> m_shaMapStore;
     std::unique_ptr <NodeStore::Database> m_nodeStore;
+
+    // An import which runs while the server does
+    NodeStore::DummyScheduler m_importScheduler;
+    std::unique_ptr <NodeStore::Database> m_importSource;
+    std::unique_ptr <NodeStore::Importer> m_importer;
+
     PendingSaves pendingSaves_;
     AccountIDCache accountIDCache_;
     boost::optional<OpenLedger> openLedger_;
@@ -274,6 +283,7 @@ public:
     NodeCache m_tempNodeCache;
     std::unique_ptr <CollectorManager> m_collectorManager;
     detail::AppFamily family_;
+    std::unique_ptr <CacheSnapshot> m_cacheSnapshot;
     CachedSLEs cachedSLEs_;
     LocalCredentials m_localCredentials;
 
@@ -800,6 +810,20 @@ public:
         family().treecache().setTargetSize (getConfig ().getSize (siTreeCacheSize));
         family().treecache().setTargetAge (getConfig ().getSize (siTreeCacheAge));
 
+        // Bring back the nodes that were cached when the server stopped
+        std::string snapshot;
+        if (get_if_exists (getConfig ()[ConfigSection::nodeDatabase ()],
+            "warm_cache", snapshot))
+        {
+            m_cacheSnapshot = std::make_unique <CacheSnapshot> (
+                family_, snapshot, deprecatedLogs().journal("SHAMap"));
+            m_networkOPs->setWarmingCache (true);
+            m_cacheSnapshot->start ([this]
+            {
+                m_networkOPs->setWarmingCache (false);
+            });
+        }
+
         //----------------------------------------------------------------------
         //
         // Server
@@ -910,6 +934,27 @@ public:
 
         m_entropyTimer.cancel ();
 
+        // Progress is kept in the checkpoint for the next start
+        if (m_importer)
+        {
+            m_importer->stop ();
+            m_importer->wait ();
+        }
+
+        if (m_cacheSnapshot)
+        {
+            m_cacheSnapshot->stop ();
+            m_cacheSnapshot->wait ();
+            try
+            {
+                m_cacheSnapshot->save ();
+            }
+            catch (std::exception const& e)
+            {
+                m_journal.warning << e.what ();
+            }
+        }
+
         mValidations->flush ();
 
         m_overlay->saveValidatorKeyManifests (getWalletDB ());
@@ -1523,17 +1568,41 @@ void ApplicationImp::updateTables ()
 
     if (getConfig ().doImport)
     {
-        NodeStore::DummyScheduler scheduler;
-        std::unique_ptr <NodeStore::Database> source =
-            NodeStore::Manager::instance().make_Database ("NodeStore.import", scheduler,
-                deprecatedLogs().journal("NodeObject"), 0,
-                getConfig ()[ConfigSection::importNodeDatabase ()]);
+        auto const& section = getConfig ()[ConfigSection::importNodeDatabase ()];
+        m_importSource = NodeStore::Manager::instance().make_Database (
+            "NodeStore.import", m_importScheduler,
+                deprecatedLogs().journal("NodeObject"), 0, section);
 
         WriteLog (lsWARNING, NodeObject) <<
-            "Node import from '" << source->getName () << "' to '"
+            "Node import from '" << m_importSource->getName () << "' to '"
                                  << getApp().getNodeStore().getName () << "'.";
 
-        getApp().getNodeStore().import (*source);
+        // By default the checkpoint is kept with the node database
+        auto setup = NodeStore::setup_Importer (section);
+        std::string path;
+        if (setup.checkpoint.empty () && get_if_exists (
+            getConfig ()[ConfigSection::nodeDatabase ()], "path", path))
+        {
+            setup.checkpoint = (boost::filesystem::path (path) /
+                "import.checkpoint").string ();
+        }
+
+        m_importer = std::make_unique <NodeStore::Importer> (
+            *m_importSource, getApp().getNodeStore(), setup,
+                deprecatedLogs().journal("NodeObject"));
+
+        bool online = false;
+        get_if_exists (section, "online", online);
+        if (online)
+        {
+            m_importer->start ();
+        }
+        else
+        {
+            m_importer->run ();
+            m_importer.reset ();
+            m_importSource.reset ();
+        }
     }
 }
 
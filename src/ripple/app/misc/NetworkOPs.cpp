@@ -126,6 +126,7 @@ public:
         , mMode (omDISCONNECTED)
         , mNeedNetworkLedger (false)
         , m_amendmentBlocked (false)
+        , mWarmingCache (false)
         , m_heartbeatTimer (this)
         , m_clusterTimer (this)
         , mConsensus (make_Consensus ())
@@ -275,6 +276,10 @@ public:
         return m_amendmentBlocked;
     }
     void setAmendmentBlocked () override;
+    void setWarmingCache (bool warming) override
+    {
+        mWarmingCache = warming;
+    }
     void consensusViewChange () override;
     void setLastCloseTime (std::uint32_t t) override
     {
@@ -440,6 +445,7 @@ private:
 
     std::atomic <bool> mNeedNetworkLedger;
     bool m_amendmentBlocked;
+    std::atomic <bool> mWarmingCache;
 
     beast::DeadlineTimer m_heartbeatTimer;
     beast::DeadlineTimer m_clusterTimer;
@@ -1606,7 +1612,7 @@ void NetworkOPsImp::setMode (OperatingMode om)
             om = omCONNECTED;
     }
 
-    if ((om > omTRACKING) && m_amendmentBlocked)
+    if ((om > omTRACKING) && (m_amendmentBlocked || mWarmingCache))
         om = omTRACKING;
 
     if (mMode == om)
@@ -1926,6 +1932,9 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
     if (m_amendmentBlocked)
         info[jss::amendment_blocked] = true;
 
+    if (mWarmingCache)
+        info[jss::warming_cache] = true;
+
     auto const fp = m_ledgerMaster.getFetchPackCacheSize ();
 
     if (fp != 0)
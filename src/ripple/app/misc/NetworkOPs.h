@@ -172,6 +172,10 @@ public:
     virtual bool isFull () = 0;
     virtual bool isAmendmentBlocked () = 0;
     virtual void setAmendmentBlocked () = 0;
+    /** Keep the server from reporting itself full while the
+        caches are warmed after a restart.
+    */
+    virtual void setWarmingCache (bool warming) = 0;
     virtual void consensusViewChange () = 0;
 
     // FIXME(NIKB): Remove the need for this function
@@ -48,6 +48,10 @@ public:
         std::uint32_t deleteBatch = 100;
         std::uint32_t backOff = 100;
         std::int32_t ageThreshold = 60;
+        bool incrementalCopy = false;
+        std::uint32_t ioReadTarget = 20;
+        Section shardDatabase;
+        Section fastDatabase;
     };
 
     SHAMapStore (Stoppable& parent) : Stoppable ("SHAMapStore", parent) {}
@@ -71,6 +75,9 @@ public:
 
     /** Highest ledger that may be deleted. */
     virtual LedgerIndex getCanDelete() = 0;
+
+    /** The store of ledger shards, or nullptr if there is no [shard_db]. */
+    virtual NodeStore::DatabaseShard* getShardStore() = 0;
 };
 
 //------------------------------------------------------------------------------
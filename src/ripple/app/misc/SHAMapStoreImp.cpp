@@ -160,6 +160,16 @@ SHAMapStoreImp::SavedStateDB::setLastRotated (LedgerIndex seq)
             ;
 }
 
+static
+IOBudget::Setup
+setup_IOBudget (SHAMapStore::Setup const& s)
+{
+    IOBudget::Setup setup;
+    setup.readTarget = std::chrono::milliseconds (s.ioReadTarget);
+    setup.initialDelay = std::chrono::milliseconds (s.backOff);
+    return setup;
+}
+
 SHAMapStoreImp::SHAMapStoreImp (Setup const& setup,
         Stoppable& parent,
         NodeStore::Scheduler& scheduler,
@@ -170,6 +180,12 @@ SHAMapStoreImp::SHAMapStoreImp (Setup const& setup,
     : SHAMapStore (parent)
     , setup_ (setup)
     , scheduler_ (scheduler)
+    , ioBudget_ (setup_IOBudget (setup), stopwatch(),
+            [this]() -> int
+            {
+                return jobQueue_ ? jobQueue_->getJobCountGE (jtCLIENT) : 0;
+            })
+    , budgetScheduler_ (scheduler_, ioBudget_)
     , journal_ (journal)
     , nodeStoreJournal_ (nodeStoreJournal)
     , transactionMaster_ (transactionMaster)
@@ -194,6 +210,13 @@ SHAMapStoreImp::SHAMapStoreImp (Setup const& setup,
 
         dbPaths();
     }
+
+    if (setup_.shardDatabase.exists ("type"))
+    {
+        shardStore_ = NodeStore::Manager::instance().make_DatabaseShard (
+                "ShardStore", budgetScheduler_, setup_.shardDatabase,
+                nodeStoreJournal_);
+    }
 }
 
 std::unique_ptr <NodeStore::Database>
@@ -202,6 +225,14 @@ SHAMapStoreImp::makeDatabase (std::string const& name,
 {
     std::unique_ptr <NodeStore::Database> db;
 
+    // The configuration can override the caller's choice of read threads
+    get_if_exists (setup_.nodeDatabase, "read_threads", readThreads);
+    if (readThreads < 1)
+    {
+        throw std::runtime_error ("read_threads must be at least 1 "
+            "(currently " + std::to_string (readThreads) + ")");
+    }
+
     if (setup_.deleteInterval)
     {
         SavedState state = state_db_.getState();
@@ -224,6 +255,12 @@ SHAMapStoreImp::makeDatabase (std::string const& name,
         database_ = dbr.get();
         db.reset (dynamic_cast <NodeStore::Database*>(dbr.release()));
     }
+    else if (setup_.fastDatabase.exists ("type"))
+    {
+        db = NodeStore::Manager::instance().make_DatabaseTiered (name,
+                scheduler_, nodeStoreJournal_, readThreads,
+                setup_.fastDatabase, setup_.nodeDatabase);
+    }
     else
     {
         db = NodeStore::Manager::instance().make_Database (name, scheduler_, nodeStoreJournal_,
@@ -258,16 +295,137 @@ SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
     return false;
 }
 
+std::shared_ptr<SHAMap>
+SHAMapStoreImp::copyState (Ledger::pointer const& ledger,
+        std::shared_ptr<SHAMap> const& base)
+{
+    std::uint64_t nodeCount = 0;
+    auto const copy = [&](SHAMapAbstractNode& node)
+    {
+        if (copyNode (nodeCount, node))
+            return true;
+        if (! (nodeCount % checkHealthInterval_))
+            ioBudget_.pace();
+        return false;
+    };
+
+    auto const map = ledger->stateMap().snapShot (false);
+    if (base)
+    {
+        map->visitDifferences (base.get(),
+                [&](SHAMapAbstractNode& node)
+                {
+                    return ! copy (node);
+                });
+        journal_.debug << "copied ledger " << ledger->info().seq
+                << " changes since " << copiedSeq_
+                << " nodecount " << nodeCount;
+    }
+    else
+    {
+        map->visitNodes (copy);
+        journal_.debug << "copied ledger " << ledger->info().seq
+                << " nodecount " << nodeCount;
+    }
+    return map;
+}
+
+bool
+SHAMapStoreImp::storeShard (Ledger::pointer const& ledger)
+{
+    LedgerIndex const seq = ledger->info().seq;
+    if (shardStore_->hasLedger (seq))
+    {
+        shardBase_ = ledger;
+        return true;
+    }
+
+    // Each shard must stand alone, so only differences from a
+    // ledger of the same shard can be stored.
+    Ledger::pointer base;
+    if (shardBase_ && shardBase_->info().seq + 1 == seq &&
+            shardStore_->seqToShardIndex (shardBase_->info().seq) ==
+            shardStore_->seqToShardIndex (seq))
+        base = shardBase_;
+    shardBase_.reset();
+
+    bool complete = true;
+    std::uint64_t nodeCount = 0;
+    auto const copy = [&](uint256 const& hash)
+    {
+        auto const object = nodeStore_->fetch (hash);
+        if (! object)
+        {
+            journal_.warning << "shard: ledger " << seq
+                    << " is missing node " << hash;
+            complete = false;
+            return false;
+        }
+        Blob data (object->getData());
+        shardStore_->store (object->getType(), std::move (data), hash, seq);
+
+        if (! (++nodeCount % checkHealthInterval_))
+        {
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                if (stop_)
+                {
+                    complete = false;
+                    return false;
+                }
+            }
+            ioBudget_.pace();
+        }
+        return true;
+    };
+
+    {
+        Serializer s (128);
+        s.add32 (HashPrefix::ledgerMaster);
+        ledger->addRaw (s);
+        shardStore_->store (hotLEDGER, std::move (s.modData ()),
+                ledger->info().hash, seq);
+    }
+
+    ledger->stateMap().snapShot (false)->visitDifferences (
+            base ? &base->stateMap() : nullptr,
+            [&](SHAMapAbstractNode& node)
+            {
+                return copy (node.getNodeHash());
+            });
+    if (! complete)
+        return false;
+
+    ledger->txMap().snapShot (false)->visitDifferences (nullptr,
+            [&](SHAMapAbstractNode& node)
+            {
+                return copy (node.getNodeHash());
+            });
+    if (! complete)
+        return false;
+
+    shardStore_->setStored (seq);
+    shardBase_ = ledger;
+    journal_.debug << "stored ledger " << seq << " in shard "
+            << shardStore_->seqToShardIndex (seq)
+            << (base ? " incrementally" : "")
+            << " nodecount " << nodeCount;
+    return true;
+}
+
 void
 SHAMapStoreImp::run()
 {
-    LedgerIndex lastRotated = state_db_.getState().lastRotated;
+    LedgerIndex lastRotated = setup_.deleteInterval ?
+            state_db_.getState().lastRotated : 0;
     netOPs_ = &getApp().getOPs();
     ledgerMaster_ = &getApp().getLedgerMaster();
     fullBelowCache_ = &getApp().family().fullbelow();
     treeNodeCache_ = &getApp().family().treecache();
     transactionDb_ = &getApp().getTxnDB();
     ledgerDb_ = &getApp().getLedgerDB();
+    jobQueue_ = &getApp().getJobQueue();
+    nodeStore_ = &getApp().getNodeStore();
 
     if (setup_.advisoryDelete)
         canDelete_ = state_db_.getCanDelete ();
@@ -291,6 +449,25 @@ SHAMapStoreImp::run()
                 continue;
         }
 
+        if (shardStore_)
+        {
+            // Ledgers which validated while the last one was being
+            // stored are stored first, so the shard has no gaps.
+            LedgerIndex const validatedSeq = validatedLedger_->info().seq;
+            for (LedgerIndex seq = shardBase_ ?
+                    shardBase_->info().seq + 1 : validatedSeq;
+                        seq < validatedSeq; ++seq)
+            {
+                auto const ledger = ledgerMaster_->getLedgerBySeq (seq);
+                if (! ledger || ! storeShard (ledger))
+                    break;
+            }
+            storeShard (validatedLedger_);
+        }
+
+        if (! setup_.deleteInterval)
+            continue;
+
         LedgerIndex validatedSeq = validatedLedger_->info().seq;
         if (!lastRotated)
         {
@@ -331,13 +508,9 @@ SHAMapStoreImp::run()
                     ;
             }
 
-            std::uint64_t nodeCount = 0;
-            validatedLedger_->stateMap().snapShot (
-                    false)->visitNodes (
-                    std::bind (&SHAMapStoreImp::copyNode, this,
-                    std::ref(nodeCount), std::placeholders::_1));
-            journal_.debug << "copied ledger " << validatedSeq
-                    << " nodecount " << nodeCount;
+            // In incremental mode most of the state was copied after
+            // the last rotation, so only what changed since is left.
+            auto map = copyState (validatedLedger_, copied_);
             switch (health())
             {
                 case Health::stopping:
@@ -350,6 +523,11 @@ SHAMapStoreImp::run()
                     ;
             }
 
+            // Should the rotation be retried, only what changed since
+            // this ledger is left to copy.
+            copied_ = std::move (map);
+            copiedSeq_ = validatedSeq;
+
             freshenCaches();
             journal_.debug << validatedSeq << " freshened caches";
             switch (health())
@@ -394,10 +572,33 @@ SHAMapStoreImp::run()
                 clearCaches (validatedSeq);
                 oldBackend = database_->rotateBackends (newBackend);
             }
+            copied_.reset();
             journal_.debug << "finished rotation " << validatedSeq;
 
             oldBackend->setDeletePath();
         }
+        else if (setup_.incrementalCopy && !copied_)
+        {
+            // Copy the state to the new writable backend well ahead of
+            // the next rotation. If interrupted, start again at the next
+            // ledger.
+            auto map = copyState (validatedLedger_, nullptr);
+            switch (health())
+            {
+                case Health::stopping:
+                    stopped();
+                    return;
+                case Health::unhealthy:
+                    continue;
+                case Health::ok:
+                default:
+                    ;
+            }
+
+            // Only the state map is needed, not the whole ledger
+            copied_ = std::move (map);
+            copiedSeq_ = validatedSeq;
+        }
     }
 }
 
@@ -482,7 +683,7 @@ SHAMapStoreImp::makeBackendRotating (std::string path)
     }
     parameters.set("path", newPath.string());
 
-    return NodeStore::Manager::instance().make_Backend (parameters, scheduler_,
+    return NodeStore::Manager::instance().make_Backend (parameters, budgetScheduler_,
             nodeStoreJournal_);
 }
 
@@ -490,9 +691,9 @@ std::unique_ptr <NodeStore::DatabaseRotating>
 SHAMapStoreImp::makeDatabaseRotating (std::string const& name,
         std::int32_t readThreads,
         std::shared_ptr <NodeStore::Backend> writableBackend,
-        std::shared_ptr <NodeStore::Backend> archiveBackend) const
+        std::shared_ptr <NodeStore::Backend> archiveBackend)
 {
-    return NodeStore::Manager::instance().make_DatabaseRotating ("NodeStore.main", scheduler_,
+    return NodeStore::Manager::instance().make_DatabaseRotating ("NodeStore.main", budgetScheduler_,
             readThreads, writableBackend, archiveBackend, nodeStoreJournal_);
 }
 
@@ -531,8 +732,7 @@ SHAMapStoreImp::clearSql (DatabaseCon& database,
         if (health())
             return;
         if (min < lastRotated)
-            std::this_thread::sleep_for (
-                    std::chrono::milliseconds (setup_.backOff));
+            ioBudget_.pace();
     }
     journal_.debug << "finished: " << deleteQuery;
 }
@@ -629,7 +829,7 @@ SHAMapStoreImp::health()
 void
 SHAMapStoreImp::onStop()
 {
-    if (setup_.deleteInterval)
+    if (setup_.deleteInterval || shardStore_)
     {
         {
             std::lock_guard <std::mutex> lock (mutex_);
@@ -646,7 +846,7 @@ SHAMapStoreImp::onStop()
 void
 SHAMapStoreImp::onChildrenStopped()
 {
-    if (setup_.deleteInterval)
+    if (setup_.deleteInterval || shardStore_)
     {
         {
             std::lock_guard <std::mutex> lock (mutex_);
@@ -679,6 +879,15 @@ setup_SHAMapStore (Config const& c)
     get_if_exists (sec, "delete_batch", setup.deleteBatch);
     get_if_exists (sec, "backOff", setup.backOff);
     get_if_exists (sec, "age_threshold", setup.ageThreshold);
+    get_if_exists (sec, "incremental_copy", setup.incrementalCopy);
+    get_if_exists (sec, "io_read_target", setup.ioReadTarget);
+
+    setup.shardDatabase = c[ConfigSection::shardDatabase ()];
+    setup.fastDatabase = c[ConfigSection::fastDatabase ()];
+
+    if (setup.deleteInterval && setup.fastDatabase.exists ("type"))
+        throw std::runtime_error (
+            "[fast_db] can't be used with online_delete");
 
     return setup;
 }
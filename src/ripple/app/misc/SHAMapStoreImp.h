@@ -23,6 +23,7 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/impl/IOBudget.h>
 #include <ripple/core/SociDB.h>
 #include <ripple/nodestore/impl/Tuning.h>
 #include <ripple/nodestore/DatabaseRotating.h>
@@ -43,6 +44,43 @@ private:
         LedgerIndex lastRotated;
     };
 
+    // Passes node store activity on to the application's scheduler,
+    // and the latencies to the I/O budget.
+    class BudgetScheduler : public NodeStore::Scheduler
+    {
+    private:
+        NodeStore::Scheduler& scheduler_;
+        IOBudget& budget_;
+
+    public:
+        BudgetScheduler (NodeStore::Scheduler& scheduler, IOBudget& budget)
+            : scheduler_ (scheduler)
+            , budget_ (budget)
+        {
+        }
+
+        void
+        scheduleTask (NodeStore::Task& task) override
+        {
+            scheduler_.scheduleTask (task);
+        }
+
+        void
+        onFetch (NodeStore::FetchReport const& report) override
+        {
+            if (report.wentToDisk)
+                budget_.onRead (report.elapsed);
+            scheduler_.onFetch (report);
+        }
+
+        void
+        onBatchWrite (NodeStore::BatchWriteReport const& report) override
+        {
+            budget_.onWrite (report.elapsed);
+            scheduler_.onBatchWrite (report);
+        }
+    };
+
     enum Health : std::uint8_t
     {
         ok = 0,
@@ -82,6 +120,9 @@ private:
 
     Setup setup_;
     NodeStore::Scheduler& scheduler_;
+    // paces deletion and copying
+    IOBudget ioBudget_;
+    BudgetScheduler budgetScheduler_;
     beast::Journal journal_;
     beast::Journal nodeStoreJournal_;
     NodeStore::DatabaseRotating* database_ = nullptr;
@@ -93,6 +134,14 @@ private:
     mutable std::mutex mutex_;
     Ledger::pointer newLedger_;
     Ledger::pointer validatedLedger_;
+    // state map which has been copied to the writable backend, and
+    // the sequence of its ledger
+    std::shared_ptr<SHAMap> copied_;
+    LedgerIndex copiedSeq_ = 0;
+    // keeps validated ledgers in shards, if configured
+    std::unique_ptr <NodeStore::DatabaseShard> shardStore_;
+    // last ledger stored in a shard
+    Ledger::pointer shardBase_;
     TransactionMaster& transactionMaster_;
     std::atomic <LedgerIndex> canDelete_;
     // these do not exist upon SHAMapStore creation, but do exist
@@ -103,6 +152,8 @@ private:
     TreeNodeCache* treeNodeCache_ = nullptr;
     DatabaseCon* transactionDb_ = nullptr;
     DatabaseCon* ledgerDb_ = nullptr;
+    JobQueue* jobQueue_ = nullptr;
+    NodeStore::Database* nodeStore_ = nullptr;
 
 public:
     SHAMapStoreImp (Setup const& setup,
@@ -155,11 +206,35 @@ public:
         return canDelete_;
     }
 
+    NodeStore::DatabaseShard*
+    getShardStore() override
+    {
+        return shardStore_.get();
+    }
+
     void onLedgerClosed (Ledger::pointer validatedLedger) override;
 
 private:
     // callback for visitNodes
     bool copyNode (std::uint64_t& nodeCount, SHAMapAbstractNode const &node);
+    /**
+     * Copies the state map of a ledger to the writable backend.
+     *
+     * @param ledger The ledger to copy.
+     * @param base If set, a state map already copied. Only the nodes
+     *             which are not in it are copied.
+     * @return The state map which was copied.
+     */
+    std::shared_ptr<SHAMap> copyState (Ledger::pointer const& ledger,
+            std::shared_ptr<SHAMap> const& base);
+    /**
+     * Copies a ledger into its shard. The ledger header, the state
+     * nodes which are not in the previous ledger of the same shard,
+     * if it was stored, and the transaction nodes are copied.
+     *
+     * @return false if a node was missing or the server is stopping.
+     */
+    bool storeShard (Ledger::pointer const& ledger);
     void run();
     void dbPaths();
     std::shared_ptr <NodeStore::Backend> makeBackendRotating (
@@ -179,7 +254,7 @@ private:
     makeDatabaseRotating (std::string const&name,
             std::int32_t readThreads,
             std::shared_ptr <NodeStore::Backend> writableBackend,
-            std::shared_ptr <NodeStore::Backend> archiveBackend) const;
+            std::shared_ptr <NodeStore::Backend> archiveBackend);
 
     template <class CacheInstance>
     bool
@@ -190,15 +265,19 @@ private:
         for (uint256 it: cache.getKeys())
         {
             database_->fetchNode (it);
-            if (! (++check % checkHealthInterval_) && health())
-                return true;
+            if (! (++check % checkHealthInterval_))
+            {
+                if (health())
+                    return true;
+                ioBudget_.pace();
+            }
         }
 
         return false;
     }
 
     /** delete from sqlite table in batches to not lock the db excessively
-     *  pause briefly to extend access time to other users
+     *  pause as the I/O budget allows to extend access time to other users
      *  call with mutex object unlocked
      */
     void clearSql (DatabaseCon& database, LedgerIndex lastRotated,
@@ -224,7 +303,7 @@ private:
     void
     onStart() override
     {
-        if (setup_.deleteInterval)
+        if (setup_.deleteInterval || shardStore_)
             thread_ = std::thread (&SHAMapStoreImp::run, this);
     }
 
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/IOBudget.h>
+#include <algorithm>
+#include <thread>
+
+namespace ripple {
+
+IOBudget::IOBudget (Setup const& setup, Stopwatch& clock,
+        std::function <int()> queueDepth)
+    : setup_ (setup)
+    , clock_ (clock)
+    , queueDepth_ (std::move (queueDepth))
+    , last_ (clock.now ())
+    , delay_ (setup.initialDelay)
+{
+    for (auto& count : reads_)
+        count = 0;
+}
+
+void
+IOBudget::onRead (std::chrono::milliseconds elapsed)
+{
+    auto const i = std::min <std::int64_t> (
+        std::max <std::int64_t> (elapsed.count (), 0), readBuckets - 1);
+    reads_[i].fetch_add (1, std::memory_order_relaxed);
+}
+
+void
+IOBudget::onWrite (std::chrono::milliseconds elapsed)
+{
+    auto const ms = elapsed.count ();
+    auto prev = maxWrite_.load (std::memory_order_relaxed);
+    while (ms > prev && ! maxWrite_.compare_exchange_weak (prev, ms))
+        ;
+}
+
+std::chrono::milliseconds
+IOBudget::readPercentile (std::uint64_t perMille)
+{
+    std::uint64_t total = 0;
+    for (auto const& count : reads_)
+        total += count.load (std::memory_order_relaxed);
+    if (total == 0)
+        return std::chrono::milliseconds (0);
+
+    // The smallest latency which at least perMille of the reads are under
+    std::uint64_t const rank = (total * perMille + 999) / 1000;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < readBuckets; ++i)
+    {
+        seen += reads_[i].load (std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::chrono::milliseconds (i);
+    }
+    return std::chrono::milliseconds (readBuckets - 1);
+}
+
+void
+IOBudget::update ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    auto const now = clock_.now ();
+    if (now - last_ < setup_.interval)
+        return;
+    last_ = now;
+
+    auto const read = readPercentile (990);
+    auto const write = std::chrono::milliseconds (maxWrite_.exchange (0));
+    int const queue = queueDepth_ ? queueDepth_ () : 0;
+    for (auto& count : reads_)
+        count.store (0, std::memory_order_relaxed);
+
+    if (read > setup_.readTarget ||
+        write > setup_.writeTarget ||
+        queue > setup_.queueTarget)
+    {
+        delay_ = std::min (setup_.maxDelay, std::max (
+            2 * delay_, std::chrono::milliseconds (10)));
+    }
+    else if (2 * read <= setup_.readTarget &&
+        2 * write <= setup_.writeTarget &&
+        2 * queue <= setup_.queueTarget)
+    {
+        delay_ = delay_ * 3 / 4;
+    }
+}
+
+std::chrono::milliseconds
+IOBudget::delay () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return delay_;
+}
+
+void
+IOBudget::pace ()
+{
+    update ();
+    auto const wait = delay ();
+    if (wait.count () > 0)
+        std::this_thread::sleep_for (wait);
+}
+
+}
@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_IMPL_IOBUDGET_H_INCLUDED
+#define RIPPLE_APP_MISC_IMPL_IOBUDGET_H_INCLUDED
+
+#include <ripple/basics/chrono.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace ripple {
+
+/** Paces background I/O so that it doesn't slow down other work.
+
+    The latencies of node store reads and batch writes are sampled as they
+    are reported. Background work calls pace() between units of work, and
+    each call waits for the current delay.
+
+    Once per interval the delay is adjusted. It doubles when the 99th
+    percentile read latency, the longest batch write or the job queue depth
+    over the interval is above its target. It shrinks by a quarter, down to
+    nothing, when all of them are below half of their targets.
+*/
+class IOBudget
+{
+public:
+    struct Setup
+    {
+        std::chrono::milliseconds readTarget {20};
+        std::chrono::milliseconds writeTarget {1000};
+        int queueTarget = 100;
+        std::chrono::milliseconds initialDelay {100};
+        std::chrono::milliseconds maxDelay {10000};
+        std::chrono::milliseconds interval {1000};
+    };
+
+    /** Create the budget.
+        @param queueDepth Returns the number of jobs waiting, or is empty.
+    */
+    IOBudget (Setup const& setup, Stopwatch& clock,
+        std::function <int()> queueDepth);
+
+    IOBudget (IOBudget const&) = delete;
+    IOBudget& operator= (IOBudget const&) = delete;
+
+    /** Record the latency of a read which went to disk. */
+    void
+    onRead (std::chrono::milliseconds elapsed);
+
+    /** Record the latency of a batch write. */
+    void
+    onWrite (std::chrono::milliseconds elapsed);
+
+    /** Adjust the delay if an interval has passed since the last time. */
+    void
+    update ();
+
+    /** Returns the time to wait between units of background work. */
+    std::chrono::milliseconds
+    delay () const;
+
+    /** Wait before the next unit of background work. */
+    void
+    pace ();
+
+private:
+    enum
+    {
+        // Read latencies are counted in 1ms buckets up to this
+        readBuckets = 256
+    };
+
+    std::chrono::milliseconds
+    readPercentile (std::uint64_t perMille);
+
+    Setup const setup_;
+    Stopwatch& clock_;
+    std::function <int()> queueDepth_;
+
+    std::array <std::atomic <std::uint32_t>, readBuckets> reads_;
+    std::atomic <std::int64_t> maxWrite_ {0};
+
+    std::mutex mutable mutex_;
+    Stopwatch::time_point last_;
+    std::chrono::milliseconds delay_;
+};
+
+}
+
+#endif
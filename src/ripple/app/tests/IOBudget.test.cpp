@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/misc/impl/IOBudget.h>
+#include <beast/unit_test/suite.h>
+
+namespace ripple {
+
+class IOBudget_test : public beast::unit_test::suite
+{
+public:
+    using ms = std::chrono::milliseconds;
+
+    void
+    testReads ()
+    {
+        testcase ("reads");
+
+        TestStopwatch clock;
+        IOBudget::Setup setup;
+        IOBudget budget (setup, clock, nullptr);
+        expect (budget.delay () == setup.initialDelay);
+
+        // Nothing changes within an interval
+        for (int i = 0; i < 100; ++i)
+            budget.onRead (ms (500));
+        budget.update ();
+        expect (budget.delay () == setup.initialDelay);
+
+        // Slow reads double the delay
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 2 * setup.initialDelay);
+
+        // A few slow reads don't count against the 99th percentile
+        for (int i = 0; i < 995; ++i)
+            budget.onRead (ms (1));
+        for (int i = 0; i < 5; ++i)
+            budget.onRead (ms (100));
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 3 * setup.initialDelay / 2);
+
+        // The delay is capped
+        for (int i = 0; i < 20; ++i)
+        {
+            budget.onRead (ms (100));
+            clock.advance (setup.interval);
+            budget.update ();
+        }
+        expect (budget.delay () == setup.maxDelay);
+
+        // And falls to nothing when reads are fast
+        for (int i = 0; i < 100; ++i)
+        {
+            budget.onRead (ms (0));
+            clock.advance (setup.interval);
+            budget.update ();
+        }
+        expect (budget.delay () == ms (0));
+
+        // Then grows again
+        budget.onRead (ms (100));
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () > ms (0));
+    }
+
+    void
+    testWritesAndQueue ()
+    {
+        testcase ("writes and queue");
+
+        TestStopwatch clock;
+        IOBudget::Setup setup;
+        int queue = 0;
+        IOBudget budget (setup, clock, [&queue]() { return queue; });
+
+        budget.onWrite (ms (100));
+        budget.onWrite (2 * setup.writeTarget);
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 2 * setup.initialDelay);
+
+        // Between half and all of a target, the delay holds
+        budget.onWrite (3 * setup.writeTarget / 4);
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 2 * setup.initialDelay);
+
+        queue = setup.queueTarget + 1;
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 4 * setup.initialDelay);
+
+        queue = 0;
+        clock.advance (setup.interval);
+        budget.update ();
+        expect (budget.delay () == 3 * setup.initialDelay);
+    }
+
+    void
+    run ()
+    {
+        testReads ();
+        testWritesAndQueue ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(IOBudget,app,ripple);
+
+}
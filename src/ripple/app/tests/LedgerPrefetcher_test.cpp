@@ -0,0 +1,120 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/test/jtx.h>
+#include <ripple/app/ledger/impl/LedgerPrefetcher.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/JsonFields.h>
+#include <algorithm>
+
+namespace ripple {
+namespace test {
+
+struct LedgerPrefetcher_test : public beast::unit_test::suite
+{
+    static
+    bool
+    contains (std::vector<uint256> const& keys, uint256 const& key)
+    {
+        return std::binary_search (keys.begin(), keys.end(), key);
+    }
+
+    void
+    testTouchedKeys()
+    {
+        testcase ("touched keys");
+        using namespace jtx;
+        Env env(*this);
+        Account const alice ("alice");
+        Account const bob ("bob");
+        Account const gw ("gateway");
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(10000), alice, bob, gw);
+        env.close();
+        {
+            auto const keys = LedgerPrefetcher::touchedKeys (
+                *env.closed(), 100);
+            expect (std::is_sorted (keys.begin(), keys.end()));
+            expect (contains (keys, keylet::account(alice).key));
+            expect (contains (keys, keylet::account(bob).key));
+            expect (contains (keys, keylet::account(env.master).key));
+        }
+
+        // Entries touched by several transactions are listed once
+        env(pay(alice, bob, XRP(1)));
+        env(pay(bob, alice, XRP(2)));
+        env(pay(alice, bob, XRP(3)));
+        env.close();
+        {
+            auto const keys = LedgerPrefetcher::touchedKeys (
+                *env.closed(), 100);
+            expect (std::adjacent_find (keys.begin(), keys.end()) ==
+                keys.end(), "Should have no duplicates");
+            expect (keys.size() == 2);
+            expect (contains (keys, keylet::account(alice).key));
+            expect (contains (keys, keylet::account(bob).key));
+            expect (! contains (keys, keylet::account(gw).key));
+
+            // Only the lowest keys are kept
+            auto const some = LedgerPrefetcher::touchedKeys (
+                *env.closed(), 1);
+            expect (some.size() == 1 && some.front() == keys.front());
+        }
+
+        // Created entries are listed, deleted ones are not
+        auto const offerSeq = env.seq (alice);
+        env(offer(alice, USD(50), XRP(50)));
+        env.close();
+        auto const offerKey = getOfferIndex (alice.id(), offerSeq);
+        expect (contains (LedgerPrefetcher::touchedKeys (
+            *env.closed(), 100), offerKey), "Should have the new offer");
+
+        Json::Value cancel;
+        cancel[jss::Account] = alice.human();
+        cancel[jss::OfferSequence] = offerSeq;
+        cancel[jss::TransactionType] = "OfferCancel";
+        env(cancel);
+        env.close();
+        {
+            auto const keys = LedgerPrefetcher::touchedKeys (
+                *env.closed(), 100);
+            expect (! contains (keys, offerKey),
+                "Should not have the deleted offer");
+            expect (contains (keys, keylet::account(alice).key));
+        }
+
+        // A ledger without transactions touches nothing
+        env.close();
+        expect (LedgerPrefetcher::touchedKeys (
+            *env.closed(), 100).empty());
+    }
+
+    void
+    run() override
+    {
+        testTouchedKeys();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerPrefetcher,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/test/jtx.h>
+#include <ripple/app/ledger/OpenLedger.h>
+
+namespace ripple {
+namespace test {
+
+struct OpenLedger_test : public beast::unit_test::suite
+{
+    void
+    testPreflightCache()
+    {
+        testcase ("preflight cache");
+        using namespace jtx;
+        Env env(*this);
+        env.fund(XRP(10000), "alice");
+
+        auto const good = env.jt(noop("alice")).stx;
+        auto const bad = env.jt(noop("alice"), txflags(0x01000000)).stx;
+        auto const rules = env.open()->rules();
+
+        PreflightCache cache;
+        auto const preflight =
+            [&](STTx const& tx, ApplyFlags flags)
+            {
+                return cache.preflight(rules, tx, flags,
+                    directSigVerify, env.config, env.journal);
+            };
+
+        cache.rotate(rules);
+        expect (preflight(*good, tapENABLE_TESTING) == tesSUCCESS);
+        expect (preflight(*bad, tapENABLE_TESTING) == temINVALID_FLAG);
+        expect (cache.hits() == 0);
+        expect (cache.size() == 2);
+
+        // Retry passes share the result
+        expect (preflight(*good, tapENABLE_TESTING | tapRETRY) ==
+            tesSUCCESS);
+        expect (preflight(*bad, tapENABLE_TESTING) == temINVALID_FLAG);
+        expect (cache.hits() == 2);
+
+        // Other flags need another preflight
+        expect (preflight(*good, tapENABLE_TESTING | tapNO_CHECK_SIGN) ==
+            tesSUCCESS);
+        expect (cache.hits() == 2);
+
+        // Results used since the last rotation are kept
+        cache.rotate(rules);
+        expect (cache.size() == 2);
+        expect (preflight(*bad, tapENABLE_TESTING) == temINVALID_FLAG);
+        expect (cache.hits() == 3);
+        cache.rotate(rules);
+        expect (cache.size() == 1);
+        cache.rotate(rules);
+        expect (cache.size() == 0);
+
+        // New rules drop everything
+        expect (preflight(*good, tapENABLE_TESTING) == tesSUCCESS);
+        expect (cache.size() == 1);
+        cache.rotate(Rules());
+        expect (cache.size() == 0);
+        expect (preflight(*good, tapENABLE_TESTING) == tesSUCCESS);
+        expect (cache.size() == 0, "Rules don't match");
+    }
+
+    void
+    run() override
+    {
+        testPreflightCache();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OpenLedger,app,ripple);
+
+} // test
+} // ripple
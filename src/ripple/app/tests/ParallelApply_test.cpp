@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/test/jtx.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/tx/ParallelApply.h>
+#include <ripple/app/tx/apply.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+struct ParallelApply_test : public beast::unit_test::suite
+{
+    using Txs = std::vector<std::shared_ptr<STTx const>>;
+
+    // Build a closed ledger on parent from txs, applied in order
+    std::shared_ptr<Ledger>
+    build (jtx::Env& env, Ledger const& parent,
+        Txs const& txs, int threads, std::vector<int>& results,
+            std::size_t& reapplied)
+    {
+        auto next = std::make_shared<Ledger>(open_ledger, parent);
+        next->setClosed();
+
+        OpenView accum(&*next);
+        ParallelApply parallel (
+            [&](OpenView& view, std::shared_ptr<STTx const> const& tx)
+            {
+                return static_cast<int>(ripple::apply(view, *tx,
+                    tapENABLE_TESTING, directSigVerify, env.config,
+                        env.journal).first);
+            }, threads);
+        results = parallel (accum, txs);
+        reapplied = parallel.reapplied();
+        accum.apply(*next);
+        return next;
+    }
+
+    // Build the ledger serially and in parallel, and compare
+    void
+    check (jtx::Env& env, Ledger const& parent, Txs const& txs)
+    {
+        std::vector<int> serialResults;
+        std::size_t reapplied;
+        auto const serial = build (env, parent, txs,
+            1, serialResults, reapplied);
+        expect (reapplied == 0);
+
+        for (int threads : { 2, 7 })
+        {
+            std::vector<int> results;
+            auto const parallel = build (env, parent, txs,
+                threads, results, reapplied);
+            expect (results == serialResults, "Results differ");
+            expect (parallel->stateMap().getHash() ==
+                serial->stateMap().getHash(), "State differs");
+            expect (parallel->txMap().getHash() ==
+                serial->txMap().getHash(), "Transactions differ");
+            expect (parallel->info().drops ==
+                serial->info().drops, "Drops differ");
+            expect (reapplied <= txs.size());
+        }
+    }
+
+    void
+    testSameAccount (jtx::Env& env, Ledger const& parent,
+        std::vector<jtx::Account> const& accounts)
+    {
+        testcase ("same account");
+        using namespace jtx;
+
+        // Each transaction depends on the one before it
+        Txs txs;
+        for (std::size_t i = 0; i < accounts.size(); ++i)
+            txs.push_back (env.jt (pay (env.master, accounts[i],
+                XRP(1000)), seq(i + 1), fee(10)).stx);
+
+        std::vector<int> results;
+        std::size_t reapplied;
+        build (env, parent, txs, 4, results, reapplied);
+        for (auto const result : results)
+            expect (result == tesSUCCESS);
+        check (env, parent, txs);
+    }
+
+    void
+    testMixed (jtx::Env& env, Ledger const& parent,
+        std::vector<jtx::Account> const& accounts)
+    {
+        testcase ("mixed");
+        using namespace jtx;
+
+        Txs txs;
+        auto const n = accounts.size();
+        for (std::size_t i = 0; i + 1 < n; i += 2)
+        {
+            // Independent pairs
+            txs.push_back (env.jt (pay (accounts[i], accounts[i + 1],
+                XRP(10)), seq(1), fee(10)).stx);
+
+            // Several payments to one account
+            txs.push_back (env.jt (pay (accounts[i + 1], accounts[0],
+                XRP(1)), seq(1), fee(10)).stx);
+
+            // Later sequences, which may come before the first
+            txs.push_back (env.jt (noop (accounts[i]),
+                seq(2), fee(10)).stx);
+            txs.push_back (env.jt (noop (accounts[i]),
+                seq(3), fee(10)).stx);
+        }
+
+        // Past and far future sequences
+        txs.push_back (env.jt (noop (env.master), seq(1), fee(10)).stx);
+        txs.push_back (env.jt (noop (accounts[1]), seq(100), fee(10)).stx);
+
+        // Destroys nearly all of an account's XRP in fees
+        txs.push_back (env.jt (noop (accounts[n - 1]),
+            seq(2), fee(XRP(999))).stx);
+
+        std::sort (txs.begin(), txs.end(),
+            [](std::shared_ptr<STTx const> const& lhs,
+                std::shared_ptr<STTx const> const& rhs)
+            {
+                return lhs->getTransactionID() <
+                    rhs->getTransactionID();
+            });
+        check (env, parent, txs);
+    }
+
+    void
+    run() override
+    {
+        using namespace jtx;
+        Env env(*this);
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 300; ++i)
+        {
+            accounts.emplace_back ("a" + std::to_string(i));
+            env.memoize (accounts.back());
+        }
+
+        auto const genesis = std::make_shared<Ledger>(
+            create_genesis, env.config);
+
+        testSameAccount (env, *genesis, accounts);
+
+        // Fund the accounts for the next test
+        Txs txs;
+        for (std::size_t i = 0; i < accounts.size(); ++i)
+            txs.push_back (env.jt (pay (env.master, accounts[i],
+                XRP(1000)), seq(i + 1), fee(10)).stx);
+        std::vector<int> results;
+        std::size_t reapplied;
+        auto const funded = build (env, *genesis, txs, 1,
+            results, reapplied);
+
+        testMixed (env, *funded, accounts);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelApply,app,ripple);
+
+} // test
+} // ripple
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_TX_PARALLELAPPLY_H_INCLUDED
+#define RIPPLE_TX_PARALLELAPPLY_H_INCLUDED
+
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/STTx.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace ripple {
+
+/** Applies a list of transactions to a view using several threads.
+
+    The transactions are taken in waves. Each transaction in a wave is
+    first applied on a pool of threads to its own OpenView over the
+    view as it was when the wave began, recording the keys it read and
+    the changes it made. The changes are then committed to the view in
+    list order. A transaction which read a key written by one committed
+    before it in the same wave is applied again against the updated
+    view, so the result is exactly that of applying the list in order.
+
+    Pseudo-transactions are never applied ahead of time, since their
+    effects reach outside the view.
+*/
+class ParallelApply
+{
+public:
+    /** Applies one transaction to a view.
+
+        Called concurrently on different views. The return value
+        is passed back to the caller unchanged.
+    */
+    using Apply = std::function<int (
+        OpenView& view, std::shared_ptr<STTx const> const& tx)>;
+
+    enum
+    {
+        // Number of transactions applied ahead of each commit
+        waveSize = 256
+    };
+
+    ParallelApply (Apply apply, int threads);
+
+    ParallelApply (ParallelApply const&) = delete;
+    ParallelApply& operator= (ParallelApply const&) = delete;
+
+    /** Apply the transactions to the view in order.
+
+        @return The result of applying each transaction.
+    */
+    std::vector<int>
+    operator() (OpenView& view,
+        std::vector<std::shared_ptr<STTx const>> const& txs);
+
+    /** Returns the number of transactions applied again
+        because of a conflict during the last call.
+    */
+    std::size_t
+    reapplied () const
+    {
+        return reapplied_;
+    }
+
+private:
+    class Recorder;
+    class Collector;
+    struct Outcome;
+
+    Outcome
+    execute (ReadView const& view,
+        std::shared_ptr<STTx const> const& tx) const;
+
+    void
+    speculate (OpenView const& view,
+        std::vector<std::shared_ptr<STTx const>> const& txs,
+            std::size_t begin, std::vector<Outcome>& outcomes) const;
+
+    static
+    bool
+    conflicts (Outcome const& outcome,
+        std::set<uint256> const& written);
+
+    static
+    void
+    commit (OpenView& view, Outcome const& outcome);
+
+    Apply apply_;
+    int threads_;
+    std::size_t reapplied_ = 0;
+};
+
+} // ripple
+
+#endif
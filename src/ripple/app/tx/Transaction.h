@@ -49,6 +49,19 @@ enum TransStatus
 
 enum class Validate {NO, YES};
 
+/** Check a transaction as constructing a Transaction
+    with Validate::YES does.
+
+    The local checks are made, then the signature is checked
+    through sigVerify.
+
+    @param reason Set to why the transaction failed.
+    @return `true` if the transaction passed.
+*/
+bool
+checkValidity (STTx const& tx, bool allowMultiSign,
+    SigVerify const& sigVerify, std::string& reason);
+
 // This class is for constructing and examining transactions.
 // Transactions are static so manipulation functions are unnecessary.
 class Transaction
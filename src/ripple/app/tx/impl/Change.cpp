@@ -23,6 +23,7 @@
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/TxFlags.h>
 
@@ -100,7 +101,7 @@ Change::applyAmendment()
 
     if (!amendmentObject)
     {
-        amendmentObject = std::make_shared<SLE>(k);
+        amendmentObject = make_shared_scoped<SLE>(k);
         view().insert(amendmentObject);
     }
 
@@ -184,7 +185,7 @@ Change::applyFee()
 
     if (!feeObject)
     {
-        feeObject = std::make_shared<SLE>(k);
+        feeObject = make_shared_scoped<SLE>(k);
         view().insert(feeObject);
     }
 
@@ -24,6 +24,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/protocol/Quality.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/json/to_string.h>
 #include <ripple/ledger/Sandbox.h>
 #include <beast/cxx14/memory.h>
@@ -840,7 +841,7 @@ CreateOffer::applyGuts (ApplyView& view, ApplyView& view_cancel)
 
     if (result == tesSUCCESS)
     {
-        auto sleOffer = std::make_shared<SLE>(ltOFFER, offer_index);
+        auto sleOffer = make_shared_scoped<SLE>(ltOFFER, offer_index);
         sleOffer->setAccountID (sfAccount, account_);
         sleOffer->setFieldU32 (sfSequence, uSequence);
         sleOffer->setFieldH256 (sfBookDirectory, uDirectory);
@@ -21,6 +21,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/tx/impl/CreateTicket.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/protocol/Indexes.h>
 
 namespace ripple {
@@ -76,7 +77,7 @@ CreateTicket::doApply ()
             return tesSUCCESS;
     }
 
-    SLE::pointer sleTicket = std::make_shared<SLE>(ltTICKET,
+    SLE::pointer sleTicket = make_shared_scoped<SLE>(ltTICKET,
         getTicketIndex (account_, tx().getSequence ()));
     sleTicket->setAccountID (sfAccount, account_);
     sleTicket->setFieldU32 (sfSequence, tx().getSequence ());
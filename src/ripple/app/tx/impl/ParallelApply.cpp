@@ -0,0 +1,423 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/tx/ParallelApply.h>
+#include <ripple/basics/WorkerPool.h>
+#include <ripple/protocol/STObject.h>
+#include <ripple/protocol/TxFormats.h>
+#include <boost/optional.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <utility>
+
+namespace ripple {
+
+// What applying a transaction read and changed
+struct ParallelApply::Outcome
+{
+    enum class Action
+    {
+        erase,
+        insert,
+        replace,
+    };
+
+    struct Tx
+    {
+        uint256 key;
+        std::shared_ptr<Serializer const> txn;
+        std::shared_ptr<Serializer const> meta;
+    };
+
+    // false if the transaction still has to be applied
+    bool ready = false;
+    int result = 0;
+
+    // Keys read, and the key ranges searched with succ
+    bool readAll = false;
+    std::vector<uint256> reads;
+    std::vector<std::pair<uint256, boost::optional<uint256>>> ranges;
+
+    // Changes to make to the view
+    XRPAmount destroyed = 0;
+    std::vector<std::pair<Action, std::shared_ptr<SLE>>> items;
+    std::vector<Tx> txs;
+};
+
+//------------------------------------------------------------------------------
+
+// Forwards reads to a view, remembering what was asked for
+class ParallelApply::Recorder
+    : public ReadView
+{
+private:
+    ReadView const& base_;
+    Outcome& outcome_;
+
+public:
+    Recorder (ReadView const& base, Outcome& outcome)
+        : base_ (base)
+        , outcome_ (outcome)
+    {
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists (Keylet const& k) const override
+    {
+        outcome_.reads.push_back (k.key);
+        return base_.exists (k);
+    }
+
+    boost::optional<key_type>
+    succ (key_type const& key, boost::optional<
+        key_type> const& last = boost::none) const override
+    {
+        outcome_.ranges.emplace_back (key, last);
+        return base_.succ (key, last);
+    }
+
+    std::shared_ptr<SLE const>
+    read (Keylet const& k) const override
+    {
+        outcome_.reads.push_back (k.key);
+        return base_.read (k);
+    }
+
+    STAmount
+    balanceHook (AccountID const& account,
+        AccountID const& issuer,
+            STAmount const& amount) const override
+    {
+        return base_.balanceHook (account, issuer, amount);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        outcome_.readAll = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        outcome_.readAll = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        outcome_.readAll = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        outcome_.readAll = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists (key_type const& key) const override
+    {
+        outcome_.reads.push_back (key);
+        return base_.txExists (key);
+    }
+
+    tx_type
+    txRead (key_type const& key) const override
+    {
+        outcome_.reads.push_back (key);
+        return base_.txRead (key);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Captures the changes a view makes when it is applied
+class ParallelApply::Collector
+    : public TxsRawView
+{
+private:
+    Outcome& outcome_;
+
+public:
+    explicit
+    Collector (Outcome& outcome)
+        : outcome_ (outcome)
+    {
+    }
+
+    void
+    rawErase (std::shared_ptr<SLE> const& sle) override
+    {
+        outcome_.items.emplace_back (Outcome::Action::erase, sle);
+    }
+
+    void
+    rawInsert (std::shared_ptr<SLE> const& sle) override
+    {
+        outcome_.items.emplace_back (Outcome::Action::insert, sle);
+    }
+
+    void
+    rawReplace (std::shared_ptr<SLE> const& sle) override
+    {
+        outcome_.items.emplace_back (Outcome::Action::replace, sle);
+    }
+
+    void
+    rawDestroyXRP (XRPAmount const& fee) override
+    {
+        outcome_.destroyed += fee;
+    }
+
+    void
+    rawTxInsert (ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+            std::shared_ptr<Serializer const> const& metaData) override
+    {
+        outcome_.txs.push_back ({ key, txn, metaData });
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Pseudo-transactions change server state outside the view
+static
+bool
+isPseudoTx (STTx const& tx)
+{
+    auto const type = tx.getTxnType ();
+    return type == ttAMENDMENT || type == ttFEE;
+}
+
+// A transaction applied on its own view was given an index of zero
+// in its metadata. Returns the metadata with the index it has in the
+// view it is committed to.
+static
+std::shared_ptr<Serializer const>
+reindex (std::shared_ptr<Serializer const> const& meta,
+    std::uint32_t index)
+{
+    STObject obj (SerialIter{ meta->slice() }, sfMetadata);
+    if (obj.getFieldU32 (sfTransactionIndex) == index)
+        return meta;
+    obj.setFieldU32 (sfTransactionIndex, index);
+    auto s = std::make_shared<Serializer> ();
+    obj.add (*s);
+    return s;
+}
+
+ParallelApply::ParallelApply (Apply apply, int threads)
+    : apply_ (std::move (apply))
+    , threads_ (std::max (threads, 1))
+{
+}
+
+std::vector<int>
+ParallelApply::operator() (OpenView& view,
+    std::vector<std::shared_ptr<STTx const>> const& txs)
+{
+    std::vector<int> results;
+    results.reserve (txs.size ());
+    reapplied_ = 0;
+
+    if (threads_ == 1)
+    {
+        for (auto const& tx : txs)
+            results.push_back (apply_ (view, tx));
+        return results;
+    }
+
+    std::vector<Outcome> outcomes;
+    for (std::size_t begin = 0; begin < txs.size (); begin += waveSize)
+    {
+        outcomes.clear ();
+        outcomes.resize (std::min<std::size_t> (
+            waveSize, txs.size () - begin));
+        speculate (view, txs, begin, outcomes);
+
+        // Keys changed by the transactions committed in this wave
+        std::set<uint256> written;
+
+        for (std::size_t i = 0; i < outcomes.size (); ++i)
+        {
+            auto& outcome = outcomes[i];
+            if (! outcome.ready || conflicts (outcome, written))
+            {
+                if (outcome.ready)
+                    ++reapplied_;
+                outcome = execute (view, txs[begin + i]);
+            }
+
+            commit (view, outcome);
+            results.push_back (outcome.result);
+
+            for (auto const& item : outcome.items)
+                written.insert (item.second->key ());
+            for (auto const& tx : outcome.txs)
+                written.insert (tx.key);
+        }
+    }
+
+    return results;
+}
+
+auto
+ParallelApply::execute (ReadView const& view,
+    std::shared_ptr<STTx const> const& tx) const -> Outcome
+{
+    Outcome outcome;
+    Recorder recorder (view, outcome);
+    OpenView sandbox (&recorder);
+    outcome.result = apply_ (sandbox, tx);
+
+    Collector collector (outcome);
+    sandbox.apply (collector);
+    outcome.ready = true;
+    return outcome;
+}
+
+// Apply each transaction in the wave to the view as it is now.
+// The view is only read until every thread is done.
+void
+ParallelApply::speculate (OpenView const& view,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+        std::size_t begin, std::vector<Outcome>& outcomes) const
+{
+    std::atomic<std::size_t> next (0);
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            auto const i = next++;
+            if (i >= outcomes.size ())
+                break;
+
+            auto const& tx = txs[begin + i];
+            if (isPseudoTx (*tx))
+                continue;
+
+            try
+            {
+                outcomes[i] = execute (view, tx);
+            }
+            catch (...)
+            {
+                // Leave it to be applied in order
+                outcomes[i] = Outcome ();
+            }
+        }
+    };
+
+    // Shared by every call, since a ledger's transactions
+    // take many waves and consensus applies them each round
+    static WorkerPool pool ("ParallelApply");
+    pool.run (static_cast<int> (std::min<std::size_t> (
+        threads_, outcomes.size ())), worker);
+}
+
+bool
+ParallelApply::conflicts (Outcome const& outcome,
+    std::set<uint256> const& written)
+{
+    if (written.empty ())
+        return false;
+
+    if (outcome.readAll)
+        return true;
+
+    for (auto const& key : outcome.reads)
+        if (written.count (key) != 0)
+            return true;
+
+    for (auto const& item : outcome.items)
+        if (written.count (item.second->key ()) != 0)
+            return true;
+
+    // succ looks at keys in the open interval (key, last)
+    for (auto const& range : outcome.ranges)
+    {
+        auto const iter = written.upper_bound (range.first);
+        if (iter != written.end () &&
+                (! range.second || *iter < *range.second))
+            return true;
+    }
+
+    return false;
+}
+
+void
+ParallelApply::commit (OpenView& view, Outcome const& outcome)
+{
+    assert (outcome.ready);
+
+    view.rawDestroyXRP (outcome.destroyed);
+
+    for (auto const& item : outcome.items)
+    {
+        switch (item.first)
+        {
+        case Outcome::Action::erase:
+            view.rawErase (item.second);
+            break;
+        case Outcome::Action::insert:
+            view.rawInsert (item.second);
+            break;
+        case Outcome::Action::replace:
+            view.rawReplace (item.second);
+            break;
+        }
+    }
+
+    for (auto const& tx : outcome.txs)
+    {
+        auto meta = tx.meta;
+        if (meta)
+            meta = reindex (meta,
+                static_cast<std::uint32_t> (view.txCount ()));
+        view.rawTxInsert (tx.key, tx.txn, meta);
+    }
+}
+
+} // ripple
@@ -21,6 +21,7 @@
 #include <ripple/app/tx/impl/Payment.h>
 #include <ripple/app/paths/RippleCalc.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/protocol/JsonFields.h>
 
@@ -274,7 +275,7 @@ Payment::doApply ()
         }
 
         // Create the account.
-        sleDst = std::make_shared<SLE>(k);
+        sleDst = make_shared_scoped<SLE>(k);
         sleDst->setAccountID (sfAccount, uDstAccountID);
         sleDst->setFieldU32 (sfSequence, 1);
         view().insert(sleDst);
@@ -28,6 +28,7 @@
 #include <ripple/protocol/STAccount.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <cstdint>
 #include <algorithm>
 
@@ -234,7 +235,7 @@ SetSignerList::replaceSignerList ()
         return tecINSUFFICIENT_RESERVE;
 
     // Everything's ducky.  Add the ltSIGNER_LIST to the ledger.
-    auto signerList = std::make_shared<SLE>(signerListKeylet);
+    auto signerList = make_shared_scoped<SLE>(signerListKeylet);
     view().insert (signerList);
     writeSignersToSLE (signerList);
 
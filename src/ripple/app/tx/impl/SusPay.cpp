@@ -21,6 +21,7 @@
 #include <ripple/app/tx/impl/SusPay.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/protocol/digest.h>
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/Feature.h>
@@ -214,7 +215,7 @@ SusPayCreate::doApply()
     }
 
     // Create SusPay in ledger
-    auto const slep = std::make_shared<SLE>(
+    auto const slep = make_shared_scoped<SLE>(
         keylet::susPay(account, (*sle)[sfSequence] - 1));
     (*slep)[sfAmount] = ctx_.tx[sfAmount];
     (*slep)[sfAccount] = account;
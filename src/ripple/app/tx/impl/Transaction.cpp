@@ -30,6 +30,45 @@
 
 namespace ripple {
 
+static
+bool
+multiSignEnabled ()
+{
+    return getApp().getLedgerMaster().getValidatedRules().enabled (
+        featureMultiSign, getConfig().features);
+}
+
+static
+bool
+checkSignature (STTx const& tx, RippleAddress const& pubKey,
+    bool allowMultiSign, SigVerify const& sigVerify, std::string& reason)
+{
+    if (! pubKey.isValid ())
+        reason = "Transaction has bad source public key";
+    else if (!sigVerify(tx, [allowMultiSign] (STTx const& stx)
+    {
+        return stx.checkSign(allowMultiSign);
+    }))
+        reason = "Transaction has bad signature";
+    else
+        return true;
+
+    WriteLog (lsWARNING, Ledger) << reason;
+    return false;
+}
+
+bool
+checkValidity (STTx const& tx, bool allowMultiSign,
+    SigVerify const& sigVerify, std::string& reason)
+{
+    if (! passesLocalChecks (tx, reason))
+        return false;
+
+    RippleAddress pubKey;
+    pubKey.setAccountPublic (tx.getSigningPubKey ());
+    return checkSignature (tx, pubKey, allowMultiSign, sigVerify, reason);
+}
+
 Transaction::Transaction (STTx::ref stx, Validate validate,
     SigVerify sigVerify, std::string& reason)
     noexcept
@@ -53,8 +92,7 @@ Transaction::Transaction (STTx::ref stx, Validate validate,
     }
 
     if (validate == Validate::NO ||
-        (passesLocalChecks (*mTransaction, reason) &&
-            checkSign (reason, sigVerify)))
+        checkValidity (*mTransaction, multiSignEnabled (), sigVerify, reason))
     {
         mStatus = NEW;
     }
@@ -90,21 +128,8 @@ Transaction::pointer Transaction::sharedTransaction (
 
 bool Transaction::checkSign (std::string& reason, SigVerify sigVerify) const
 {
-    bool const allowMultiSign = getApp().getLedgerMaster().
-        getValidatedRules().enabled (featureMultiSign, getConfig().features);
-
-    if (! mFromPubKey.isValid ())
-        reason = "Transaction has bad source public key";
-    else if (!sigVerify(*mTransaction, [allowMultiSign] (STTx const& tx)
-    {
-        return tx.checkSign(allowMultiSign);
-    }))
-        reason = "Transaction has bad signature";
-    else
-        return true;
-
-    WriteLog (lsWARNING, Ledger) << reason;
-    return false;
+    return checkSignature (*mTransaction, mFromPubKey,
+        multiSignEnabled (), sigVerify, reason);
 }
 
 void Transaction::setStatus (TransStatus ts, std::uint32_t lseq)
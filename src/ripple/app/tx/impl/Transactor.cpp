@@ -22,6 +22,7 @@
 #include <ripple/app/tx/impl/Transactor.h>
 #include <ripple/app/tx/impl/SignerEntries.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/LoadFeeTrack.h>
 #include <ripple/json/to_string.h>
@@ -493,6 +494,11 @@ Transactor::operator()()
     JLOG(j_.trace) <<
         "applyTransaction>";
 
+    // Ledger entries made while applying come from one arena. Those
+    // applied to the open view are copied to the heap, so the arena
+    // is freed soon after we're done.
+    ScopedArena arena;
+
     uint256 const& txID = tx().getTransactionID ();
 
     if (!txID)
@@ -0,0 +1,195 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SCOPEDARENA_H_INCLUDED
+#define RIPPLE_BASICS_SCOPEDARENA_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace ripple {
+
+/** Memory for many small objects which die at about the same time.
+
+    Memory is handed out from large blocks in order and never reused.
+    Every allocation holds a reference to the arena, and the blocks
+    are freed when the last one is deallocated, so objects may outlive
+    whoever made the arena. Allocation is not thread safe, but
+    deallocation may happen on any thread.
+*/
+class Arena
+{
+private:
+    enum
+    {
+        blockSize = 8 * 1024
+    };
+
+    struct Block
+    {
+        Block* next;
+    };
+
+    Block* blocks_ = nullptr;
+    char* pos_ = nullptr;
+    char* end_ = nullptr;
+    std::atomic<std::size_t> refs_ {1};
+
+    ~Arena();
+
+public:
+    Arena() = default;
+    Arena (Arena const&) = delete;
+    Arena& operator= (Arena const&) = delete;
+
+    void*
+    allocate (std::size_t size, std::size_t align)
+    {
+        auto const pos = reinterpret_cast<std::uintptr_t>(pos_);
+        auto const p = (pos + align - 1) &
+            ~static_cast<std::uintptr_t>(align - 1);
+        if (! pos_ || p + size > reinterpret_cast<std::uintptr_t>(end_))
+            return grow (size, align);
+        pos_ = reinterpret_cast<char*>(p + size);
+        retain();
+        return reinterpret_cast<void*>(p);
+    }
+
+    void
+    deallocate (void*)
+    {
+        release();
+    }
+
+    void
+    retain()
+    {
+        refs_.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    /** Drop a reference, freeing the arena with the last. */
+    void
+    release()
+    {
+        if (refs_.fetch_sub (1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+private:
+    void*
+    grow (std::size_t size, std::size_t align);
+};
+
+/** An allocator which draws from an Arena. */
+template <class T>
+class ArenaAllocator
+{
+private:
+    template <class>
+    friend class ArenaAllocator;
+
+    Arena* arena_;
+
+public:
+    using value_type = T;
+
+    explicit
+    ArenaAllocator (Arena& arena)
+        : arena_ (&arena)
+    {
+    }
+
+    template <class U>
+    ArenaAllocator (ArenaAllocator<U> const& other)
+        : arena_ (other.arena_)
+    {
+    }
+
+    T*
+    allocate (std::size_t n)
+    {
+        return static_cast<T*>(arena_->allocate (
+            n * sizeof(T), alignof(T)));
+    }
+
+    void
+    deallocate (T* p, std::size_t)
+    {
+        arena_->deallocate (p);
+    }
+
+    template <class U>
+    bool
+    operator== (ArenaAllocator<U> const& other) const
+    {
+        return arena_ == other.arena_;
+    }
+
+    template <class U>
+    bool
+    operator!= (ArenaAllocator<U> const& other) const
+    {
+        return arena_ != other.arena_;
+    }
+};
+
+/** RAII use of a new Arena by the calling thread.
+    While one of these exists, make_shared_scoped called on the thread
+    allocates from its arena. Without one, it uses the heap.
+*/
+class ScopedArena
+{
+private:
+    ScopedArena* prev_;
+    Arena* arena_;
+
+public:
+    ScopedArena();
+    ~ScopedArena();
+
+    ScopedArena (ScopedArena const&) = delete;
+    ScopedArena& operator= (ScopedArena const&) = delete;
+
+    /** Returns the arena of the calling thread, or nullptr. */
+    static
+    Arena*
+    get();
+};
+
+/** Like std::make_shared, using the calling thread's arena if any.
+
+    Use this for objects which don't outlive the work done in the
+    scope by much. Each one keeps all of the arena's memory alive.
+*/
+template <class T, class... Args>
+std::shared_ptr<T>
+make_shared_scoped (Args&&... args)
+{
+    if (auto const arena = ScopedArena::get())
+        return std::allocate_shared<T>(ArenaAllocator<T>(*arena),
+            std::forward<Args>(args)...);
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+} // ripple
+
+#endif
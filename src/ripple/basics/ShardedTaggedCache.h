@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+#define RIPPLE_BASICS_SHARDEDTAGGEDCACHE_H_INCLUDED
+
+#include <ripple/basics/TaggedCache.h>
+#include <beast/cxx14/memory.h> // <memory>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** A TaggedCache split into independently locked partitions.
+
+    Each key belongs to exactly one shard, chosen by hashing the key. A
+    shard is a complete TaggedCache with its own lock, map and share of the
+    target size, so threads working on different keys rarely contend.
+    sweep() visits the shards one at a time and only ever holds the lock
+    of the shard being swept.
+
+    There is no single lock over the whole cache, so unlike TaggedCache
+    there is no peekMutex(). Code which needs to lock out all cache
+    operations should use a TaggedCache.
+*/
+template <
+    class Key,
+    class T,
+    class Hash = hardened_hash <>,
+    class KeyEqual = std::equal_to <Key>,
+    class Mutex = std::recursive_mutex
+>
+class ShardedTaggedCache
+{
+private:
+    using shard_type = TaggedCache <Key, T, Hash, KeyEqual, Mutex>;
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using weak_mapped_ptr = typename shard_type::weak_mapped_ptr;
+    using mapped_ptr = typename shard_type::mapped_ptr;
+    using clock_type = typename shard_type::clock_type;
+
+    /** The number of shards used when none is given. */
+    static int const defaultShards = 16;
+
+public:
+    ShardedTaggedCache (std::string const& name, int size,
+        typename clock_type::rep expiration_seconds, clock_type& clock,
+            beast::Journal journal,
+                beast::insight::Collector::ptr const& collector =
+                    beast::insight::NullCollector::New (),
+                        int shards = defaultShards)
+        : m_clock (clock)
+        , m_stats (name,
+            std::bind (&ShardedTaggedCache::collect_metrics, this),
+                collector)
+        , m_target_size (size)
+    {
+        assert (shards > 0);
+        m_shards.reserve (shards);
+        for (int i = 0; i < shards; ++i)
+            m_shards.push_back (std::make_unique <shard_type> (
+                name, shardSize (size, shards), expiration_seconds,
+                    clock, journal));
+    }
+
+public:
+    /** Return the clock associated with the cache. */
+    clock_type& clock ()
+    {
+        return m_clock;
+    }
+
+    /** Return the number of shards. */
+    int shards () const
+    {
+        return static_cast<int> (m_shards.size ());
+    }
+
+    int getTargetSize () const
+    {
+        std::lock_guard <std::mutex> lock (m_mutex);
+        return m_target_size;
+    }
+
+    void setTargetSize (int s)
+    {
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            m_target_size = s;
+        }
+
+        for (auto& shard : m_shards)
+            shard->setTargetSize (shardSize (s, shards ()));
+    }
+
+    typename clock_type::rep getTargetAge () const
+    {
+        return m_shards.front ()->getTargetAge ();
+    }
+
+    void setTargetAge (typename clock_type::rep s)
+    {
+        for (auto& shard : m_shards)
+            shard->setTargetAge (s);
+    }
+
+    int getCacheSize () const
+    {
+        int size = 0;
+        for (auto const& shard : m_shards)
+            size += shard->getCacheSize ();
+        return size;
+    }
+
+    int getTrackSize () const
+    {
+        int size = 0;
+        for (auto const& shard : m_shards)
+            size += shard->getTrackSize ();
+        return size;
+    }
+
+    /** Returns the hit rate over all shards. */
+    float getHitRate ()
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        for (auto& shard : m_shards)
+        {
+            auto const stats = shard->getHitsAndMisses ();
+            hits += stats.first;
+            misses += stats.second;
+        }
+        auto const total = static_cast<float> (hits + misses);
+        return hits * (100.0f / std::max (1.0f, total));
+    }
+
+    void clearStats ()
+    {
+        for (auto& shard : m_shards)
+            shard->clearStats ();
+    }
+
+    void clear ()
+    {
+        for (auto& shard : m_shards)
+            shard->clear ();
+    }
+
+    /** Sweep every shard, one after another. */
+    void sweep ()
+    {
+        for (auto& shard : m_shards)
+            shard->sweep ();
+    }
+
+    /** Sweep the next shard.
+
+        Callers which can't afford to walk the whole cache at once can call
+        this repeatedly. After shards() calls every shard has been swept.
+    */
+    void sweepNext ()
+    {
+        std::size_t next;
+        {
+            std::lock_guard <std::mutex> lock (m_mutex);
+            next = m_next_sweep;
+            m_next_sweep = (m_next_sweep + 1) % m_shards.size ();
+        }
+
+        m_shards[next]->sweep ();
+    }
+
+    bool del (key_type const& key, bool valid)
+    {
+        return shard (key).del (key, valid);
+    }
+
+    /** Replace aliased objects with originals.
+
+        @see TaggedCache::canonicalize
+    */
+    bool canonicalize (key_type const& key, std::shared_ptr<T>& data,
+        bool replace = false)
+    {
+        return shard (key).canonicalize (key, data, replace);
+    }
+
+    std::shared_ptr<T> fetch (key_type const& key)
+    {
+        return shard (key).fetch (key);
+    }
+
+    bool insert (key_type const& key, T const& value)
+    {
+        return shard (key).insert (key, value);
+    }
+
+    bool retrieve (key_type const& key, T& data)
+    {
+        return shard (key).retrieve (key, data);
+    }
+
+    bool refreshIfPresent (key_type const& key)
+    {
+        return shard (key).refreshIfPresent (key);
+    }
+
+    std::vector <key_type> getKeys ()
+    {
+        std::vector <key_type> v;
+        for (auto& shard : m_shards)
+        {
+            auto keys = shard->getKeys ();
+            v.insert (v.end (), keys.begin (), keys.end ());
+        }
+        return v;
+    }
+
+private:
+    static int shardSize (int size, int shards)
+    {
+        // 0 means no target size
+        if (size <= 0)
+            return size;
+        return std::max (1, (size + shards - 1) / shards);
+    }
+
+    shard_type& shard (key_type const& key)
+    {
+        std::size_t const h = m_hash (key);
+        return *m_shards[(h >> (std::numeric_limits<std::size_t>::digits / 2))
+            % m_shards.size ()];
+    }
+
+    void collect_metrics ()
+    {
+        m_stats.size.set (getCacheSize ());
+        m_stats.hit_rate.set (
+            static_cast<beast::insight::Gauge::value_type> (getHitRate ()));
+    }
+
+private:
+    struct Stats
+    {
+        template <class Handler>
+        Stats (std::string const& prefix, Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge (prefix, "size"))
+            , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    clock_type& m_clock;
+    Stats m_stats;
+
+    // Chooses the shard from the high bits of the hash, so the keys in
+    // one shard still spread evenly over that shard's buckets.
+    Hash m_hash;
+
+    std::vector <std::unique_ptr <shard_type>> m_shards;
+
+    std::mutex mutable m_mutex;
+
+    // Desired number of cache entries over all shards (0 = ignore)
+    int m_target_size;
+
+    // The shard sweepNext will sweep
+    std::size_t m_next_sweep = 0;
+};
+
+}
+
+#endif
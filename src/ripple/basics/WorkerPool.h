@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_WORKERPOOL_H_INCLUDED
+#define RIPPLE_BASICS_WORKERPOOL_H_INCLUDED
+
+#include <beast/intrusive/LockFreeStack.h>
+#include <beast/module/core/thread/Workers.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace ripple {
+
+/** Threads which help the caller with work split across threads.
+
+    Work which is split up many times a second, like flushing a ledger's
+    state map, can't afford to create and join threads each time. The
+    pool's threads are created when first needed and wait between calls.
+*/
+class WorkerPool
+    : private beast::Workers::Callback
+{
+public:
+    explicit
+    WorkerPool (std::string const& name);
+
+    WorkerPool (WorkerPool const&) = delete;
+    WorkerPool& operator= (WorkerPool const&) = delete;
+
+    /** Call f on the calling thread and on n - 1 pool threads at once.
+
+        Returns when every call has returned. Each call should take work
+        from a shared counter until there is none left, since some calls
+        may start after the work is done. If a call throws, the first
+        exception is rethrown. Calls to run are made one at a time, and
+        f must not call run on the same pool.
+    */
+    void
+    run (int n, std::function<void()> const& f);
+
+private:
+    void
+    processTask() override;
+
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::function<void()> const* f_ = nullptr;
+    int pending_ = 0;
+    std::exception_ptr error_;
+
+    // Last, so the threads stop before the rest is destroyed
+    beast::Workers workers_;
+};
+
+} // ripple
+
+#endif
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/ScopedArena.h>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <new>
+
+namespace ripple {
+
+Arena::~Arena()
+{
+    while (blocks_)
+    {
+        auto const next = blocks_->next;
+        ::operator delete (blocks_);
+        blocks_ = next;
+    }
+}
+
+void*
+Arena::grow (std::size_t size, std::size_t align)
+{
+    // Allocations too big for a block get one of their own
+    auto const bytes = std::max<std::size_t> (blockSize,
+        sizeof(Block) + align + size);
+    auto const block = static_cast<Block*>(::operator new (bytes));
+    block->next = blocks_;
+    blocks_ = block;
+    pos_ = reinterpret_cast<char*>(block + 1);
+    end_ = reinterpret_cast<char*>(block) + bytes;
+    return allocate (size, align);
+}
+
+//------------------------------------------------------------------------------
+
+static
+void
+cleanup (ScopedArena*)
+{
+}
+
+static
+boost::thread_specific_ptr<ScopedArena> scopedArenaPtr (&cleanup);
+
+ScopedArena::ScopedArena()
+    : prev_ (scopedArenaPtr.get())
+    , arena_ (new Arena)
+{
+    scopedArenaPtr.reset (this);
+}
+
+ScopedArena::~ScopedArena()
+{
+    scopedArenaPtr.reset (prev_);
+    arena_->release();
+}
+
+Arena*
+ScopedArena::get()
+{
+    if (auto const p = scopedArenaPtr.get())
+        return p->arena_;
+    return nullptr;
+}
+
+} // ripple
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/WorkerPool.h>
+#include <algorithm>
+
+namespace ripple {
+
+WorkerPool::WorkerPool (std::string const& name)
+    : workers_ (*this, name, 0)
+{
+}
+
+void
+WorkerPool::run (int n, std::function<void()> const& f)
+{
+    std::lock_guard<std::mutex> runLock (runMutex_);
+
+    n = std::max (n, 1);
+
+    if (workers_.getNumberOfThreads() < n - 1)
+        workers_.setNumberOfThreads (n - 1);
+
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        f_ = &f;
+        pending_ = n - 1;
+        error_ = nullptr;
+    }
+    for (int i = 1; i < n; ++i)
+        workers_.addTask();
+
+    std::exception_ptr error;
+    try
+    {
+        f();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock (mutex_);
+    cond_.wait (lock, [this]{ return pending_ == 0; });
+    f_ = nullptr;
+    if (! error)
+        error = error_;
+    lock.unlock();
+
+    if (error)
+        std::rethrow_exception (error);
+}
+
+void
+WorkerPool::processTask()
+{
+    std::function<void()> const* f;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        f = f_;
+    }
+
+    std::exception_ptr error;
+    try
+    {
+        (*f)();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (error && ! error_)
+        error_ = error;
+    if (--pending_ == 0)
+        cond_.notify_all();
+}
+
+} // ripple
@@ -0,0 +1,139 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/ScopedArena.h>
+#include <beast/unit_test/suite.h>
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class ScopedArena_test : public beast::unit_test::suite
+{
+public:
+    // Counts live instances
+    struct Counted
+    {
+        static int live;
+        int value;
+
+        explicit
+        Counted (int v)
+            : value (v)
+        {
+            ++live;
+        }
+
+        ~Counted ()
+        {
+            --live;
+        }
+    };
+
+    void testScope ()
+    {
+        testcase ("scope");
+
+        expect (ScopedArena::get () == nullptr);
+        {
+            ScopedArena outer;
+            auto const arena = ScopedArena::get ();
+            expect (arena != nullptr);
+            {
+                ScopedArena inner;
+                expect (ScopedArena::get () != arena, "Should nest");
+            }
+            expect (ScopedArena::get () == arena, "Should restore");
+
+            // Other threads have their own
+            Arena* other = arena;
+            std::thread ([&]{ other = ScopedArena::get (); }).join ();
+            expect (other == nullptr);
+        }
+        expect (ScopedArena::get () == nullptr);
+    }
+
+    void testLifetime ()
+    {
+        testcase ("lifetime");
+
+        std::vector<std::shared_ptr<Counted>> kept;
+        {
+            ScopedArena arena;
+            for (int i = 0; i < 10000; ++i)
+            {
+                auto p = make_shared_scoped<Counted> (i);
+                if (i % 100 == 0)
+                    kept.push_back (std::move (p));
+            }
+            expect (static_cast<std::size_t> (Counted::live) == kept.size ());
+        }
+
+        // Objects outlive the scope
+        bool ok = true;
+        for (std::size_t i = 0; i < kept.size (); ++i)
+            ok = ok && kept[i]->value == static_cast<int> (i * 100);
+        expect (ok, "Values should survive the scope");
+
+        // And may die on another thread
+        std::thread ([&]{ kept.clear (); }).join ();
+        expect (Counted::live == 0);
+    }
+
+    void testAlignment ()
+    {
+        testcase ("alignment");
+
+        ScopedArena scope;
+        auto& arena = *ScopedArena::get ();
+        bool ok = true;
+        for (std::size_t align : { 1, 2, 4, 8, 16 })
+        {
+            for (std::size_t size : { 1, 3, 24, 5000, 100000 })
+            {
+                auto const p = arena.allocate (size, align);
+                ok = ok && (reinterpret_cast<std::uintptr_t> (p) %
+                    align) == 0;
+
+                // Writes must not overlap other allocations
+                std::fill_n (static_cast<char*> (p), size, 0);
+                arena.deallocate (p);
+            }
+        }
+        expect (ok, "Misaligned");
+
+        auto big = make_shared_scoped<std::array<char, 100000>> ();
+        expect (big->size () == 100000);
+    }
+
+    void run () override
+    {
+        testScope ();
+        testLifetime ();
+        testAlignment ();
+    }
+};
+
+int ScopedArena_test::Counted::live = 0;
+
+BEAST_DEFINE_TESTSUITE(ScopedArena,basics,ripple);
+
+} // ripple
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace ripple {
+
+class ShardedTaggedCache_test : public beast::unit_test::suite
+{
+public:
+    using Key = int;
+    using Value = std::string;
+    using Cache = ShardedTaggedCache <Key, Value>;
+
+    void testBasics ()
+    {
+        testcase ("basics");
+
+        beast::Journal const j;
+        TestStopwatch clock;
+        clock.set (0);
+
+        Cache c ("test", 1, 1, clock, j);
+
+        // Insert an item, retrieve it, and age it so it gets purged.
+        {
+            expect (c.getCacheSize() == 0);
+            expect (c.getTrackSize() == 0);
+            expect (! c.insert (1, "one"));
+            expect (c.getCacheSize() == 1);
+            expect (c.getTrackSize() == 1);
+
+            {
+                std::string s;
+                expect (c.retrieve (1, s));
+                expect (s == "one");
+            }
+
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize () == 0);
+            expect (c.getTrackSize () == 0);
+        }
+
+        // Insert an item, maintain a strong pointer, age it, and
+        // verify that the entry still exists.
+        {
+            expect (! c.insert (2, "two"));
+
+            {
+                Cache::mapped_ptr p (c.fetch (2));
+                expect (p != nullptr);
+                ++clock;
+                c.sweep ();
+                expect (c.getCacheSize() == 0);
+                expect (c.getTrackSize() == 1);
+
+                // Canonicalize a new object with the same key and
+                // make sure we get the original object
+                Cache::mapped_ptr p2 (std::make_shared <Value> ("two"));
+                expect (c.canonicalize (2, p2));
+                expect (p.get() == p2.get());
+            }
+
+            ++clock;
+            c.sweep ();
+            expect (c.getCacheSize() == 0);
+            expect (c.getTrackSize() == 0);
+        }
+    }
+
+    void testShards ()
+    {
+        testcase ("shards");
+
+        beast::Journal const j;
+        TestStopwatch clock;
+        clock.set (0);
+
+        int const shards = 8;
+        int const items = 1000;
+        Cache c ("test", 64, 1, clock, j,
+            beast::insight::NullCollector::New (), shards);
+        expect (c.shards () == shards);
+        expect (c.getTargetSize () == 64);
+
+        for (int i = 0; i < items; ++i)
+            expect (! c.insert (i, std::to_string (i)));
+        expect (c.getCacheSize () == items);
+        expect (c.getTrackSize () == items);
+
+        {
+            auto keys = c.getKeys ();
+            std::sort (keys.begin (), keys.end ());
+            expect (keys.size () == items);
+            for (int i = 0; i < keys.size (); ++i)
+                expect (keys[i] == i);
+        }
+
+        for (int i = 0; i < items; ++i)
+        {
+            auto const p = c.fetch (i);
+            expect (p && *p == std::to_string (i));
+        }
+
+        // Hits in one shard and misses in others
+        c.clearStats ();
+        for (int i = 0; i < 30; ++i)
+            expect (c.fetch (0) != nullptr);
+        for (int i = 0; i < 10; ++i)
+            expect (c.fetch (items + i) == nullptr);
+        expect (std::abs (c.getHitRate () - 75) < 0.01,
+            "Hit rate should count every lookup");
+
+        expect (c.del (7, false));
+        expect (c.fetch (7) == nullptr);
+        expect (c.getTrackSize () == items - 1);
+
+        // Sweep the shards one at a time
+        ++clock;
+        for (int i = 0; i < shards; ++i)
+        {
+            expect (c.getTrackSize () != 0);
+            c.sweepNext ();
+        }
+        expect (c.getCacheSize () == 0);
+        expect (c.getTrackSize () == 0);
+    }
+
+    void run ()
+    {
+        testBasics ();
+        testShards ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardedTaggedCache,common,ripple);
+
+}
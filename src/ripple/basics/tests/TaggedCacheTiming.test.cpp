@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/basics/ShardedTaggedCache.h>
+#include <ripple/basics/TaggedCache.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <beast/unit_test/thread.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace ripple {
+
+// Measures how TaggedCache and ShardedTaggedCache behave as more
+// threads use one cache at the same time.
+//
+// Each thread does a mix of fetches and canonicalizes on random keys,
+// the way the NodeStore and tree node caches are used, while another
+// thread sweeps the cache in a loop.
+class TaggedCacheTiming_test : public beast::unit_test::suite
+{
+public:
+#ifndef NDEBUG
+    std::size_t const keys = 100000;
+    std::size_t const ops = 1000000;
+#else
+    std::size_t const keys = 1000000; // release
+    std::size_t const ops = 10000000;
+#endif
+
+    using clock_type = std::chrono::steady_clock;
+    using Key = std::uint64_t;
+    using Value = std::uint64_t;
+
+    static
+    std::string
+    to_string (clock_type::duration d)
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3) <<
+            (std::chrono::duration_cast<std::chrono::milliseconds>(
+                d).count() / 1000.) << "s";
+        return ss.str();
+    }
+
+    template <class Cache>
+    clock_type::duration
+    measure (Cache& c, std::size_t threads)
+    {
+        std::atomic<std::size_t> next (0);
+        std::atomic<bool> stop (false);
+        std::size_t const chunk = 1000;
+
+        auto const start = clock_type::now ();
+
+        beast::unit_test::thread sweeper (*this, [&]()
+        {
+            while (! stop)
+                c.sweep ();
+        });
+
+        std::vector<beast::unit_test::thread> pool;
+        pool.reserve (threads);
+        for (std::size_t id = 0; id < threads; ++id)
+        {
+            pool.emplace_back (*this, [&, id]()
+            {
+                beast::xor_shift_engine gen (id + 1);
+                for (;;)
+                {
+                    auto const begin = next.fetch_add (chunk);
+                    if (begin >= ops)
+                        break;
+                    auto const end = std::min (begin + chunk, ops);
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        Key const key = gen() % keys;
+                        if (gen() % 10 != 0)
+                        {
+                            if (c.fetch (key))
+                                continue;
+                        }
+                        auto p = std::make_shared<Value> (key);
+                        c.canonicalize (key, p);
+                    }
+                }
+            });
+        }
+        for (auto& t : pool)
+            t.join ();
+        auto const elapsed = clock_type::now () - start;
+
+        stop = true;
+        sweeper.join ();
+        return elapsed;
+    }
+
+    void
+    run () override
+    {
+        beast::Journal const j;
+
+        std::stringstream ss;
+        ss << std::left << std::setw(10) << "threads" <<
+            std::setw(14) << "TaggedCache" << std::setw(14) << "Sharded";
+        log << ss.str();
+
+        for (std::size_t threads : { 1, 2, 4, 8, 16, 32 })
+        {
+            TaggedCache <Key, Value> single (
+                "test", keys / 2, 60, stopwatch(), j);
+            ShardedTaggedCache <Key, Value> sharded (
+                "test", keys / 2, 60, stopwatch(), j);
+
+            auto const t0 = measure (single, threads);
+            auto const t1 = measure (sharded, threads);
+
+            ss.str ("");
+            ss << std::left << std::setw(10) << threads <<
+                std::setw(14) << to_string (t0) <<
+                std::setw(14) << to_string (t1);
+            log << ss.str();
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(TaggedCacheTiming,common,ripple);
+
+}
@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/basics/WorkerPool.h>
+#include <beast/unit_test/suite.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class WorkerPool_test : public beast::unit_test::suite
+{
+public:
+    void testRun ()
+    {
+        testcase ("run");
+
+        WorkerPool pool ("test");
+        for (int n : { 1, 4, 2, 8 })
+        {
+            std::vector<int> done (1000, 0);
+            std::atomic<std::size_t> next (0);
+            std::atomic<int> calls (0);
+            std::atomic<int> onCaller (0);
+            auto const caller = std::this_thread::get_id ();
+            pool.run (n, [&]
+            {
+                ++calls;
+                if (std::this_thread::get_id () == caller)
+                    ++onCaller;
+                for (;;)
+                {
+                    auto const i = next++;
+                    if (i >= done.size ())
+                        return;
+                    ++done[i];
+                }
+            });
+
+            bool ok = true;
+            for (auto const d : done)
+                ok = ok && d == 1;
+            expect (ok, "Each item should be done once");
+            expect (calls == n, "Should call f n times");
+            expect (onCaller == 1, "Should call f on the caller");
+        }
+    }
+
+    void testException ()
+    {
+        testcase ("exception");
+
+        WorkerPool pool ("test");
+        std::atomic<int> calls (0);
+        bool thrown = false;
+        try
+        {
+            pool.run (4, [&]
+            {
+                if (++calls == 2)
+                    throw std::runtime_error ("test");
+            });
+        }
+        catch (std::runtime_error const&)
+        {
+            thrown = true;
+        }
+        expect (thrown, "Should rethrow");
+        expect (calls == 4, "Should finish every call");
+
+        // The pool is still usable
+        calls = 0;
+        pool.run (4, [&]{ ++calls; });
+        expect (calls == 4);
+    }
+
+    void run () override
+    {
+        testRun ();
+        testException ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(WorkerPool,basics,ripple);
+
+} // ripple
@@ -248,6 +248,8 @@ public:
     // Node storage configuration
     std::uint32_t                      LEDGER_HISTORY;
     std::uint32_t                      FETCH_DEPTH;
+    int                                LEDGER_FLUSH_THREADS;   // Threads used to flush a closed ledger
+    int                                LEDGER_APPLY_THREADS;   // Threads used to apply a consensus set
     int                         NODE_SIZE;
 
     // Client behavior
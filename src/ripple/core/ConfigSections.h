@@ -29,6 +29,8 @@ struct ConfigSection
 {
     static std::string nodeDatabase ()       { return "node_db"; }
     static std::string importNodeDatabase () { return "import_db"; }
+    static std::string shardDatabase ()      { return "shard_db"; }
+    static std::string fastDatabase ()       { return "fast_db"; }
 };
 
 // VFALCO TODO Rename and replace these macros with variables.
@@ -44,6 +46,8 @@ struct ConfigSection
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
+#define SECTION_LEDGER_FLUSH_THREADS    "ledger_flush_threads"
+#define SECTION_LEDGER_APPLY_THREADS    "ledger_apply_threads"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
 #define SECTION_IPS_FIXED               "ips_fixed"
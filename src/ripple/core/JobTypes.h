@@ -38,6 +38,10 @@ public:
     {
         int maxLimit = std::numeric_limits <int>::max ();
 
+        // Load nodes the next ledger is likely to need
+        add (jtPREFETCH,      "prefetchLedger",
+            1,        true,   false, 0,     0);
+
         // Make a fetch pack for a peer
         add (jtPACK,          "makeFetchPack",
             1,        true,   false, 0,     0);
@@ -218,6 +218,8 @@ Config::Config ()
 
     LEDGER_HISTORY          = 256;
     FETCH_DEPTH             = 1000000000;
+    LEDGER_FLUSH_THREADS    = 1;
+    LEDGER_APPLY_THREADS    = 1;
 
     // An explanation of these magical values would be nice.
     PATH_SEARCH_OLD         = 7;
@@ -535,6 +537,22 @@ void Config::loadFromString (std::string const& fileContents)
             FETCH_DEPTH = 10;
     }
 
+    if (getSingleSection (secConfig, SECTION_LEDGER_FLUSH_THREADS, strTemp))
+    {
+        LEDGER_FLUSH_THREADS = beast::lexicalCastThrow <int> (strTemp);
+
+        if (LEDGER_FLUSH_THREADS < 1)
+            LEDGER_FLUSH_THREADS = 1;
+    }
+
+    if (getSingleSection (secConfig, SECTION_LEDGER_APPLY_THREADS, strTemp))
+    {
+        LEDGER_APPLY_THREADS = beast::lexicalCastThrow <int> (strTemp);
+
+        if (LEDGER_APPLY_THREADS < 1)
+            LEDGER_APPLY_THREADS = 1;
+    }
+
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH_OLD, strTemp))
         PATH_SEARCH_OLD     = beast::lexicalCastThrow <int> (strTemp);
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH, strTemp))
@@ -152,8 +152,11 @@ public:
 
     /** Returns `true` if two rule sets are identical.
 
-        @note This is for diagnostics. To determine if new
-        rules should be constructed, call changed() first instead.
+        Rules built from ledgers with the same amendments
+        are identical.
+
+        @note To determine if new rules should be constructed,
+        call changed() first instead.
     */
     bool
     operator== (Rules const&) const;
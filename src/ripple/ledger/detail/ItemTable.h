@@ -0,0 +1,381 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_LEDGER_ITEMTABLE_H_INCLUDED
+#define RIPPLE_LEDGER_ITEMTABLE_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+namespace detail {
+
+/** Associates ledger keys with values, for the state tables.
+
+    Items are kept in one vector and found through an open
+    addressing table with linear probing, which is much cheaper
+    than walking a tree for the lookups views make on every read.
+
+    Ordered access, which only succ() and applying the table need,
+    goes through an index of items sorted by key. It is brought up
+    to date the first time it is needed after an item is added or
+    removed, which concurrent readers may do safely. Items added
+    since then are sorted and merged in; removing an item means
+    sorting everything again.
+
+    Adding or removing an item invalidates pointers to items and
+    ordered iterators.
+*/
+template <class T>
+class ItemTable
+{
+public:
+    using key_type = uint256;
+    using value_type = std::pair<key_type, T>;
+
+    /** Visits items in key order. */
+    class const_iterator
+    {
+    private:
+        friend class ItemTable;
+
+        ItemTable const* table_ = nullptr;
+        std::vector<std::uint32_t>::const_iterator iter_;
+
+        const_iterator (ItemTable const* table,
+                std::vector<std::uint32_t>::const_iterator iter)
+            : table_ (table)
+            , iter_ (iter)
+        {
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ItemTable::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type const*;
+        using reference = value_type const&;
+
+        const_iterator() = default;
+
+        reference
+        operator*() const
+        {
+            return table_->items_[*iter_];
+        }
+
+        pointer
+        operator->() const
+        {
+            return &**this;
+        }
+
+        const_iterator&
+        operator++()
+        {
+            ++iter_;
+            return *this;
+        }
+
+        const_iterator
+        operator++(int)
+        {
+            auto const prev = *this;
+            ++iter_;
+            return prev;
+        }
+
+        bool
+        operator== (const_iterator const& other) const
+        {
+            return iter_ == other.iter_;
+        }
+
+        bool
+        operator!= (const_iterator const& other) const
+        {
+            return iter_ != other.iter_;
+        }
+    };
+
+private:
+    enum
+    {
+        minSlots = 16
+    };
+
+    std::vector<value_type> items_;
+
+    // One plus the index of an item, or zero if empty
+    std::vector<std::uint32_t> slots_;
+    int shift_ = 64;
+
+    std::mutex mutable mutex_;
+    std::atomic<bool> mutable sorted_ {true};
+    std::vector<std::uint32_t> mutable order_;
+
+    // Whether order_ holds every item before the
+    // first added since it was last brought up to date
+    bool mutable merge_ = true;
+
+public:
+    ItemTable() = default;
+
+    ItemTable (ItemTable const& other)
+        : items_ (other.items_)
+        , slots_ (other.slots_)
+        , shift_ (other.shift_)
+        , sorted_ (items_.empty())
+        , merge_ (items_.empty())
+    {
+    }
+
+    ItemTable (ItemTable&& other)
+        : items_ (std::move(other.items_))
+        , slots_ (std::move(other.slots_))
+        , shift_ (other.shift_)
+        , sorted_ (items_.empty())
+        , merge_ (items_.empty())
+    {
+        other.items_.clear();
+        other.slots_.clear();
+        other.shift_ = 64;
+        other.order_.clear();
+        other.sorted_ = true;
+        other.merge_ = true;
+    }
+
+    ItemTable& operator= (ItemTable const&) = delete;
+
+    std::size_t
+    size() const
+    {
+        return items_.size();
+    }
+
+    bool
+    empty() const
+    {
+        return items_.empty();
+    }
+
+    /** Returns the item with the key, or nullptr. */
+    /** @{ */
+    value_type*
+    find (key_type const& key)
+    {
+        auto const slot = lookup(key);
+        if (slots_.empty() || slots_[slot] == 0)
+            return nullptr;
+        return &items_[slots_[slot] - 1];
+    }
+
+    value_type const*
+    find (key_type const& key) const
+    {
+        return const_cast<ItemTable&>(*this).find(key);
+    }
+    /** @} */
+
+    /** Add an item if the key isn't present.
+
+        The value is constructed from the arguments.
+
+        @return The item with the key, and `true` if it was added.
+    */
+    template <class... Args>
+    std::pair<value_type*, bool>
+    emplace (key_type const& key, Args&&... args)
+    {
+        if ((items_.size() + 1) * 2 > slots_.size())
+            grow();
+        auto const slot = lookup(key);
+        if (slots_[slot] != 0)
+            return { &items_[slots_[slot] - 1], false };
+        items_.emplace_back(std::piecewise_construct,
+            std::forward_as_tuple(key),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        slots_[slot] = static_cast<std::uint32_t>(items_.size());
+        sorted_.store(false, std::memory_order_relaxed);
+        return { &items_.back(), true };
+    }
+
+    /** Remove an item. */
+    void
+    erase (value_type const* item)
+    {
+        assert(item >= items_.data() &&
+            item < items_.data() + items_.size());
+        auto const index = static_cast<std::uint32_t>(
+            item - items_.data());
+        vacate(lookup(item->first));
+
+        // Fill the hole with the last item
+        auto const last = static_cast<std::uint32_t>(
+            items_.size() - 1);
+        if (index != last)
+        {
+            slots_[lookup(items_[last].first)] = index + 1;
+            items_[index] = std::move(items_[last]);
+        }
+        items_.pop_back();
+        sorted_.store(false, std::memory_order_relaxed);
+        merge_ = false;
+    }
+
+    /** Returns every item, in no particular order. */
+    std::vector<value_type> const&
+    unordered() const
+    {
+        return items_;
+    }
+
+    /** Ordered access. */
+    /** @{ */
+    const_iterator
+    begin() const
+    {
+        return { this, order().begin() };
+    }
+
+    const_iterator
+    end() const
+    {
+        return { this, order().end() };
+    }
+
+    /** Returns the first item whose key is greater than key. */
+    const_iterator
+    upper_bound (key_type const& key) const
+    {
+        auto const& v = order();
+        return { this, std::upper_bound(v.begin(), v.end(), key,
+            [this](key_type const& k, std::uint32_t i)
+            {
+                return k < items_[i].first;
+            }) };
+    }
+    /** @} */
+
+private:
+    // The keys are hashes, but some share their leading bytes,
+    // like the directories of one order book. Fold in every word.
+    std::size_t
+    home (key_type const& key) const
+    {
+        std::uint64_t w[4];
+        static_assert(sizeof(w) == key_type::bytes, "");
+        std::memcpy(w, key.data(), sizeof(w));
+        auto const h = (w[0] ^ w[1] ^ w[2] ^ w[3]) *
+            0x9E3779B97F4A7C15ULL;
+        return static_cast<std::size_t>(h >> shift_);
+    }
+
+    // Returns the slot holding the key, or the empty
+    // slot where it would go.
+    std::size_t
+    lookup (key_type const& key) const
+    {
+        if (slots_.empty())
+            return 0;
+        auto const mask = slots_.size() - 1;
+        auto slot = home(key);
+        while (slots_[slot] != 0 &&
+                items_[slots_[slot] - 1].first != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    // Empty a slot, moving back later entries of
+    // the same run which would no longer be found.
+    void
+    vacate (std::size_t slot)
+    {
+        auto const mask = slots_.size() - 1;
+        for (auto next = (slot + 1) & mask;
+            slots_[next] != 0; next = (next + 1) & mask)
+        {
+            auto const h = home(items_[slots_[next] - 1].first);
+            bool const stays = (slot <= next) ?
+                (slot < h && h <= next) : (slot < h || h <= next);
+            if (stays)
+                continue;
+            slots_[slot] = slots_[next];
+            slot = next;
+        }
+        slots_[slot] = 0;
+    }
+
+    void
+    grow()
+    {
+        auto const size = std::max<std::size_t>(
+            minSlots, slots_.size() * 2);
+        shift_ = 64;
+        for (auto n = size; n > 1; n >>= 1)
+            --shift_;
+        slots_.assign(size, 0);
+        for (std::size_t i = 0; i < items_.size(); ++i)
+            slots_[lookup(items_[i].first)] =
+                static_cast<std::uint32_t>(i + 1);
+    }
+
+    std::vector<std::uint32_t> const&
+    order() const
+    {
+        if (! sorted_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (! sorted_.load(std::memory_order_relaxed))
+            {
+                auto const less =
+                    [this](std::uint32_t a, std::uint32_t b)
+                    {
+                        return items_[a].first < items_[b].first;
+                    };
+                // Added items are at the end of items_
+                auto const n = merge_ ? order_.size() : 0;
+                order_.resize(items_.size());
+                std::iota(order_.begin() + n, order_.end(),
+                    static_cast<std::uint32_t>(n));
+                std::sort(order_.begin() + n, order_.end(), less);
+                std::inplace_merge(order_.begin(),
+                    order_.begin() + n, order_.end(), less);
+                merge_ = true;
+                sorted_.store(true, std::memory_order_release);
+            }
+        }
+        return order_;
+    }
+};
+
+} // detail
+} // ripple
+
+#endif
@@ -22,7 +22,7 @@
 
 #include <ripple/ledger/RawView.h>
 #include <ripple/ledger/ReadView.h>
-#include <map>
+#include <ripple/ledger/detail/ItemTable.h>
 #include <utility>
 
 namespace ripple {
@@ -93,7 +93,7 @@ private:
 
     class sles_iter_impl;
 
-    using items_t = std::map<key_type,
+    using items_t = ItemTable<
         std::pair<Action, std::shared_ptr<SLE>>>;
 
     items_t items_;
@@ -21,6 +21,7 @@
 #include <ripple/ledger/detail/ApplyStateTable.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/st.h>
 #include <cassert>
@@ -28,14 +29,35 @@
 namespace ripple {
 namespace detail {
 
+// Returns the entry, or a copy on the heap if it may have come from
+// the arena current on this thread. An entry left in an OpenView can
+// outlive the transaction by a long time, and would keep all of the
+// arena's blocks alive.
+static
+std::shared_ptr<SLE>
+heapCopy (std::shared_ptr<SLE> const& sle)
+{
+    if (! sle || ! ScopedArena::get())
+        return sle;
+    return std::make_shared<SLE>(*sle);
+}
+
 void
 ApplyStateTable::apply (RawView& to) const
+{
+    apply(to, false);
+}
+
+// Entries applied to another table in the same scope
+// are left where they are, since that table dies first.
+void
+ApplyStateTable::apply (RawView& to, bool toHeap) const
 {
     to.rawDestroyXRP(dropsDestroyed_);
     for (auto const& item : items_)
     {
-        auto const& sle =
-            item.second.second;
+        auto const& sle = toHeap ?
+            heapCopy(item.second.second) : item.second.second;
         switch(item.second.first)
         {
         case Action::cache:
@@ -57,7 +79,7 @@ std::size_t
 ApplyStateTable::size ()
 {
     std::size_t ret = 0;
-    for (auto& item : items_)
+    for (auto const& item : items_.unordered())
     {
         switch (item.second.first)
         {
@@ -80,7 +102,7 @@ ApplyStateTable::visit (ReadView const& to,
         std::shared_ptr <SLE const> const& before,
         std::shared_ptr <SLE const> const& after)> const& func)
 {
-    for (auto& item : items_)
+    for (auto const& item : items_)
     {
         switch (item.second.first)
         {
@@ -124,7 +146,7 @@ ApplyStateTable::apply (OpenView& to,
         if (deliver)
             meta.setDeliveredAmount(*deliver);
         Mods newMod;
-        for (auto& item : items_)
+        for (auto const& item : items_)
         {
             SField const* type;
             switch (item.second.first)
@@ -240,7 +262,7 @@ ApplyStateTable::apply (OpenView& to,
 
         // add any new modified nodes to the modification set
         for (auto& mod : newMod)
-            to.rawReplace (mod.second);
+            to.rawReplace (heapCopy (mod.second));
 
         sMeta = std::make_shared<Serializer>();
         meta.addRaw (*sMeta, ter, to.txCount());
@@ -253,7 +275,7 @@ ApplyStateTable::apply (OpenView& to,
     to.rawTxInsert(
         tx.getTransactionID(),
             sTx, sMeta);
-    apply(to);
+    apply(to, true);
 }
 
 //---
@@ -263,7 +285,7 @@ ApplyStateTable::exists (ReadView const& base,
     Keylet const& k) const
 {
     auto const iter = items_.find(k.key);
-    if (iter == items_.end())
+    if (! iter)
         return base.exists(k);
     auto const& item = iter->second;
     auto const& sle = item.second;
@@ -288,7 +310,7 @@ ApplyStateTable::succ (ReadView const& base,
             boost::optional<key_type>
 {
     boost::optional<key_type> next = key;
-    items_t::const_iterator iter;
+    items_t::value_type const* found = nullptr;
     // Find base successor that is
     // not also deleted in our list
     do
@@ -296,12 +318,12 @@ ApplyStateTable::succ (ReadView const& base,
         next = base.succ(*next, last);
         if (! next)
             break;
-        iter = items_.find(*next);
+        found = items_.find(*next);
     }
-    while (iter != items_.end() &&
-        iter->second.first == Action::erase);
+    while (found &&
+        found->second.first == Action::erase);
     // Find non-deleted successor in our list
-    for (iter = items_.upper_bound(key);
+    for (auto iter = items_.upper_bound(key);
         iter != items_.end (); ++iter)
     {
         if (iter->second.first != Action::erase)
@@ -324,7 +346,7 @@ ApplyStateTable::read (ReadView const& base,
     Keylet const& k) const
 {
     auto const iter = items_.find(k.key);
-    if (iter == items_.end())
+    if (! iter)
         return base.read(k);
     auto const& item = iter->second;
     auto const& sle = item.second;
@@ -346,21 +368,15 @@ std::shared_ptr<SLE>
 ApplyStateTable::peek (ReadView const& base,
     Keylet const& k)
 {
-    auto iter = items_.lower_bound(k.key);
-    if (iter == items_.end() ||
-        iter->first != k.key)
+    auto const iter = items_.find(k.key);
+    if (! iter)
     {
         auto const sle = base.read(k);
         if (! sle)
             return nullptr;
         // Make our own copy
-        using namespace std;
-        iter = items_.emplace_hint (iter,
-            piecewise_construct,
-                forward_as_tuple(sle->key()),
-                    forward_as_tuple(Action::cache,
-                        make_shared<SLE>(*sle)));
-        return iter->second.second;
+        return items_.emplace(sle->key(), Action::cache,
+            make_shared_scoped<SLE>(*sle)).first->second.second;
     }
     auto const& item = iter->second;
     auto const& sle = item.second;
@@ -385,7 +401,7 @@ ApplyStateTable::erase(
 {
     auto const iter =
         items_.find(sle->key());
-    if (iter == items_.end())
+    if (! iter)
         LogicError("ApplyStateTable::erase: missing key");
     auto& item = iter->second;
     if (item.second != sle)
@@ -409,11 +425,8 @@ void
 ApplyStateTable::rawErase (ReadView const& base,
     std::shared_ptr<SLE> const& sle)
 {
-    using namespace std;
     auto const result = items_.emplace(
-        piecewise_construct,
-            forward_as_tuple(sle->key()),
-                forward_as_tuple(Action::erase, sle));
+        sle->key(), Action::erase, sle);
     if (result.second)
         return;
     auto& item = result.first->second;
@@ -438,15 +451,10 @@ ApplyStateTable::insert (ReadView const& base,
     std::shared_ptr<SLE> const& sle)
 {
     auto const iter =
-        items_.lower_bound(sle->key());
-    if (iter == items_.end() ||
-        iter->first != sle->key())
+        items_.find(sle->key());
+    if (! iter)
     {
-        using namespace std;
-        items_.emplace_hint(iter,
-            piecewise_construct,
-                forward_as_tuple(sle->key()),
-                    forward_as_tuple(Action::insert, sle));
+        items_.emplace(sle->key(), Action::insert, sle);
         return;
     }
     auto& item = iter->second;
@@ -470,14 +478,10 @@ ApplyStateTable::replace (ReadView const& base,
     std::shared_ptr<SLE> const& sle)
 {
     auto const iter =
-        items_.lower_bound(sle->key());
-    if (iter == items_.end() ||
-        iter->first != sle->key())
+        items_.find(sle->key());
+    if (! iter)
     {
-        using namespace std;
-        items_.emplace_hint(iter, piecewise_construct,
-            forward_as_tuple(sle->key()),
-                forward_as_tuple(Action::modify, sle));
+        items_.emplace(sle->key(), Action::modify, sle);
         return;
     }
     auto& item = iter->second;
@@ -501,7 +505,7 @@ ApplyStateTable::update (ReadView const& base,
 {
     auto const iter =
         items_.find(sle->key());
-    if (iter == items_.end())
+    if (! iter)
         LogicError("ApplyStateTable::update: missing key");
     auto& item = iter->second;
     if (item.second != sle)
@@ -557,8 +561,8 @@ ApplyStateTable::getForMod (ReadView const& base,
         }
     }
     {
-        auto iter = items_.find (key);
-        if (iter != items_.end ())
+        auto const iter = items_.find (key);
+        if (iter)
         {
             auto const& item = iter->second;
             if (item.first == Action::erase)
@@ -585,7 +589,7 @@ ApplyStateTable::getForMod (ReadView const& base,
             "ApplyStateTable::getForMod: key not found";
         return nullptr;
     }
-    auto sle = std::make_shared<SLE> (*c);
+    auto sle = make_shared_scoped<SLE> (*c);
     mods.emplace(key, sle);
     return sle;
 }
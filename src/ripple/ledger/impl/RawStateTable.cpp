@@ -182,7 +182,7 @@ RawStateTable::exists (ReadView const& base,
 {
     assert(k.key.isNonZero());
     auto const iter = items_.find(k.key);
-    if (iter == items_.end())
+    if (! iter)
         return base.exists(k);
     auto const& item = iter->second;
     if (item.first == Action::erase)
@@ -203,7 +203,7 @@ RawStateTable::succ (ReadView const& base,
             boost::optional<key_type>
 {
     boost::optional<key_type> next = key;
-    items_t::const_iterator iter;
+    items_t::value_type const* found = nullptr;
     // Find base successor that is
     // not also deleted in our list
     do
@@ -211,12 +211,12 @@ RawStateTable::succ (ReadView const& base,
         next = base.succ(*next, last);
         if (! next)
             break;
-        iter = items_.find(*next);
+        found = items_.find(*next);
     }
-    while (iter != items_.end() &&
-        iter->second.first == Action::erase);
+    while (found &&
+        found->second.first == Action::erase);
     // Find non-deleted successor in our list
-    for (iter = items_.upper_bound(key);
+    for (auto iter = items_.upper_bound(key);
         iter != items_.end (); ++iter)
     {
         if (iter->second.first != Action::erase)
@@ -240,10 +240,7 @@ RawStateTable::erase(
 {
     // The base invariant is checked during apply
     auto const result = items_.emplace(
-        std::piecewise_construct,
-            std::forward_as_tuple(sle->key()),
-                std::forward_as_tuple(
-                    Action::erase, sle));
+        sle->key(), Action::erase, sle);
     if (result.second)
         return;
     auto& item = result.first->second;
@@ -267,10 +264,7 @@ RawStateTable::insert(
     std::shared_ptr<SLE> const& sle)
 {
     auto const result = items_.emplace(
-        std::piecewise_construct,
-            std::forward_as_tuple(sle->key()),
-                std::forward_as_tuple(
-                    Action::insert, sle));
+        sle->key(), Action::insert, sle);
     if (result.second)
         return;
     auto& item = result.first->second;
@@ -294,10 +288,7 @@ RawStateTable::replace(
     std::shared_ptr<SLE> const& sle)
 {
     auto const result = items_.emplace(
-        std::piecewise_construct,
-            std::forward_as_tuple(sle->key()),
-                std::forward_as_tuple(
-                    Action::replace, sle));
+        sle->key(), Action::replace, sle);
     if (result.second)
         return;
     auto& item = result.first->second;
@@ -319,7 +310,7 @@ RawStateTable::read (ReadView const& base,
 {
     auto const iter =
         items_.find(k.key);
-    if (iter == items_.end())
+    if (! iter)
         return base.read(k);
     auto const& item = iter->second;
     if (item.first == Action::erase)
@@ -109,15 +109,11 @@ Rules::changed (DigestAwareReadView const& ledger) const
 bool
 Rules::operator== (Rules const& other) const
 {
-#if 0
-    if (! impl_ && ! other.impl_)
+    if (impl_.get() == other.impl_.get())
         return true;
     if (! impl_ || ! other.impl_)
         return false;
     return *impl_ == *other.impl_;
-#else
-    return impl_.get() == other.impl_.get();
-#endif
 }
 
 //------------------------------------------------------------------------------
@@ -22,6 +22,7 @@
 #include <ripple/ledger/View.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/ScopedArena.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/Quality.h>
@@ -691,7 +692,7 @@ dirAdd (ApplyView& view,
     if (! sleRoot)
     {
         // No root, make it.
-        sleRoot = std::make_shared<SLE>(k);
+        sleRoot = make_shared_scoped<SLE>(k);
         sleRoot->setFieldH256 (sfRootIndex, uRootIndex);
         view.insert (sleRoot);
         fDescriber (sleRoot, true);
@@ -738,7 +739,7 @@ dirAdd (ApplyView& view,
             view.update (sleRoot);
 
             // Create the new node.
-            sleNode = std::make_shared<SLE>(
+            sleNode = make_shared_scoped<SLE>(
                 keylet::page(uRootIndex, uNodeDir));
             sleNode->setFieldH256 (sfRootIndex, uRootIndex);
             view.insert (sleNode);
@@ -977,7 +978,7 @@ trustCreate (ApplyView& view,
     auto const& uLowAccountID   = !bSrcHigh ? uSrcAccountID : uDstAccountID;
     auto const& uHighAccountID  =  bSrcHigh ? uSrcAccountID : uDstAccountID;
 
-    auto const sleRippleState = std::make_shared<SLE>(
+    auto const sleRippleState = make_shared_scoped<SLE>(
         ltRIPPLE_STATE, uIndex);
     view.insert (sleRippleState);
 
@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/ledger/detail/ItemTable.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class ItemTable_test : public beast::unit_test::suite
+{
+public:
+    using Table = detail::ItemTable<int>;
+
+    static
+    uint256
+    makeKey (std::uint64_t prefix, std::uint64_t suffix)
+    {
+        uint256 key;
+        key.zero();
+        std::memcpy(key.data(), &prefix, sizeof(prefix));
+        std::memcpy(key.data() + uint256::bytes - sizeof(suffix),
+            &suffix, sizeof(suffix));
+        return key;
+    }
+
+    // Compare the table with a map holding the same items
+    bool
+    same (Table const& table, std::map<uint256, int> const& map)
+    {
+        if (table.size() != map.size())
+            return false;
+        auto iter = map.begin();
+        for (auto const& item : table)
+        {
+            if (item.first != iter->first ||
+                    item.second != iter->second)
+                return false;
+            auto const found = table.find(item.first);
+            if (! found || found->second != item.second)
+                return false;
+            ++iter;
+        }
+        return true;
+    }
+
+    void
+    testBasics()
+    {
+        testcase ("basics");
+
+        Table t;
+        expect (t.empty());
+        expect (t.begin() == t.end());
+        expect (! t.find(makeKey(1, 1)));
+
+        auto result = t.emplace(makeKey(2, 0), 20);
+        expect (result.second);
+        expect (result.first->second == 20);
+        result = t.emplace(makeKey(1, 0), 10);
+        expect (result.second);
+        result = t.emplace(makeKey(2, 0), 30);
+        expect (! result.second, "Should not replace");
+        expect (result.first->second == 20);
+        expect (t.size() == 2);
+
+        // Ordered by key
+        expect (t.begin()->second == 10);
+        expect (t.upper_bound(makeKey(1, 0))->second == 20);
+        expect (t.upper_bound(makeKey(2, 0)) == t.end());
+
+        t.erase(t.find(makeKey(1, 0)));
+        expect (t.size() == 1);
+        expect (! t.find(makeKey(1, 0)));
+        expect (t.begin()->second == 20);
+
+        Table copy (t);
+        t.erase(t.find(makeKey(2, 0)));
+        expect (t.empty());
+        expect (copy.size() == 1);
+        expect (copy.find(makeKey(2, 0))->second == 20);
+
+        Table moved (std::move(copy));
+        expect (moved.size() == 1);
+        expect (copy.empty());
+        expect (copy.begin() == copy.end());
+    }
+
+    void
+    testRandom()
+    {
+        testcase ("random");
+
+        beast::xor_shift_engine gen (42);
+        Table t;
+        std::map<uint256, int> m;
+
+        // Keys which share their leading bytes, like the
+        // directories of one order book, land in few buckets
+        // of a poor hash.
+        auto const key = [&]()
+        {
+            return makeKey(gen() % 4, gen() % 3000);
+        };
+
+        bool ok = true;
+        for (int i = 0; i < 100000; ++i)
+        {
+            auto const k = key();
+            switch (gen() % 3)
+            {
+            case 0:
+            case 1:
+            {
+                auto const value = static_cast<int>(gen() % 1000);
+                auto const r1 = t.emplace(k, value);
+                auto const r2 = m.emplace(k, value);
+                ok = ok && r1.second == r2.second &&
+                    r1.first->second == r2.first->second;
+                break;
+            }
+            case 2:
+            {
+                auto const found = t.find(k);
+                auto const iter = m.find(k);
+                ok = ok && (found == nullptr) == (iter == m.end());
+                if (found)
+                {
+                    t.erase(found);
+                    m.erase(iter);
+                }
+                break;
+            }
+            }
+
+            if (i % 997 == 0)
+            {
+                ok = ok && same(t, m);
+                auto const k2 = key();
+                auto const iter = t.upper_bound(k2);
+                auto const expected = m.upper_bound(k2);
+                ok = ok && ((iter == t.end()) ?
+                    (expected == m.end()) :
+                        (iter->first == expected->first));
+            }
+        }
+        expect (ok, "Table and map differ");
+        expect (same(t, m), "Table and map differ");
+    }
+
+    void
+    run() override
+    {
+        testBasics();
+        testRandom();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ItemTable,ledger,ripple);
+
+} // test
+} // ripple
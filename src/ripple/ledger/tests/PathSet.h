@@ -17,6 +17,9 @@
 */
 //==============================================================================
 
+#ifndef RIPPLE_LEDGER_TESTS_PATHSET_H_INCLUDED
+#define RIPPLE_LEDGER_TESTS_PATHSET_H_INCLUDED
+
 #include <BeastConfig.h>
 #include <ripple/app/tx/impl/BookTip.h>
 #include <ripple/basics/Log.h>
@@ -158,3 +161,5 @@ private:
 
 } // test
 } // ripple
+
+#endif
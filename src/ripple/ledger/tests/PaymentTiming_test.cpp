@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/ledger/tests/PathSet.h>
+#include <ripple/test/jtx.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+// Measures how long applying payments takes.
+//
+// "xrp" payments touch two accounts. "book" payments buy USD with
+// XRP across many small offers, so the payment engine stacks a
+// sandbox for each strand and offer and reads through every layer.
+// "offer" creates offers which cross the same offers, making and
+// throwing away many ledger entries.
+class PaymentTiming_test : public beast::unit_test::suite
+{
+public:
+#ifndef NDEBUG
+    int const payers = 50;
+    int const rounds = 5;
+#else
+    int const payers = 200; // release
+    int const rounds = 20;
+#endif
+
+    // Offers crossed by each payment or offer
+    int const depth = 10;
+
+    using clock_type = std::chrono::steady_clock;
+    using Txs = std::vector<std::shared_ptr<STTx const>>;
+
+    // Returns the average time to apply a transaction
+    clock_type::duration
+    timeApply (jtx::Env& env, Txs const& txs)
+    {
+        auto const& rules = env.open()->rules();
+        for (auto const& tx : txs)
+            expect (preflight (rules, *tx, tapNONE,
+                directSigVerify, env.config, env.journal) ==
+                    tesSUCCESS, "preflight failed");
+
+        clock_type::duration elapsed {};
+        for (int i = 0; i < rounds; ++i)
+        {
+            // Each round starts from the same ledger
+            OpenView view (&*env.open());
+            std::size_t failed = 0;
+            auto const start = clock_type::now();
+            for (auto const& tx : txs)
+                if (doapply (view, *tx, tapNONE,
+                        env.config, env.journal).first != tesSUCCESS)
+                    ++failed;
+            elapsed += clock_type::now() - start;
+            expect (failed == 0, "transaction failed");
+        }
+        return elapsed / (rounds * txs.size());
+    }
+
+    void
+    run() override
+    {
+        using namespace jtx;
+        Env env (*this);
+        Account const gw ("gw");
+        Account const maker ("maker");
+        Account const bob ("bob");
+        auto const USD = gw["USD"];
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < payers; ++i)
+            accounts.emplace_back ("payer" + std::to_string(i));
+
+        env.fund (XRP(100000), gw, maker, bob);
+        for (auto const& a : accounts)
+            env.fund (XRP(10000), a);
+        env.trust (USD(1000000), maker, bob);
+        env (pay (gw, maker, USD(1000000)));
+        env.close();
+
+        // Enough one dollar offers at rising prices for
+        // every payer to cross its share of them
+        for (int i = 0; i < payers * depth; ++i)
+            env (offer (maker, XRP(10 + i % 50), USD(1)));
+        env.close();
+
+        Txs xrp;
+        Txs book;
+        Txs offers;
+        PathSet const paths {Path (USD)};
+        for (auto const& a : accounts)
+        {
+            xrp.push_back (env.jt (pay (a, bob, XRP(10))).stx);
+            book.push_back (env.jt (pay (a, bob, USD(depth)),
+                json (paths.json()), sendmax (XRP(1000)),
+                    txflags (tfNoRippleDirect)).stx);
+            offers.push_back (env.jt (offer (a,
+                USD(depth), XRP(1000))).stx);
+        }
+
+        for (auto const& v : { std::make_pair ("xrp", &xrp),
+                std::make_pair ("book", &book),
+                    std::make_pair ("offer", &offers) })
+        {
+            auto const us = std::chrono::duration_cast<
+                std::chrono::microseconds>(
+                    timeApply (env, *v.second)).count();
+            std::stringstream ss;
+            ss << std::left << std::setw(10) << v.first <<
+                std::setw(10) << (std::to_string(us) + "us") <<
+                    (us ? 1000000 / us : 0) << " per second";
+            log << ss.str();
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(PaymentTiming,ledger,ripple);
+
+} // test
+} // ripple
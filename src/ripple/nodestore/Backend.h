@@ -65,6 +65,28 @@ public:
     */
     virtual Status fetch (void const* key, std::shared_ptr<NodeObject>* pObject) = 0;
 
+    /** Fetch a single object without creating a NodeObject.
+        Backends which decode into a buffer of their own override this to
+        hand the buffer to the callback, saving a copy of the payload.
+        @note This will be called concurrently.
+        @param key A pointer to the key data.
+        @param f Called with the payload if the status is `ok`.
+        @return The result of the operation.
+    */
+    virtual
+    Status
+    fetchPayload (void const* key, FetchCallback const& f)
+    {
+        std::shared_ptr<NodeObject> object;
+        Status const status = fetch (key, &object);
+        if (status == ok && object)
+        {
+            auto const& data = object->getData ();
+            f (object->getType (), data.data (), data.size ());
+        }
+        return status;
+    }
+
     /** Return `true` if batch fetches are optimized. */
     virtual
     bool
@@ -84,8 +106,8 @@ public:
     virtual void store (std::shared_ptr<NodeObject> const& object) = 0;
 
     /** Store a group of objects.
-        @note This function will not be called concurrently with
-              itself or @ref store.
+        @note This may be called concurrently with itself or @ref store,
+              for example by an import while the server is running.
     */
     virtual void storeBatch (Batch const& batch) = 0;
 
@@ -97,9 +119,36 @@ public:
     */
     virtual void for_each (std::function <void (std::shared_ptr<NodeObject>)> f) = 0;
 
+    /** Return `true` if the objects in a range of keys can be visited. */
+    virtual
+    bool
+    canVisitRange() = 0;
+
+    /** Visit the objects whose keys are in a range.
+        Keys are ordered as unsigned big-endian numbers.
+        @note This will be called concurrently, and while the backend is
+              being written to. Objects stored during the visit may or
+              may not be seen.
+        @param first The lowest key to visit.
+        @param last The highest key to visit.
+        @param f Called with each object. Returning `false` ends the visit.
+    */
+    virtual
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) = 0;
+
     /** Estimate the number of write operations pending. */
     virtual int getWriteLoad () = 0;
 
+    /** Return the counts of the backend's key filter, if it has one. */
+    virtual
+    FilterCounts
+    getFilterCounts()
+    {
+        return FilterCounts();
+    }
+
     /** Remove contents on disk upon destruction. */
     virtual void setDeletePath() = 0;
 
@@ -71,11 +71,25 @@ public:
     */
     virtual std::shared_ptr<NodeObject> fetch (uint256 const& hash) = 0;
 
+    /** Fetch the payload of an object without creating a NodeObject.
+        A cached object is passed from the cache. Otherwise the backend's
+        buffer is passed to the callback and nothing is cached, which
+        suits callers that parse the payload into a cache of their own.
+
+        @note This can be called concurrently.
+        @param hash The key of the object to retrieve.
+        @param f Called with the payload if the object is found. The data
+                 is only valid for the duration of the call.
+        @return `true` if the object was found.
+    */
+    virtual bool fetchPayload (uint256 const& hash, FetchCallback const& f) = 0;
+
     /** Fetch an object without waiting.
         If I/O is required to determine whether or not the object is present,
         `false` is returned. Otherwise, `true` is returned and `object` is set
         to refer to the object, or `nullptr` if the object is not present.
-        If I/O is required, the I/O is scheduled.
+        If I/O is required, the I/O is scheduled at the priority of the
+        calling thread's ScopedReadPriority.
 
         @note This can be called concurrently.
         @param hash The key of the object to retrieve
@@ -88,6 +102,19 @@ public:
     */
     virtual void waitReads () = 0;
 
+    /** Fetch a group of objects.
+        Objects which are not cached are read from the backend together,
+        as a single batch when the backend supports it, so that the
+        backend can service the reads in parallel.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects to retrieve.
+        @return The objects in the same order as `hashes`, with nullptr
+                for each object that couldn't be retrieved.
+    */
+    virtual std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::vector<uint256> const& hashes) = 0;
+
     /** Get the maximum number of async reads the node store prefers.
         @return The number of async reads preferred.
     */
@@ -118,7 +145,27 @@ public:
     */
     virtual void for_each(std::function <void(std::shared_ptr<NodeObject>)> f) = 0;
 
-    /** Import objects from another database. */
+    /** Return `true` if the objects in a range of keys can be visited. */
+    virtual bool canVisitRange () = 0;
+
+    /** Visit the objects whose keys are in a range.
+        This may be called concurrently, and while the database is in use.
+
+        @see Backend::for_each
+    */
+    virtual void for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) = 0;
+
+    /** Store a batch of objects directly in the backend.
+        The objects are not added to the cache. This is used by import,
+        and may be called concurrently, and while the database is in use.
+    */
+    virtual void storeBatch (Batch const& batch) = 0;
+
+    /** Import objects from another database.
+
+        @see Importer
+    */
     virtual void import (Database& source) = 0;
 
     /** Retrieve the estimated number of pending write operations.
@@ -147,6 +194,9 @@ public:
     virtual std::uint32_t getFetchHitCount () const = 0;
     virtual std::uint32_t getStoreSize () const = 0;
     virtual std::uint32_t getFetchSize () const = 0;
+
+    /** Return the counts of the key filters of the backends. */
+    virtual FilterCounts getFilterCounts () const = 0;
 };
 
 }
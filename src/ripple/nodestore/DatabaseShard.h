@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DATABASESHARD_H_INCLUDED
+#define RIPPLE_NODESTORE_DATABASESHARD_H_INCLUDED
+
+#include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/Types.h>
+#include <cstdint>
+#include <string>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A store of history split into shards of consecutive ledgers.
+
+    Each shard holds the objects of a fixed range of ledgers in its own
+    backend, so history can be spread over disks and each shard built,
+    verified and removed on its own. Since every shard must be able to
+    stand alone, an object used by ledgers in two shards is stored in
+    both.
+
+    A shard is complete once every one of its ledgers has been stored.
+    It is then verified and never written again. Complete shards may be
+    compacted into the read only Mapped backend.
+*/
+class DatabaseShard
+{
+public:
+    virtual ~DatabaseShard() = default;
+
+    /** Close every shard.
+        This allows the caller to catch exceptions.
+    */
+    virtual void close () = 0;
+
+    /** Returns the number of ledgers in each shard. */
+    virtual std::uint32_t ledgersPerShard () const = 0;
+
+    /** Returns the index of the shard which holds a ledger. */
+    virtual std::uint32_t seqToShardIndex (std::uint32_t seq) const = 0;
+
+    /** Fetch an object of a ledger.
+        Only the shard which holds the ledger is searched.
+
+        @note This can be called concurrently.
+        @return The object, or nullptr if it isn't in the shard.
+    */
+    virtual std::shared_ptr<NodeObject> fetch (uint256 const& hash,
+        std::uint32_t seq) = 0;
+
+    /** Fetch an object from any shard, the newest first.
+
+        @note This can be called concurrently.
+    */
+    virtual std::shared_ptr<NodeObject> fetch (uint256 const& hash) = 0;
+
+    /** Store an object of a ledger in its shard.
+        Objects for a complete shard are ignored.
+    */
+    virtual void store (NodeObjectType type, Blob&& data,
+        uint256 const& hash, std::uint32_t seq) = 0;
+
+    /** Record that every object of a ledger has been stored.
+        When this completes a shard, the shard is verified and
+        compacted before this returns.
+    */
+    virtual void setStored (std::uint32_t seq) = 0;
+
+    /** Returns `true` if every object of the ledger is stored. */
+    virtual bool hasLedger (std::uint32_t seq) = 0;
+
+    /** Returns the indexes of the complete shards, such as "0-3,7". */
+    virtual std::string getCompleteShards () = 0;
+
+    /** Verify the backends of the complete shards.
+        An exception is thrown for the first problem found.
+    */
+    virtual void validate () = 0;
+};
+
+}
+}
+
+#endif
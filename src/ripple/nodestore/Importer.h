@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_IMPORTER_H_INCLUDED
+#define RIPPLE_NODESTORE_IMPORTER_H_INCLUDED
+
+#include <ripple/nodestore/Database.h>
+#include <ripple/basics/BasicConfig.h>
+#include <beast/utility/Journal.h>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Copies every object in one database into another.
+
+    The key space is split into ranges which are read by a pool of threads
+    and written to the destination with Database::storeBatch. The
+    destination may be in use while the copy runs.
+
+    When a checkpoint file is given, each finished range is recorded in it,
+    so an import which is stopped or interrupted picks up where it left off.
+    Ranges which were only partly copied are copied again. The file is
+    removed once every range has been copied, so a later import starts
+    over.
+
+    A source which can't visit a range of keys is copied by one thread
+    with Database::for_each, and the copy can't be stopped or resumed.
+*/
+class Importer
+{
+public:
+    struct Setup
+    {
+        /** Number of threads reading the source. */
+        int threads = 4;
+
+        /** Number of key ranges, from 1 to 65536. */
+        int partitions = 256;
+
+        /** File which records the finished ranges, or empty. */
+        std::string checkpoint;
+    };
+
+    Importer (Database& source, Database& dest,
+        Setup const& setup, beast::Journal journal);
+
+    /** Stop and wait for the threads. */
+    ~Importer ();
+
+    Importer (Importer const&) = delete;
+    Importer& operator= (Importer const&) = delete;
+
+    /** Start copying on the pool threads and return. */
+    void
+    start ();
+
+    /** Ask the threads to stop soon.
+        Ranges in progress are left unfinished.
+    */
+    void
+    stop ();
+
+    /** Wait for the threads to finish.
+        @return `true` if every range has been copied.
+    */
+    bool
+    wait ();
+
+    /** Copy everything, returning when done or stopped.
+        @return `true` if every range has been copied.
+    */
+    bool
+    run ()
+    {
+        start ();
+        return wait ();
+    }
+
+    /** Returns the number of objects copied so far. */
+    std::uint64_t
+    objects () const
+    {
+        return objects_;
+    }
+
+    /** Returns the number of ranges which have been copied. */
+    int
+    finished () const;
+
+    /** Returns the inclusive key range of a partition. */
+    static
+    std::pair <uint256, uint256>
+    range (int partition, int partitions);
+
+private:
+    void
+    loadCheckpoint ();
+
+    void
+    removeCheckpoint ();
+
+    void
+    markFinished (int partition);
+
+    void
+    write (Batch& batch);
+
+    void
+    copyAll ();
+
+    void
+    copyRanges ();
+
+    bool
+    copyRange (int partition);
+
+    void
+    onError (std::exception const& e);
+
+    Database& source_;
+    Database& dest_;
+    Setup const setup_;
+    beast::Journal journal_;
+
+    std::mutex mutable mutex_;
+    std::vector <bool> finished_;
+    std::ofstream checkpoint_;
+
+    std::vector <std::thread> threads_;
+    std::atomic <int> next_ {0};
+    std::atomic <bool> stop_ {false};
+    std::atomic <bool> error_ {false};
+    std::atomic <std::uint64_t> objects_ {0};
+};
+
+/** Returns the Importer setup from the [import_db] section. */
+Importer::Setup
+setup_Importer (Section const& section);
+
+}
+}
+
+#endif
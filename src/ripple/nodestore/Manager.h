@@ -22,6 +22,7 @@
 
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/DatabaseRotating.h>
+#include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/basics/BasicConfig.h>
 #include <beast/utility/Journal.h>
 
@@ -96,6 +97,34 @@ public:
             std::shared_ptr <Backend> writableBackend,
                 std::shared_ptr <Backend> archiveBackend,
                     beast::Journal journal) = 0;
+
+    /** Construct a database with a fast tier and a slow tier.
+
+        New objects are stored in generations of the fast backend,
+        which are demoted to the slow backend as they age. Besides the
+        backend's own keys, the fast parameters may set the 'age' of a
+        generation in seconds, and whether to 'promote' objects read
+        from the slow tier.
+    */
+    virtual
+    std::unique_ptr <Database>
+    make_DatabaseTiered (std::string const& name, Scheduler& scheduler,
+        beast::Journal journal, int readThreads,
+            Section const& fastParameters,
+                Section const& slowParameters) = 0;
+
+    /** Construct a store of ledger shards.
+
+        The parameters are those of each shard's backend, with the
+        'path' under which the shards are kept. The optional
+        'ledgers_per_shard' and 'compact' keys are also read.
+
+        @see DatabaseShard
+    */
+    virtual
+    std::unique_ptr <DatabaseShard>
+    make_DatabaseShard (std::string const& name, Scheduler& scheduler,
+        Section const& parameters, beast::Journal journal) = 0;
 };
 
 //------------------------------------------------------------------------------
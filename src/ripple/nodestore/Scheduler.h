@@ -21,6 +21,7 @@
 #define RIPPLE_NODESTORE_SCHEDULER_H_INCLUDED
 
 #include <ripple/nodestore/Task.h>
+#include <ripple/nodestore/Types.h>
 #include <chrono>
 
 namespace ripple {
@@ -33,6 +34,11 @@ struct FetchReport
     bool isAsync;
     bool wentToDisk;
     bool wasFound;
+
+    // The following are only set for reads done by the async read threads
+    ReadPriority priority = readNormal;
+    std::chrono::milliseconds queued {0};   // Time spent waiting in the queue
+    std::size_t queueDepth = 0;             // Reads waiting when this one started
 };
 
 /** Contains information about a batch write operation. */
@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_TRACE_H_INCLUDED
+#define RIPPLE_NODESTORE_TRACE_H_INCLUDED
+
+#include <ripple/nodestore/NodeObject.h>
+#include <ripple/basics/base_uint.h>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** One backend operation in a trace.
+    @see TraceWriter, TraceReader
+*/
+struct TraceRecord
+{
+    enum Op : std::uint8_t
+    {
+        fetch,      // A fetch which found the object
+        miss,       // A fetch which didn't
+        store
+    };
+
+    Op op;
+    NodeObjectType type;
+
+    // The size of the object, or zero for a miss
+    std::uint32_t size;
+
+    uint256 key;
+};
+
+/** Appends the operations made on backends to a trace file.
+
+    The file starts with an 8 byte signature, followed by one fixed size
+    record per operation:
+
+        op (1) | type (1) | size (4, big endian) | key (32)
+
+    Only the sizes of objects are kept, not their contents, so a trace
+    of a busy server stays small and holds nothing private. Records are
+    buffered, and a trace cut short keeps every complete record.
+
+    Once the file reaches a size limit it is renamed with ".1" added,
+    replacing the trace renamed before, and a new trace is started. So
+    about twice the limit is kept on disk. If the file can't be renamed
+    tracing stops.
+
+    Writers are shared by path, so that every backend opened with the
+    same trace file, such as the two databases used by online delete,
+    appends to one trace.
+*/
+class TraceWriter
+{
+public:
+    enum
+    {
+        recordBytes = 38
+    };
+
+    /** Returns the writer for a file, opening it if needed.
+        A file which already holds a trace is appended to.
+        @param limit The size in bytes at which the file is renamed,
+                     or zero for no limit. A shared writer keeps the
+                     limit it was opened with.
+    */
+    static
+    std::shared_ptr <TraceWriter>
+    open (std::string const& path, std::uint64_t limit);
+
+    ~TraceWriter ();
+
+    TraceWriter (TraceWriter const&) = delete;
+    TraceWriter& operator= (TraceWriter const&) = delete;
+
+    void
+    append (TraceRecord::Op op, NodeObjectType type,
+        std::size_t size, void const* key);
+
+    /** Write the buffered records to the file. */
+    void
+    flush ();
+
+private:
+    TraceWriter (std::string const& path, std::uint64_t limit);
+
+    void
+    write ();
+
+    void
+    rotate ();
+
+    std::string const path_;
+    std::uint64_t const limit_;
+    std::mutex mutex_;
+    std::ofstream out_;
+    std::vector <std::uint8_t> buffer_;
+
+    // The size of the file
+    std::uint64_t size_ = 0;
+    bool stopped_ = false;
+};
+
+/** Reads the records of a trace file in order. */
+class TraceReader
+{
+public:
+    /** Open a trace.
+        @throws std::runtime_error if the file isn't a trace.
+    */
+    explicit
+    TraceReader (std::string const& path);
+
+    /** Read the next record.
+        @return `false` at the end of the trace.
+    */
+    bool
+    next (TraceRecord& record);
+
+private:
+    std::ifstream in_;
+};
+
+}
+}
+
+#endif
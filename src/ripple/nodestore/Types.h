@@ -22,6 +22,8 @@
 
 #include <ripple/nodestore/NodeObject.h>
 #include <ripple/basics/BasicConfig.h>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace ripple {
@@ -46,8 +48,59 @@ enum Status
     customCode = 100
 };
 
+/** Priority classes for asynchronous reads.
+    Queued reads are served from the most urgent non-empty class first.
+    @see ScopedReadPriority
+*/
+enum ReadPriority
+{
+    readUrgent,         // Needed for consensus or the current ledger
+    readNormal,
+    readBackground,     // History backfill and cache maintenance
+
+    readPriorities      // The number of priority classes
+};
+
 /** A batch of NodeObjects to write at once. */
 using Batch = std::vector <std::shared_ptr<NodeObject>>;
+
+/** Receives the payload of a fetched object.
+    The data is only valid for the duration of the call.
+*/
+using FetchCallback = std::function <
+    void (NodeObjectType type, void const* data, std::size_t size)>;
+
+/** Counts of fetches screened by the key filters of backends.
+    @see FilteredBackend
+*/
+struct FilterCounts
+{
+    // The number of backends with a filter
+    int filters = 0;
+
+    // The number of filters still being built, which pass every fetch
+    int building = 0;
+
+    // Fetches answered by a filter without reading the backend
+    std::uint64_t skipped = 0;
+
+    // Fetches passed by a filter which found the object
+    std::uint64_t hits = 0;
+
+    // Fetches passed by a filter which did not find the object
+    std::uint64_t falsePositives = 0;
+
+    FilterCounts&
+    operator+= (FilterCounts const& other)
+    {
+        filters += other.filters;
+        building += other.building;
+        skipped += other.skipped;
+        hits += other.hits;
+        falsePositives += other.falsePositives;
+        return *this;
+    }
+};
 }
 }
 
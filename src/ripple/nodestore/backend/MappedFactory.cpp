@@ -0,0 +1,606 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <beast/ByteOrder.h>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+/** An immutable backend which is read through a memory mapping.
+
+    A new database is written once: stored objects are appended to
+    mapped.dat, and when the backend is closed the keys are sorted into
+    mapped.key, which seals the database. A sealed database is read only
+    and both files are mapped, so a fetch is a lookup in the key table
+    and a decode of the value where it lies in the mapping. The pages
+    are shared with other processes mapping the same files.
+
+    This suits a range of history which no longer changes, written by an
+    import. If the server stops before the database is sealed, the
+    objects appended so far are kept and writing resumes on the next open.
+
+    mapped.dat holds one record per object:
+
+        Bytes
+
+        0...31      Key
+        32...35     Size of the value, 32-bit big endian integer
+        36...       The value, as written by EncodedBlob
+
+    mapped.key holds a header, a fanout table and the sorted keys:
+
+        0...7       "RIPLMAP1"
+        8...15      Number of keys, 64-bit big endian integer
+        16...       For each 16-bit key prefix, and one more, the index
+                    of the first key with that prefix or higher, as 64-bit
+                    big endian integers
+        ...         For each key in order, the key and the offset of its
+                    record in mapped.dat as a 64-bit big endian integer
+*/
+class MappedBackend
+    : public Backend
+{
+public:
+    enum
+    {
+        recordHeaderBytes = 36,
+        fanoutSize = 65536 + 1,
+        headerBytes = 16 + 8 * fanoutSize,
+        entryBytes = 40
+    };
+
+    beast::Journal journal_;
+    std::string const name_;
+    boost::filesystem::path const datPath_;
+    boost::filesystem::path const keyPath_;
+    bool deletePath_;
+    bool open_;
+
+    // While the database is being written
+    std::mutex mutex_;
+    std::fstream dat_;
+    std::uint64_t datSize_;
+    std::map <uint256, std::uint64_t> index_;
+
+    // Once it is sealed
+    bool sealed_;
+    boost::interprocess::mapped_region datRegion_;
+    boost::interprocess::mapped_region keyRegion_;
+    std::uint8_t const* datBegin_;
+    std::uint64_t datBytes_;
+    std::uint8_t const* keyBegin_;
+    std::uint64_t count_;
+
+    MappedBackend (int keyBytes, Section const& keyValues,
+        Scheduler&, beast::Journal journal)
+        : journal_ (journal)
+        , name_ (get<std::string>(keyValues, "path"))
+        , datPath_ (boost::filesystem::path (name_) / "mapped.dat")
+        , keyPath_ (boost::filesystem::path (name_) / "mapped.key")
+        , deletePath_ (false)
+        , open_ (true)
+        , datSize_ (0)
+        , sealed_ (false)
+        , datBegin_ (nullptr)
+        , datBytes_ (0)
+        , keyBegin_ (nullptr)
+        , count_ (0)
+    {
+        if (name_.empty())
+            throw std::runtime_error (
+                "nodestore: Missing path in Mapped backend");
+        if (keyBytes != 32)
+            throw std::runtime_error (
+                "nodestore: Mapped backend requires 32 byte keys");
+        boost::filesystem::create_directories (name_);
+        if (boost::filesystem::exists (keyPath_))
+            openSealed ();
+        else
+            openUnsealed ();
+    }
+
+    ~MappedBackend ()
+    {
+        close();
+    }
+
+    std::string
+    getName()
+    {
+        return name_;
+    }
+
+    void
+    close() override
+    {
+        if (! open_)
+            return;
+        open_ = false;
+
+        if (! sealed_)
+        {
+            dat_.close ();
+            if (! deletePath_ && ! index_.empty ())
+                seal ();
+        }
+
+        datRegion_ = boost::interprocess::mapped_region ();
+        keyRegion_ = boost::interprocess::mapped_region ();
+
+        if (deletePath_)
+            boost::filesystem::remove_all (name_);
+    }
+
+    //--------------------------------------------------------------------------
+
+    Status
+    fetch (void const* key, std::shared_ptr<NodeObject>* pno)
+    {
+        pno->reset();
+
+        if (! sealed_)
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            auto const iter = index_.find (uint256::fromVoid (key));
+            if (iter == index_.end ())
+                return notFound;
+            return readRecord (iter->second, pno);
+        }
+
+        std::uint64_t offset;
+        if (! find (static_cast <std::uint8_t const*> (key), offset))
+            return notFound;
+
+        // The value is decoded where it lies in the mapping
+        auto const p = datBegin_ + offset;
+        DecodedBlob decoded (key, p + recordHeaderBytes,
+            beast::ByteOrder::bigEndianInt (p + 32));
+        if (! decoded.wasOk ())
+            return dataCorrupt;
+        *pno = decoded.createObject ();
+        return ok;
+    }
+
+    Status
+    fetchPayload (void const* key, FetchCallback const& f) override
+    {
+        if (! sealed_)
+            return Backend::fetchPayload (key, f);
+
+        std::uint64_t offset;
+        if (! find (static_cast <std::uint8_t const*> (key), offset))
+            return notFound;
+
+        auto const p = datBegin_ + offset;
+        DecodedBlob decoded (key, p + recordHeaderBytes,
+            beast::ByteOrder::bigEndianInt (p + 32));
+        if (! decoded.wasOk ())
+            return dataCorrupt;
+        f (decoded.getType (), decoded.getData (), decoded.getSize ());
+        return ok;
+    }
+
+    bool
+    canFetchBatch() override
+    {
+        return sealed_;
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::size_t n, void const* const* keys) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (fetch (keys[i], &results[i]) == dataCorrupt)
+            {
+                if (journal_.fatal) journal_.fatal <<
+                    "Corrupt NodeObject #" << uint256::fromVoid (keys[i]);
+            }
+        }
+        return results;
+    }
+
+    void
+    store (std::shared_ptr <NodeObject> const& object) override
+    {
+        if (sealed_)
+            throw std::logic_error (
+                "nodestore: Mapped backend '" + name_ + "' is read only");
+
+        EncodedBlob e;
+        e.prepare (object);
+
+        std::uint8_t size[4];
+        std::uint32_t const n = beast::ByteOrder::swapIfLittleEndian (
+            static_cast <std::uint32_t> (e.getSize ()));
+        std::memcpy (size, &n, sizeof (n));
+
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (index_.count (object->getHash ()) != 0)
+            return;
+        dat_.seekp (datSize_);
+        dat_.write (static_cast <char const*> (e.getKey ()), 32);
+        dat_.write (reinterpret_cast <char const*> (size), sizeof (size));
+        dat_.write (static_cast <char const*> (e.getData ()), e.getSize ());
+        if (! dat_)
+            throw std::runtime_error (
+                "nodestore: can't write '" + datPath_.string () + "'");
+        index_.emplace (object->getHash (), datSize_);
+        datSize_ += recordHeaderBytes + e.getSize ();
+    }
+
+    void
+    storeBatch (Batch const& batch) override
+    {
+        for (auto const& e : batch)
+            store (e);
+    }
+
+    void
+    for_each (std::function <void(std::shared_ptr<NodeObject>)> f)
+    {
+        uint256 first;
+        uint256 last;
+        first.zero ();
+        std::fill (last.begin (), last.end (), 0xff);
+        for_each (first, last,
+            [&f](std::shared_ptr<NodeObject> object)
+            {
+                f (std::move (object));
+                return true;
+            });
+    }
+
+    // Keys are kept in order, whether sealed or not
+    bool
+    canVisitRange() override
+    {
+        return true;
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        if (! sealed_)
+        {
+            std::vector <std::shared_ptr<NodeObject>> objects;
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                for (auto iter = index_.lower_bound (first);
+                    iter != index_.end () && iter->first <= last; ++iter)
+                {
+                    std::shared_ptr<NodeObject> object;
+                    if (readRecord (iter->second, &object) == ok)
+                        objects.push_back (std::move (object));
+                }
+            }
+            for (auto const& object : objects)
+                if (! f (object))
+                    break;
+            return;
+        }
+
+        for (auto i = lowerBound (first.begin ()); i < count_; ++i)
+        {
+            auto const entry = keyBegin_ + headerBytes + i * entryBytes;
+            if (std::memcmp (entry, last.begin (), 32) > 0)
+                break;
+            auto const p = datBegin_ +
+                beast::ByteOrder::bigEndianInt64 (entry + 32);
+            DecodedBlob decoded (entry, p + recordHeaderBytes,
+                beast::ByteOrder::bigEndianInt (p + 32));
+            if (! decoded.wasOk ())
+                throw std::runtime_error ("nodestore: corrupt object in '" +
+                    datPath_.string () + "'");
+            if (! f (decoded.createObject ()))
+                break;
+        }
+    }
+
+    int
+    getWriteLoad ()
+    {
+        return 0;
+    }
+
+    void
+    setDeletePath() override
+    {
+        deletePath_ = true;
+    }
+
+    void
+    verify() override
+    {
+        if (! sealed_)
+            return;
+
+        auto const fail = [this](std::string const& what)
+        {
+            throw std::runtime_error ("nodestore: " + what +
+                " in '" + keyPath_.string () + "'");
+        };
+
+        std::uint64_t prev = 0;
+        for (int i = 0; i < fanoutSize; ++i)
+        {
+            auto const next = fanout (i);
+            if (next < prev || next > count_)
+                fail ("bad fanout");
+            prev = next;
+        }
+        if (prev != count_)
+            fail ("bad fanout");
+
+        for (std::uint64_t i = 0; i < count_; ++i)
+        {
+            auto const entry = keyBegin_ + headerBytes + i * entryBytes;
+            if (i > 0 && std::memcmp (entry - entryBytes, entry, 32) >= 0)
+                fail ("keys out of order");
+            auto const prefix = (entry[0] << 8) | entry[1];
+            if (i < fanout (prefix) || i >= fanout (prefix + 1))
+                fail ("key in the wrong bucket");
+            auto const offset = beast::ByteOrder::bigEndianInt64 (entry + 32);
+            if (offset + recordHeaderBytes > datBytes_ ||
+                    offset + recordHeaderBytes + beast::ByteOrder::bigEndianInt (
+                        datBegin_ + offset + 32) > datBytes_)
+                fail ("record out of bounds");
+            if (std::memcmp (datBegin_ + offset, entry, 32) != 0)
+                fail ("record key mismatch");
+        }
+    }
+
+private:
+    void
+    openSealed ()
+    {
+        using namespace boost::interprocess;
+
+        sealed_ = true;
+
+        file_mapping keyFile (keyPath_.string ().c_str (), read_only);
+        keyRegion_ = mapped_region (keyFile, read_only);
+        keyBegin_ = static_cast <std::uint8_t const*> (
+            keyRegion_.get_address ());
+        if (keyRegion_.get_size () < headerBytes ||
+                std::memcmp (keyBegin_, "RIPLMAP1", 8) != 0)
+            throw std::runtime_error ("nodestore: '" +
+                keyPath_.string () + "' is not a Mapped key file");
+        count_ = beast::ByteOrder::bigEndianInt64 (keyBegin_ + 8);
+        if (keyRegion_.get_size () != headerBytes + count_ * entryBytes)
+            throw std::runtime_error ("nodestore: '" +
+                keyPath_.string () + "' has the wrong size");
+
+        datBytes_ = boost::filesystem::file_size (datPath_);
+        if (datBytes_ > 0)
+        {
+            file_mapping datFile (datPath_.string ().c_str (), read_only);
+            datRegion_ = mapped_region (datFile, read_only);
+
+            // Reads of history are scattered, so read-ahead is wasted
+            datRegion_.advise (mapped_region::advice_random);
+            datBegin_ = static_cast <std::uint8_t const*> (
+                datRegion_.get_address ());
+        }
+
+        if (journal_.debug) journal_.debug <<
+            "Mapped " << count_ << " objects from '" << name_ << "'";
+    }
+
+    // Records from an earlier run are indexed again. A record
+    // cut short when the server stopped is dropped.
+    void
+    openUnsealed ()
+    {
+        std::uint64_t const fileSize = boost::filesystem::exists (datPath_) ?
+            boost::filesystem::file_size (datPath_) : 0;
+        {
+            std::ifstream in (datPath_.string (), std::ios::binary);
+            std::uint8_t header[recordHeaderBytes];
+            while (datSize_ + recordHeaderBytes <= fileSize &&
+                in.read (reinterpret_cast <char*> (header), recordHeaderBytes))
+            {
+                auto const end = datSize_ + recordHeaderBytes +
+                    beast::ByteOrder::bigEndianInt (header + 32);
+                if (end > fileSize)
+                    break;
+                index_.emplace (uint256::fromVoid (header), datSize_);
+                datSize_ = end;
+                in.seekg (datSize_);
+            }
+        }
+        if (fileSize != datSize_)
+            boost::filesystem::resize_file (datPath_, datSize_);
+
+        auto mode = std::ios::in | std::ios::out | std::ios::binary;
+        if (fileSize == 0)
+            mode |= std::ios::trunc;
+        dat_.open (datPath_.string (), mode);
+        if (! dat_.is_open ())
+            throw std::runtime_error (
+                "nodestore: can't open '" + datPath_.string () + "'");
+
+        if (! index_.empty () && journal_.info) journal_.info <<
+            "Resuming '" << name_ << "' with " << index_.size () << " objects";
+    }
+
+    // Called with the lock held
+    Status
+    readRecord (std::uint64_t offset, std::shared_ptr<NodeObject>* pno)
+    {
+        std::uint8_t header[recordHeaderBytes];
+        dat_.seekg (offset);
+        dat_.read (reinterpret_cast <char*> (header), recordHeaderBytes);
+        std::vector <char> value (beast::ByteOrder::bigEndianInt (header + 32));
+        dat_.read (value.data (), value.size ());
+        if (! dat_)
+            throw std::runtime_error (
+                "nodestore: can't read '" + datPath_.string () + "'");
+        DecodedBlob decoded (header, value.data (),
+            static_cast <int> (value.size ()));
+        if (! decoded.wasOk ())
+            return dataCorrupt;
+        *pno = decoded.createObject ();
+        return ok;
+    }
+
+    // The key file is written beside the data and renamed into
+    // place, so a database is either sealed completely or not at all.
+    void
+    seal ()
+    {
+        auto const tmp = keyPath_.string () + ".tmp";
+        {
+            std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+            auto const put = [&out](std::uint64_t v)
+            {
+                v = beast::ByteOrder::swapIfLittleEndian (v);
+                out.write (reinterpret_cast <char const*> (&v), sizeof (v));
+            };
+
+            out.write ("RIPLMAP1", 8);
+            put (index_.size ());
+
+            std::uint64_t i = 0;
+            auto iter = index_.begin ();
+            for (int prefix = 0; prefix < fanoutSize; ++prefix)
+            {
+                while (iter != index_.end () &&
+                    ((iter->first.begin ()[0] << 8) | iter->first.begin ()[1])
+                        < prefix)
+                {
+                    ++iter;
+                    ++i;
+                }
+                put (i);
+            }
+
+            for (auto const& e : index_)
+            {
+                out.write (reinterpret_cast <char const*> (
+                    e.first.begin ()), 32);
+                put (e.second);
+            }
+
+            out.close ();
+            if (! out)
+                throw std::runtime_error (
+                    "nodestore: can't write '" + tmp + "'");
+        }
+        boost::filesystem::rename (tmp, keyPath_);
+
+        if (journal_.info) journal_.info <<
+            "Sealed '" << name_ << "' with " << index_.size () << " objects";
+    }
+
+    std::uint64_t
+    fanout (int prefix) const
+    {
+        return beast::ByteOrder::bigEndianInt64 (
+            keyBegin_ + 16 + 8 * prefix);
+    }
+
+    // Returns the index of the first key not less than the given key
+    std::uint64_t
+    lowerBound (std::uint8_t const* key) const
+    {
+        auto const prefix = (key[0] << 8) | key[1];
+        auto lo = fanout (prefix);
+        auto hi = fanout (prefix + 1);
+        while (lo < hi)
+        {
+            auto const mid = lo + (hi - lo) / 2;
+            if (std::memcmp (keyBegin_ + headerBytes +
+                    mid * entryBytes, key, 32) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    bool
+    find (std::uint8_t const* key, std::uint64_t& offset) const
+    {
+        auto const i = lowerBound (key);
+        if (i >= count_)
+            return false;
+        auto const entry = keyBegin_ + headerBytes + i * entryBytes;
+        if (std::memcmp (entry, key, 32) != 0)
+            return false;
+        offset = beast::ByteOrder::bigEndianInt64 (entry + 32);
+        return true;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class MappedFactory : public Factory
+{
+public:
+    MappedFactory()
+    {
+        Manager::instance().insert(*this);
+    }
+
+    ~MappedFactory()
+    {
+        Manager::instance().erase(*this);
+    }
+
+    std::string
+    getName() const
+    {
+        return "Mapped";
+    }
+
+    std::unique_ptr <Backend>
+    createInstance (
+        size_t keyBytes,
+        Section const& keyValues,
+        Scheduler& scheduler,
+        beast::Journal journal)
+    {
+        return std::make_unique <MappedBackend> (
+            keyBytes, keyValues, scheduler, journal);
+    }
+};
+
+static MappedFactory mappedFactory;
+
+}
+}
@@ -66,6 +66,14 @@ public:
             throw std::runtime_error("already open");
         return db;
     }
+
+    /** Free the objects of a database. */
+    void
+    erase (std::string const& path)
+    {
+        std::lock_guard<std::mutex> _(mutex_);
+        map_.erase (path);
+    }
 };
 
 static MemoryFactory memoryFactory;
@@ -80,6 +88,7 @@ private:
     std::string name_;
     beast::Journal journal_;
     MemoryDB* db_;
+    bool deletePath_ = false;
 
 public:
     MemoryBackend (size_t keyBytes, Section const& keyValues,
@@ -106,6 +115,8 @@ public:
     void
     close() override
     {
+        if (db_ && deletePath_)
+            memoryFactory.erase (name_);
         db_ = nullptr;
     }
 
@@ -162,6 +173,28 @@ public:
             f (e.second);
     }
 
+    bool
+    canVisitRange() override
+    {
+        return true;
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        std::vector <std::shared_ptr<NodeObject>> objects;
+        {
+            std::lock_guard<std::mutex> _(db_->mutex);
+            for (auto iter = db_->table.lower_bound (first);
+                    iter != db_->table.end() && iter->first <= last; ++iter)
+                objects.push_back (iter->second);
+        }
+        for (auto const& object : objects)
+            if (! f (object))
+                break;
+    }
+
     int
     getWriteLoad()
     {
@@ -171,6 +204,7 @@ public:
     void
     setDeletePath() override
     {
+        deletePath_ = true;
     }
 
     void
@@ -58,6 +58,7 @@ public:
     beast::Journal journal_;
     size_t const keyBytes_;
     std::string const name_;
+    nodeobject_codec const codec_;
     api::store db_;
     std::atomic <bool> deletePath_;
     Scheduler& scheduler_;
@@ -67,6 +68,8 @@ public:
         : journal_ (journal)
         , keyBytes_ (keyBytes)
         , name_ (get<std::string>(keyValues, "path"))
+        , codec_ (makeCodec (name_, keyValues))
+        , db_ (codec_)
         , deletePath_(false)
         , scheduler_ (scheduler)
     {
@@ -106,6 +109,29 @@ public:
         close();
     }
 
+    // The dictionary is kept with the database files. It is
+    // loaded whenever it exists, since values written with it
+    // can't be read without it.
+    static
+    nodeobject_codec
+    makeCodec (std::string const& path, Section const& keyValues)
+    {
+        auto compression = nodeobject_compression::lz4;
+        std::string name;
+        if (get_if_exists (keyValues, "compression", name) &&
+                ! parse_compression (name, compression))
+            throw std::runtime_error (
+                "nodestore: Unknown NuDB compression '" + name + "'");
+        if (path.empty())
+            return nodeobject_codec (compression);
+        auto const dict = load_dictionary ((boost::filesystem::path (
+            path) / "nudb.dict").string());
+        if (compression == nodeobject_compression::dictionary && ! dict)
+            throw std::runtime_error (
+                "nodestore: Missing nudb.dict in NuDB backend");
+        return nodeobject_codec (compression, dict);
+    }
+
     std::string
     getName()
     {
@@ -148,17 +174,53 @@ public:
         return status;
     }
 
+    Status
+    fetchPayload (void const* key, FetchCallback const& f) override
+    {
+        Status status;
+        if (! db_.fetch (key,
+            [key, &f, &status](void const* data, std::size_t size)
+            {
+                DecodedBlob decoded (key, data, size);
+                if (! decoded.wasOk ())
+                {
+                    status = dataCorrupt;
+                    return;
+                }
+                f (decoded.getType (), decoded.getData (),
+                    decoded.getSize ());
+                status = ok;
+            }))
+        {
+            return notFound;
+        }
+        return status;
+    }
+
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        throw std::runtime_error("pure virtual called");
-        return {};
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        db_.fetch_batch (n, keys,
+            [this, keys, &results](std::size_t i,
+                void const* data, std::size_t size)
+            {
+                DecodedBlob decoded (keys[i], data, size);
+                if (! decoded.wasOk ())
+                {
+                    if (journal_.fatal) journal_.fatal <<
+                        "Corrupt NodeObject #" << uint256::fromVoid (keys[i]);
+                    return;
+                }
+                results[i] = decoded.createObject();
+            });
+        return results;
     }
 
     void
@@ -218,11 +280,27 @@ public:
                     return false;
                 f (decoded.createObject());
                 return true;
-            });
+            }, codec_);
         db_.open (dp, kp, lp,
             arena_alloc_size);
     }
 
+    // Keys are stored in hash order, so a range
+    // can only be found by reading every value.
+    bool
+    canVisitRange() override
+    {
+        return false;
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        throw std::logic_error (
+            "nodestore: NuDB can't visit a range");
+    }
+
     int
     getWriteLoad ()
     {
@@ -81,6 +81,18 @@ public:
     {
     }
 
+    bool
+    canVisitRange() override
+    {
+        return true;
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+    }
+
     int
     getWriteLoad ()
     {
@@ -335,6 +335,48 @@ public:
         }
     }
 
+    bool
+    canVisitRange() override
+    {
+        return true;
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        rocksdb::ReadOptions options;
+        options.fill_cache = false;
+
+        std::unique_ptr <rocksdb::Iterator> it (m_db->NewIterator (options));
+
+        rocksdb::Slice const end (
+            reinterpret_cast <char const*> (last.data ()), last.size ());
+
+        for (it->Seek (rocksdb::Slice (reinterpret_cast <char const*> (
+                first.data ()), first.size ()));
+            it->Valid () && it->key ().compare (end) <= 0; it->Next ())
+        {
+            if (it->key ().size () != m_keyBytes)
+                continue;
+
+            DecodedBlob decoded (it->key ().data (),
+                                 it->value ().data (),
+                                 it->value ().size ());
+
+            if (! decoded.wasOk ())
+            {
+                if (m_journal.fatal) m_journal.fatal <<
+                    "Corrupt NodeObject #" <<
+                    from_hex_text<uint256>(it->key ().data ());
+                continue;
+            }
+
+            if (! f (decoded.createObject ()))
+                break;
+        }
+    }
+
     int
     getWriteLoad ()
     {
@@ -19,6 +19,8 @@
 
 #include <BeastConfig.h>
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <algorithm>
+#include <iterator>
 
 namespace ripple {
 namespace NodeStore {
@@ -28,8 +30,10 @@ BatchWriter::BatchWriter (Callback& callback, Scheduler& scheduler)
     , m_scheduler (scheduler)
     , mWriteLoad (0)
     , mWritePending (false)
+    , mWriteLimit (minWriteLimit)
 {
     mWriteSet.reserve (batchWritePreallocationSize);
+    mWriting.reserve (batchWritePreallocationSize);
 }
 
 BatchWriter::~BatchWriter ()
@@ -40,16 +44,19 @@ BatchWriter::~BatchWriter ()
 void
 BatchWriter::store (std::shared_ptr<NodeObject> const& object)
 {
-    std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
+    {
+        std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
 
-    mWriteSet.push_back (object);
+        mWriteSet.push_back (object);
 
-    if (! mWritePending)
-    {
-        mWritePending = true;
+        if (mWritePending)
+            return;
 
-        m_scheduler.scheduleTask (*this);
+        mWritePending = true;
     }
+
+    // Outside the lock, since the task may run on this thread
+    m_scheduler.scheduleTask (*this);
 }
 
 int
@@ -57,7 +64,15 @@ BatchWriter::getWriteLoad ()
 {
     std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
 
-    return std::max (mWriteLoad, static_cast<int> (mWriteSet.size ()));
+    return mWriteLoad + static_cast<int> (mWriteSet.size ());
+}
+
+std::size_t
+BatchWriter::getWriteLimit ()
+{
+    std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
+
+    return mWriteLimit;
 }
 
 void
@@ -71,19 +86,16 @@ BatchWriter::writeBatch ()
 {
     for (;;)
     {
-        std::vector< std::shared_ptr<NodeObject> > set;
-
-        set.reserve (batchWritePreallocationSize);
+        bool full;
 
         {
             std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
 
-            mWriteSet.swap (set);
-            assert (mWriteSet.empty ());
-            mWriteLoad = set.size ();
+            assert (mWriting.empty ());
 
-            if (set.empty ())
+            if (mWriteSet.empty ())
             {
+                mWriteLoad = 0;
                 mWritePending = false;
                 mWriteCondition.notify_all ();
 
@@ -91,18 +103,52 @@ BatchWriter::writeBatch ()
                 return;
             }
 
+            full = mWriteSet.size () >= mWriteLimit;
+            if (! full)
+            {
+                // Trade buffers, keeping both allocations
+                mWriteSet.swap (mWriting);
+            }
+            else
+            {
+                // Objects are keyed by their hash, so the order in which
+                // they are written doesn't matter. Take from the back.
+                auto const first = mWriteSet.end () - mWriteLimit;
+                mWriting.assign (std::make_move_iterator (first),
+                    std::make_move_iterator (mWriteSet.end ()));
+                mWriteSet.erase (first, mWriteSet.end ());
+            }
+            mWriteLoad = static_cast<int> (mWriting.size ());
         }
 
         BatchWriteReport report;
-        report.writeCount = set.size();
+        report.writeCount = mWriting.size();
         auto const before = std::chrono::steady_clock::now();
 
-        m_callback.writeBatch (set);
+        m_callback.writeBatch (mWriting);
 
         report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
             (std::chrono::steady_clock::now() - before);
 
         m_scheduler.onBatchWrite (report);
+
+        // Release the objects outside the lock
+        mWriting.clear ();
+
+        {
+            std::lock_guard<decltype(mWriteMutex)> sl (mWriteMutex);
+
+            if (report.elapsed.count () > targetWriteMilliseconds)
+            {
+                mWriteLimit = std::max <std::size_t> (
+                    mWriteLimit / 2, minWriteLimit);
+            }
+            else if (full)
+            {
+                mWriteLimit = std::min <std::size_t> (
+                    mWriteLimit * 2, maxWriteLimit);
+            }
+        }
     }
 }
 
@@ -35,6 +35,16 @@ namespace NodeStore {
     class it not required. A backend can implement its own write batching,
     or skip write batching if doing so yields a performance benefit.
 
+    Objects are stored into one buffer while the scheduled task commits
+    the other, so a store only holds the lock long enough to append and
+    never waits for a write to finish. Objects which arrive during a
+    commit go into the next one.
+
+    The number of objects in a commit adapts to the backend. It halves
+    when a commit takes longer than the target, and doubles when a full
+    commit finishes within it, so a large backlog is written as several
+    commits of bounded duration instead of one.
+
     @see Scheduler
 */
 class BatchWriter : private Task
@@ -65,22 +75,38 @@ public:
     /** Get an estimate of the amount of writing I/O pending. */
     int getWriteLoad ();
 
+    /** Returns the most objects the next commit will take. */
+    std::size_t getWriteLimit ();
+
 private:
+    enum
+    {
+        // Bounds on the number of objects in a commit
+        minWriteLimit = batchWritePreallocationSize,
+        maxWriteLimit = 65536,
+
+        // Commits which take longer than this are made smaller
+        targetWriteMilliseconds = 100
+    };
+
     void performScheduledTask ();
     void writeBatch ();
     void waitForWriting ();
 
 private:
-    using LockType = std::recursive_mutex;
-    using CondvarType = std::condition_variable_any;
-
     Callback& m_callback;
     Scheduler& m_scheduler;
-    LockType mWriteMutex;
-    CondvarType mWriteCondition;
+    std::mutex mWriteMutex;
+    std::condition_variable mWriteCondition;
     int mWriteLoad;
     bool mWritePending;
+    std::size_t mWriteLimit;
+
+    // Filled by store
     Batch mWriteSet;
+
+    // Being committed, only used by the scheduled task
+    Batch mWriting;
 };
 
 }
@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_BLOOMFILTER_H_INCLUDED
+#define RIPPLE_NODESTORE_BLOOMFILTER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A Bloom filter of node object keys.
+
+    A key which was inserted is always reported as possibly present. A
+    key which was not is reported as absent, except for a small fraction
+    of false positives which depends on the bits per key.
+
+    Keys are hashes already, so the bit positions are taken directly from
+    the key bytes. Insertion and lookup may be called concurrently.
+*/
+class BloomFilter
+{
+public:
+    enum
+    {
+        // Bits per key, giving about 1% false positives
+        bitsPerKey = 10,
+
+        // Bit positions per key
+        hashes = 7
+    };
+
+    /** Create an empty filter sized for a number of keys. */
+    explicit
+    BloomFilter (std::uint64_t keys)
+        : words_ (std::max<std::uint64_t> (
+            (keys * bitsPerKey + 63) / 64, 1))
+        , bits_ (new std::atomic<std::uint64_t>[words_])
+    {
+        clear ();
+    }
+
+    BloomFilter (BloomFilter const&) = delete;
+    BloomFilter& operator= (BloomFilter const&) = delete;
+
+    /** Returns the size of the filter in bytes. */
+    std::uint64_t
+    size () const
+    {
+        return words_ * 8;
+    }
+
+    /** Returns the number of keys the filter is sized for. */
+    std::uint64_t
+    capacity () const
+    {
+        return words_ * 64 / bitsPerKey;
+    }
+
+    void
+    clear ()
+    {
+        for (std::uint64_t i = 0; i < words_; ++i)
+            bits_[i].store (0, std::memory_order_relaxed);
+    }
+
+    /** Add a key.
+        @return `false` if the key was already reported as present.
+    */
+    bool
+    insert (uint256 const& key)
+    {
+        std::uint64_t h1;
+        std::uint64_t h2;
+        split (key, h1, h2);
+        bool added = false;
+        for (int i = 0; i < hashes; ++i, h1 += h2)
+        {
+            auto const bit = h1 % (words_ * 64);
+            auto const mask = std::uint64_t (1) << (bit % 64);
+            if ((bits_[bit / 64].fetch_or (mask,
+                    std::memory_order_release) & mask) == 0)
+                added = true;
+        }
+        return added;
+    }
+
+    /** Returns `false` if the key was never inserted. */
+    bool
+    mayContain (uint256 const& key) const
+    {
+        std::uint64_t h1;
+        std::uint64_t h2;
+        split (key, h1, h2);
+        for (int i = 0; i < hashes; ++i, h1 += h2)
+        {
+            auto const bit = h1 % (words_ * 64);
+            if ((bits_[bit / 64].load (std::memory_order_acquire) &
+                    (std::uint64_t (1) << (bit % 64))) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    /** Write the filter to a file.
+        @param keys The number of keys in the filter, which is
+                    returned when the filter is loaded.
+    */
+    bool
+    save (std::string const& path, std::uint64_t keys) const
+    {
+        std::ofstream out (path, std::ios::binary | std::ios::trunc);
+        std::uint64_t const header[] = { magic, words_, keys };
+        out.write (reinterpret_cast<char const*> (header), sizeof (header));
+        for (std::uint64_t i = 0; i < words_ && out; ++i)
+        {
+            std::uint64_t const w = bits_[i].load (std::memory_order_relaxed);
+            out.write (reinterpret_cast<char const*> (&w), sizeof (w));
+        }
+        out.close ();
+        return bool (out);
+    }
+
+    /** Read a filter written by save.
+        The filter has the size it was saved with.
+        @param keys Set to the number of keys passed to save.
+        @return `nullptr` if the file is missing or damaged.
+    */
+    static
+    std::unique_ptr <BloomFilter>
+    load (std::string const& path, std::uint64_t& keys)
+    {
+        std::ifstream in (path, std::ios::binary);
+        std::uint64_t header[3];
+        if (! in.read (reinterpret_cast<char*> (header), sizeof (header)) ||
+                header[0] != magic)
+            return nullptr;
+
+        // Check the length before allocating the bits
+        auto const start = in.tellg ();
+        in.seekg (0, std::ios::end);
+        if (header[1] == 0 || std::uint64_t (in.tellg () - start) !=
+                header[1] * sizeof (std::uint64_t))
+            return nullptr;
+        in.seekg (start);
+
+        std::unique_ptr <BloomFilter> filter (new BloomFilter (
+            header[1] * 64 / bitsPerKey));
+        if (filter->words_ != header[1])
+            return nullptr;
+        for (std::uint64_t i = 0; i < filter->words_; ++i)
+        {
+            std::uint64_t w;
+            if (! in.read (reinterpret_cast<char*> (&w), sizeof (w)))
+                return nullptr;
+            filter->bits_[i].store (w, std::memory_order_relaxed);
+        }
+        keys = header[2];
+        return filter;
+    }
+
+private:
+    enum : std::uint64_t
+    {
+        // Identifies a saved filter, and its format
+        magic = 0x524e53424c4f4f32ULL  // "RNSBLOO2"
+    };
+
+    static
+    void
+    split (uint256 const& key, std::uint64_t& h1, std::uint64_t& h2)
+    {
+        std::memcpy (&h1, key.data (), 8);
+        std::memcpy (&h2, key.data () + 8, 8);
+        // A zero step would test the same bit each time
+        h2 |= 1;
+    }
+
+    std::uint64_t const words_;
+    std::unique_ptr <std::atomic<std::uint64_t>[]> bits_;
+};
+
+}
+}
+
+#endif
@@ -21,6 +21,7 @@
 #define RIPPLE_NODESTORE_DATABASEIMP_H_INCLUDED
 
 #include <ripple/nodestore/Database.h>
+#include <ripple/nodestore/Importer.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/impl/Tuning.h>
 #include <ripple/basics/KeyCache.h>
@@ -28,13 +29,12 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/protocol/digest.h>
 #include <ripple/basics/Slice.h>
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/ShardedTaggedCache.h>
 #include <beast/threads/Thread.h>
 #include <ripple/nodestore/ScopedMetrics.h>
+#include <ripple/nodestore/ScopedReadPriority.h>
+#include <ripple/nodestore/impl/ReadScheduler.h>
 #include <chrono>
-#include <condition_variable>
-#include <set>
-#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -49,19 +49,13 @@ private:
     std::unique_ptr <Backend> m_backend;
 protected:
     // Positive cache
-    TaggedCache <uint256, NodeObject> m_cache;
+    ShardedTaggedCache <uint256, NodeObject> m_cache;
 
     // Negative cache
     KeyCache <uint256> m_negCache;
 private:
-    std::mutex                m_readLock;
-    std::condition_variable   m_readCondVar;
-    std::condition_variable   m_readGenCondVar;
-    std::set <uint256>        m_readSet;        // set of reads to do
-    uint256                   m_readLast;       // last hash read
-    std::vector <std::thread> m_readThreads;
-    bool                      m_readShut;
-    uint64_t                  m_readGen;        // current read generation
+    // Async reads
+    ReadScheduler m_reads;
 public:
     DatabaseImp (std::string const& name,
                  Scheduler& scheduler,
@@ -75,30 +69,22 @@ public:
             stopwatch(), deprecatedLogs().journal("TaggedCache"))
         , m_negCache ("NodeStore", stopwatch(),
             cacheTargetSize, cacheTargetSeconds)
-        , m_readShut (false)
-        , m_readGen (0)
+        , m_reads (readThreads,
+            [this](uint256 const& hash, FetchReport const& report)
+            {
+                doTimedFetch (hash, report);
+            })
         , m_storeCount (0)
         , m_fetchTotalCount (0)
         , m_fetchHitCount (0)
         , m_storeSize (0)
         , m_fetchSize (0)
     {
-        for (int i = 0; i < readThreads; ++i)
-            m_readThreads.push_back (std::thread (&DatabaseImp::threadEntry,
-                    this));
     }
 
     ~DatabaseImp ()
     {
-        {
-            std::unique_lock <std::mutex> lock (m_readLock);
-            m_readShut = true;
-            m_readCondVar.notify_all ();
-            m_readGenCondVar.notify_all ();
-        }
-
-        for (auto& e : m_readThreads)
-            e.join();
+        m_reads.stop ();
     }
 
     std::string
@@ -126,28 +112,116 @@ public:
         if (object || m_negCache.touch_if_exists (hash))
             return true;
 
-        {
-            // No. Post a read
-            std::unique_lock <std::mutex> lock (m_readLock);
-            if (m_readSet.insert (hash).second)
-                m_readCondVar.notify_one ();
-        }
+        // No. Post a read
+        m_reads.post (hash, ScopedReadPriority::get ());
 
         return false;
     }
 
     void waitReads() override
     {
+        m_reads.wait ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::vector<uint256> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> objects (hashes.size ());
+
+        // Positions of the objects we have to read
+        std::vector<std::size_t> misses;
+        for (std::size_t i = 0; i < hashes.size (); ++i)
+        {
+            objects[i] = m_cache.fetch (hashes[i]);
+            if (!objects[i] && !m_negCache.touch_if_exists (hashes[i]))
+                misses.push_back (i);
+        }
+
+        if (misses.empty ())
+            return objects;
+
+        std::vector<uint256> keys;
+        keys.reserve (misses.size ());
+        for (auto i : misses)
+            keys.push_back (hashes[i]);
+
+        if (!canFetchBatch ())
         {
-            std::unique_lock <std::mutex> lock (m_readLock);
+            // Spread the reads over the prefetch threads
+            m_reads.postAndWait (keys, ScopedReadPriority::get ());
+
+            for (auto i : misses)
+                objects[i] = doTimedFetch (hashes[i], true);
+            return objects;
+        }
 
-            // Wake in two generations
-            std::uint64_t const wakeGeneration = m_readGen + 2;
+        FetchReport report;
+        report.isAsync = true;
+        report.wentToDisk = true;
 
-            while (!m_readShut && !m_readSet.empty () && (m_readGen < wakeGeneration))
-                m_readGenCondVar.wait (lock);
+        auto const before = std::chrono::steady_clock::now();
+        auto found = fetchBatchFrom (keys);
+        report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+            (std::chrono::steady_clock::now() - before);
+        m_fetchTotalCount += keys.size ();
+
+        report.wasFound = false;
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            auto& obj = found[i];
+            if (obj)
+            {
+                report.wasFound = true;
+                m_cache.canonicalize (keys[i], obj);
+            }
+            else
+            {
+                // Just in case a write occurred
+                obj = m_cache.fetch (keys[i]);
+                if (!obj)
+                    m_negCache.insert (keys[i]);
+            }
+            objects[misses[i]] = std::move (obj);
         }
 
+        m_scheduler.onFetch (report);
+
+        return objects;
+    }
+
+    /** Returns `true` if fetchBatchFrom can read from the backend(s). */
+    virtual bool canFetchBatch ()
+    {
+        return m_backend->canFetchBatch ();
+    }
+
+    virtual std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector<uint256> const& hashes)
+    {
+        return fetchBatchInternal (*m_backend, hashes);
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchInternal (Backend& backend, std::vector<uint256> const& hashes)
+    {
+        std::vector<void const*> keys;
+        keys.reserve (hashes.size ());
+        for (auto const& hash : hashes)
+            keys.push_back (hash.begin ());
+
+        auto objects = backend.fetchBatch (keys.size (), keys.data ());
+        assert (objects.size () == hashes.size ());
+
+        for (auto const& object : objects)
+        {
+            if (object)
+            {
+                ++m_fetchHitCount;
+                m_fetchSize += object->getData().size();
+            }
+        }
+
+        return objects;
     }
 
     int getDesiredAsyncReadCount ()
@@ -170,6 +244,11 @@ public:
     {
         FetchReport report;
         report.isAsync = isAsync;
+        return doTimedFetch (hash, report);
+    }
+
+    std::shared_ptr<NodeObject> doTimedFetch (uint256 const& hash, FetchReport report)
+    {
         report.wentToDisk = false;
 
         auto const before = std::chrono::steady_clock::now();
@@ -241,6 +320,96 @@ public:
         return fetchInternal (*m_backend, hash);
     }
 
+    bool fetchPayload (uint256 const& hash, FetchCallback const& f) override
+    {
+        ScopedMetrics::incrementThreadFetches ();
+
+        FetchReport report;
+        report.isAsync = false;
+        report.wentToDisk = false;
+
+        auto const before = std::chrono::steady_clock::now();
+        bool const found = doFetchPayload (hash, f, report);
+        report.elapsed = std::chrono::duration_cast <std::chrono::milliseconds>
+            (std::chrono::steady_clock::now() - before);
+
+        report.wasFound = found;
+        m_scheduler.onFetch (report);
+
+        return found;
+    }
+
+    bool doFetchPayload (uint256 const& hash, FetchCallback const& f,
+        FetchReport& report)
+    {
+        auto const fromObject = [&f](std::shared_ptr<NodeObject> const& obj)
+        {
+            auto const& data = obj->getData ();
+            f (obj->getType (), data.data (), data.size ());
+            return true;
+        };
+
+        if (auto const obj = m_cache.fetch (hash))
+            return fromObject (obj);
+
+        if (m_negCache.touch_if_exists (hash))
+            return false;
+
+        report.wentToDisk = true;
+
+        bool const found = fetchFrom (hash, f);
+        ++m_fetchTotalCount;
+        if (found)
+            return true;
+
+        // Just in case a write occurred
+        if (auto const obj = m_cache.fetch (hash))
+            return fromObject (obj);
+
+        m_negCache.insert (hash);
+        return false;
+    }
+
+    virtual bool fetchFrom (uint256 const& hash, FetchCallback const& f)
+    {
+        return fetchInternal (*m_backend, hash, f);
+    }
+
+    bool fetchInternal (Backend& backend,
+        uint256 const& hash, FetchCallback const& f)
+    {
+        std::size_t size = 0;
+        Status const status = backend.fetchPayload (hash.begin (),
+            [&f, &size](NodeObjectType type, void const* data, std::size_t n)
+            {
+                size = n;
+                f (type, data, n);
+            });
+
+        switch (status)
+        {
+        case ok:
+            ++m_fetchHitCount;
+            m_fetchSize += size;
+            return true;
+
+        case notFound:
+            break;
+
+        case dataCorrupt:
+            if (m_journal.fatal) m_journal.fatal <<
+                "Corrupt NodeObject #" << hash;
+            break;
+
+        default:
+            if (m_journal.warning) m_journal.warning <<
+                "Unknown status=" << status;
+            break;
+        }
+
+        return false;
+    }
+
     std::shared_ptr<NodeObject> fetchInternal (Backend& backend,
         uint256 const& hash)
     {
@@ -332,82 +501,43 @@ public:
 
     //------------------------------------------------------------------------------
 
-    // Entry point for async read threads
-    void threadEntry ()
+    void for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
     {
-        beast::Thread::setCurrentThreadName ("prefetch");
-        while (1)
-        {
-            uint256 hash;
-
-            {
-                std::unique_lock <std::mutex> lock (m_readLock);
-
-                while (!m_readShut && m_readSet.empty ())
-                {
-                    // all work is done
-                    m_readGenCondVar.notify_all ();
-                    m_readCondVar.wait (lock);
-                }
-
-                if (m_readShut)
-                    break;
-
-                // Read in key order to make the back end more efficient
-                std::set <uint256>::iterator it = m_readSet.lower_bound (m_readLast);
-                if (it == m_readSet.end ())
-                {
-                    it = m_readSet.begin ();
-
-                    // A generation has completed
-                    ++m_readGen;
-                    m_readGenCondVar.notify_all ();
-                }
-
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
-            }
-
-            // Perform the read
-            doTimedFetch (hash, true);
-         }
-     }
+        m_backend->for_each (f);
+    }
 
-    //------------------------------------------------------------------------------
+    bool canVisitRange () override
+    {
+        return m_backend->canVisitRange ();
+    }
 
-    void for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
+    void for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
     {
-        m_backend->for_each (f);
+        m_backend->for_each (first, last, f);
     }
 
-    void import (Database& source)
+    void storeBatch (Batch const& batch) override
     {
-        importInternal (source, *m_backend.get());
+        storeBatchInternal (batch, *m_backend);
     }
 
-    void importInternal (Database& source, Backend& dest)
+    void storeBatchInternal (Batch const& batch, Backend& dest)
     {
-        Batch b;
-        b.reserve (batchWritePreallocationSize);
+        dest.storeBatch (batch);
 
-        source.for_each ([&](std::shared_ptr<NodeObject> object)
+        for (auto const& object : batch)
         {
-            if (b.size() >= batchWritePreallocationSize)
-            {
-                dest.storeBatch (b);
-                b.clear();
-                b.reserve (batchWritePreallocationSize);
-            }
-
-            b.push_back (object);
             ++m_storeCount;
-            if (object)
-                m_storeSize += object->getData().size();
-        });
+            m_storeSize += object->getData().size();
+            m_negCache.erase (object->getHash());
+        }
+    }
 
-        if (! b.empty())
-            dest.storeBatch (b);
+    void import (Database& source) override
+    {
+        Importer importer (source, *this, Importer::Setup (), m_journal);
+        importer.run ();
     }
 
     std::uint32_t getStoreCount () const override
@@ -435,6 +565,11 @@ public:
         return m_fetchSize;
     }
 
+    FilterCounts getFilterCounts () const override
+    {
+        return m_backend->getFilterCounts ();
+    }
+
 private:
     std::atomic <std::uint32_t> m_storeCount;
     std::atomic <std::uint32_t> m_fetchTotalCount;
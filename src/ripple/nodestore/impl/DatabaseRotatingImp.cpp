@@ -50,6 +50,60 @@ std::shared_ptr<NodeObject> DatabaseRotatingImp::fetchFrom (uint256 const& hash)
 
     return object;
 }
+
+bool DatabaseRotatingImp::fetchFrom (uint256 const& hash,
+    FetchCallback const& f)
+{
+    Backends b = getBackends();
+    if (fetchInternal (*b.writableBackend, hash, f))
+        return true;
+
+    // Objects found in the archive are copied forward, which needs
+    // a NodeObject anyway
+    std::shared_ptr<NodeObject> object = fetchInternal (*b.archiveBackend, hash);
+    if (! object)
+        return false;
+    getWritableBackend()->store (object);
+    m_negCache.erase (hash);
+    auto const& data = object->getData ();
+    f (object->getType (), data.data (), data.size ());
+    return true;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseRotatingImp::fetchBatchFrom (std::vector<uint256> const& hashes)
+{
+    Backends b = getBackends();
+    auto objects = fetchBatchInternal (*b.writableBackend, hashes);
+
+    std::vector<std::size_t> misses;
+    std::vector<uint256> keys;
+    for (std::size_t i = 0; i < objects.size (); ++i)
+    {
+        if (!objects[i])
+        {
+            misses.push_back (i);
+            keys.push_back (hashes[i]);
+        }
+    }
+
+    if (keys.empty ())
+        return objects;
+
+    auto archived = fetchBatchInternal (*b.archiveBackend, keys);
+    for (std::size_t i = 0; i < keys.size (); ++i)
+    {
+        if (archived[i])
+        {
+            getWritableBackend()->store (archived[i]);
+            m_negCache.erase (keys[i]);
+            objects[misses[i]] = std::move (archived[i]);
+        }
+    }
+
+    return objects;
+}
+
 }
 
 }
@@ -95,6 +95,14 @@ public:
         return getWritableBackend()->getWriteLoad();
     }
 
+    FilterCounts getFilterCounts() const override
+    {
+        Backends b = getBackends();
+        FilterCounts counts = b.writableBackend->getFilterCounts();
+        counts += b.archiveBackend->getFilterCounts();
+        return counts;
+    }
+
     void for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override
     {
         Backends b = getBackends();
@@ -102,9 +110,31 @@ public:
         b.writableBackend->for_each (f);
     }
 
-    void import (Database& source) override
+    bool canVisitRange () override
+    {
+        Backends b = getBackends();
+        return b.archiveBackend->canVisitRange () &&
+            b.writableBackend->canVisitRange ();
+    }
+
+    void for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
     {
-        importInternal (source, *getWritableBackend());
+        Backends b = getBackends();
+        bool stopped = false;
+        b.archiveBackend->for_each (first, last,
+            [&](std::shared_ptr<NodeObject> object)
+            {
+                stopped = ! f (std::move (object));
+                return ! stopped;
+            });
+        if (! stopped)
+            b.writableBackend->for_each (first, last, f);
+    }
+
+    void storeBatch (Batch const& batch) override
+    {
+        storeBatchInternal (batch, *getWritableBackend());
     }
 
     void store (NodeObjectType type,
@@ -121,7 +151,20 @@ public:
     }
 
     std::shared_ptr<NodeObject> fetchFrom (uint256 const& hash) override;
-    TaggedCache <uint256, NodeObject>& getPositiveCache() override
+
+    bool fetchFrom (uint256 const& hash, FetchCallback const& f) override;
+
+    bool canFetchBatch () override
+    {
+        Backends b = getBackends();
+        return b.writableBackend->canFetchBatch () &&
+            b.archiveBackend->canFetchBatch ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector<uint256> const& hashes) override;
+
+    ShardedTaggedCache <uint256, NodeObject>& getPositiveCache() override
     {
         return m_cache;
     }
@@ -0,0 +1,215 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/DatabaseShardImp.h>
+#include <ripple/nodestore/impl/NumberedDirectories.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+DatabaseShardImp::DatabaseShardImp (std::string const& name,
+        Scheduler& scheduler, Section const& parameters,
+            beast::Journal journal)
+    : name_ (name)
+    , scheduler_ (scheduler)
+    , parameters_ (parameters)
+    , journal_ (journal)
+    , dir_ (get<std::string>(parameters, "path"))
+{
+    if (dir_.empty ())
+        throw std::runtime_error (
+            "nodestore: Missing path in [shard_db]");
+    get_if_exists (parameters, "ledgers_per_shard", ledgersPerShard_);
+    get_if_exists (parameters, "compact", compact_);
+    if (ledgersPerShard_ == 0)
+        throw std::runtime_error (
+            "nodestore: ledgers_per_shard must be positive");
+
+    // A Mapped backend is sealed when closed, but a shard is
+    // written until it is complete.
+    if (boost::iequals (get<std::string>(parameters, "type"), "mapped"))
+        throw std::runtime_error (
+            "nodestore: type=mapped can't be used for [shard_db], "
+                "set compact instead");
+
+    boost::filesystem::create_directories (dir_);
+    for (auto const index : numberedDirectories (dir_))
+        openShard (index);
+
+    if (journal_.info) journal_.info <<
+        name_ << " opened " << shards_.size () << " shards in '" <<
+            dir_.string () << "', complete: " << getCompleteShards ();
+}
+
+void
+DatabaseShardImp::close ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    for (auto const& e : shards_)
+        e.second->close ();
+}
+
+std::shared_ptr<NodeObject>
+DatabaseShardImp::fetch (uint256 const& hash, std::uint32_t seq)
+{
+    auto const shard = findShard (seqToShardIndex (seq));
+    if (! shard)
+        return nullptr;
+    return fetchFrom (*shard, hash);
+}
+
+std::shared_ptr<NodeObject>
+DatabaseShardImp::fetch (uint256 const& hash)
+{
+    std::vector <std::shared_ptr <Shard>> shards;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        shards.reserve (shards_.size ());
+        for (auto iter = shards_.rbegin (); iter != shards_.rend (); ++iter)
+            shards.push_back (iter->second);
+    }
+
+    for (auto const& shard : shards)
+        if (auto object = fetchFrom (*shard, hash))
+            return object;
+    return nullptr;
+}
+
+void
+DatabaseShardImp::store (NodeObjectType type, Blob&& data,
+    uint256 const& hash, std::uint32_t seq)
+{
+    auto const shard = openShard (seqToShardIndex (seq));
+    if (shard->complete ())
+        return;
+    if (auto const backend = shard->backend ())
+        backend->store (NodeObject::createObject (
+            type, std::move (data), hash));
+}
+
+void
+DatabaseShardImp::setStored (std::uint32_t seq)
+{
+    auto const shard = openShard (seqToShardIndex (seq));
+    if (shard->setStored (seq))
+        shard->finalize ();
+}
+
+bool
+DatabaseShardImp::hasLedger (std::uint32_t seq)
+{
+    auto const shard = findShard (seqToShardIndex (seq));
+    return shard && shard->hasLedger (seq);
+}
+
+std::string
+DatabaseShardImp::getCompleteShards ()
+{
+    std::vector <std::uint32_t> complete;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        for (auto const& e : shards_)
+            if (e.second->complete ())
+                complete.push_back (e.first);
+    }
+
+    std::string result;
+    for (std::size_t i = 0; i < complete.size ();)
+    {
+        auto j = i;
+        while (j + 1 < complete.size () && complete[j + 1] == complete[j] + 1)
+            ++j;
+        if (! result.empty ())
+            result += ',';
+        result += std::to_string (complete[i]);
+        if (j > i)
+            result += '-' + std::to_string (complete[j]);
+        i = j + 1;
+    }
+    return result;
+}
+
+void
+DatabaseShardImp::validate ()
+{
+    std::vector <std::shared_ptr <Shard>> shards;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        for (auto const& e : shards_)
+            if (e.second->complete ())
+                shards.push_back (e.second);
+    }
+
+    for (auto const& shard : shards)
+    {
+        if (auto const backend = shard->backend ())
+            backend->verify ();
+        if (journal_.debug) journal_.debug <<
+            "Shard " << shard->index () << " verified";
+    }
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr <Shard>
+DatabaseShardImp::findShard (std::uint32_t index)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto const iter = shards_.find (index);
+    if (iter == shards_.end ())
+        return nullptr;
+    return iter->second;
+}
+
+std::shared_ptr <Shard>
+DatabaseShardImp::openShard (std::uint32_t index)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    auto const iter = shards_.find (index);
+    if (iter != shards_.end ())
+        return iter->second;
+    auto const shard = std::make_shared <Shard> (index, ledgersPerShard_,
+        dir_ / std::to_string (index), parameters_, compact_,
+            scheduler_, journal_);
+    shards_.emplace (index, shard);
+    return shard;
+}
+
+std::shared_ptr<NodeObject>
+DatabaseShardImp::fetchFrom (Shard const& shard, uint256 const& hash)
+{
+    auto const backend = shard.backend ();
+    if (! backend)
+        return nullptr;
+
+    std::shared_ptr<NodeObject> object;
+    Status const status = backend->fetch (hash.begin (), &object);
+    if (status == dataCorrupt)
+    {
+        if (journal_.fatal) journal_.fatal <<
+            "Corrupt NodeObject #" << hash << " in shard " << shard.index ();
+    }
+    return status == ok ? object : nullptr;
+}
+
+}
+}
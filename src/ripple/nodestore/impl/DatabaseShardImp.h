@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DATABASESHARDIMP_H_INCLUDED
+#define RIPPLE_NODESTORE_DATABASESHARDIMP_H_INCLUDED
+
+#include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/impl/Shard.h>
+#include <ripple/basics/BasicConfig.h>
+#include <beast/utility/Journal.h>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+class DatabaseShardImp : public DatabaseShard
+{
+public:
+    DatabaseShardImp (std::string const& name, Scheduler& scheduler,
+        Section const& parameters, beast::Journal journal);
+
+    void
+    close () override;
+
+    std::uint32_t
+    ledgersPerShard () const override
+    {
+        return ledgersPerShard_;
+    }
+
+    std::uint32_t
+    seqToShardIndex (std::uint32_t seq) const override
+    {
+        assert (seq > 0);
+        return (seq - 1) / ledgersPerShard_;
+    }
+
+    std::shared_ptr<NodeObject>
+    fetch (uint256 const& hash, std::uint32_t seq) override;
+
+    std::shared_ptr<NodeObject>
+    fetch (uint256 const& hash) override;
+
+    void
+    store (NodeObjectType type, Blob&& data,
+        uint256 const& hash, std::uint32_t seq) override;
+
+    void
+    setStored (std::uint32_t seq) override;
+
+    bool
+    hasLedger (std::uint32_t seq) override;
+
+    std::string
+    getCompleteShards () override;
+
+    void
+    validate () override;
+
+private:
+    std::shared_ptr <Shard>
+    findShard (std::uint32_t index);
+
+    std::shared_ptr <Shard>
+    openShard (std::uint32_t index);
+
+    std::shared_ptr<NodeObject>
+    fetchFrom (Shard const& shard, uint256 const& hash);
+
+    std::string const name_;
+    Scheduler& scheduler_;
+    Section const parameters_;
+    beast::Journal journal_;
+    boost::filesystem::path const dir_;
+    std::uint32_t ledgersPerShard_ = 16384;
+    bool compact_ = true;
+
+    std::mutex mutex_;
+    std::map <std::uint32_t, std::shared_ptr <Shard>> shards_;
+};
+
+}
+}
+
+#endif
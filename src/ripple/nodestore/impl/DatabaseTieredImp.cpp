@@ -0,0 +1,399 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/nodestore/impl/NumberedDirectories.h>
+#include <ripple/nodestore/Manager.h>
+#include <boost/filesystem.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+DatabaseTieredImp::DatabaseTieredImp (std::string const& name,
+        Scheduler& scheduler,
+        int readThreads,
+        Section const& fastParameters,
+        std::unique_ptr <Backend> slowBackend,
+        beast::Journal journal)
+    : DatabaseImp (name, scheduler, readThreads,
+        std::unique_ptr <Backend>(), journal)
+    , scheduler_ (scheduler)
+    , journal_ (journal)
+    , fastParameters_ (fastParameters)
+    , fastPath_ (get<std::string>(fastParameters, "path"))
+    , slow_ (std::move (slowBackend))
+{
+    if (fastPath_.empty ())
+        throw std::runtime_error (
+            "nodestore: Missing path in the fast tier");
+
+    std::uint32_t age;
+    if (get_if_exists (fastParameters_, "age", age))
+        age_ = std::chrono::seconds (age);
+    get_if_exists (fastParameters_, "promote", promote_);
+
+    boost::filesystem::create_directories (fastPath_);
+    auto generations = numberedDirectories (fastPath_);
+
+    // More than two generations means the server stopped while
+    // demoting, so finish the job
+    while (generations.size () > 2)
+    {
+        auto backend = openGeneration (generations.front ());
+        demote (*backend);
+        backend->setDeletePath ();
+        generations.erase (generations.begin ());
+    }
+
+    if (generations.empty ())
+    {
+        current_ = openGeneration (0);
+    }
+    else
+    {
+        currentIndex_ = generations.back ();
+        current_ = openGeneration (currentIndex_);
+        if (generations.size () > 1)
+            previous_ = openGeneration (generations.front ());
+    }
+    started_ = clock_type::now ();
+
+    if (journal_.info) journal_.info <<
+        "Fast tier '" << fastPath_ << "' at generation " <<
+            currentIndex_ << ", demoting every " << age_.count () << "s";
+
+    if (! boost::filesystem::is_directory (generationPath (currentIndex_)) &&
+        journal_.warning)
+    {
+        journal_.warning <<
+            "Fast tier '" << fastPath_ << "' keeps nothing on disk, so "
+                "up to " << 2 * age_.count () << "s of objects are lost "
+                    "if the server stops without closing it";
+    }
+}
+
+DatabaseTieredImp::~DatabaseTieredImp ()
+{
+    close ();
+}
+
+void
+DatabaseTieredImp::close ()
+{
+    Tiers tiers;
+    std::uint32_t index;
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        cond_.wait (lock, [this] { return ! demoting_; });
+        if (closed_)
+            return;
+        closed_ = true;
+        tiers = Tiers {current_, previous_, slow_};
+        index = currentIndex_;
+    }
+
+    // A generation which keeps nothing on disk would be lost
+    if (! boost::filesystem::is_directory (generationPath (index)))
+    {
+        if (tiers.previous)
+        {
+            demote (*tiers.previous);
+            tiers.previous->setDeletePath ();
+        }
+        demote (*tiers.current);
+        tiers.current->setDeletePath ();
+    }
+
+    tiers.current->close ();
+    if (tiers.previous)
+        tiers.previous->close ();
+    tiers.slow->close ();
+}
+
+//------------------------------------------------------------------------------
+
+std::string
+DatabaseTieredImp::generationPath (std::uint32_t index) const
+{
+    return (boost::filesystem::path (fastPath_) /
+        std::to_string (index)).string ();
+}
+
+std::shared_ptr <Backend>
+DatabaseTieredImp::openGeneration (std::uint32_t index)
+{
+    Section parameters (fastParameters_);
+    parameters.set ("path", generationPath (index));
+    return Manager::instance ().make_Backend (
+        parameters, scheduler_, journal_);
+}
+
+void
+DatabaseTieredImp::demote (Backend& backend)
+{
+    auto const start = clock_type::now ();
+    std::uint64_t n = 0;
+
+    Batch batch;
+    batch.reserve (batchWritePreallocationSize);
+    backend.for_each ([&](std::shared_ptr<NodeObject> object)
+    {
+        batch.push_back (std::move (object));
+        if (batch.size () >= batchWritePreallocationSize)
+        {
+            slow_->storeBatch (batch);
+            n += batch.size ();
+            batch.clear ();
+        }
+    });
+    if (! batch.empty ())
+    {
+        slow_->storeBatch (batch);
+        n += batch.size ();
+    }
+
+    if (journal_.info) journal_.info <<
+        "Demoted " << n << " objects from '" << backend.getName () <<
+            "' in " << std::chrono::duration_cast <std::chrono::seconds> (
+                clock_type::now () - start).count () << "s";
+}
+
+void
+DatabaseTieredImp::promote (Backend& current,
+    std::shared_ptr<NodeObject> const& object)
+{
+    if (! promote_)
+        return;
+    current.store (object);
+    m_negCache.erase (object->getHash ());
+}
+
+void
+DatabaseTieredImp::sweep ()
+{
+    DatabaseImp::sweep ();
+
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (closed_ || demoting_ || clock_type::now () - started_ < age_)
+            return;
+        demoting_ = true;
+    }
+
+    // Outside the lock, since the task may run on this thread
+    scheduler_.scheduleTask (*this);
+}
+
+void
+DatabaseTieredImp::performScheduledTask ()
+{
+    try
+    {
+        std::shared_ptr <Backend> retired;
+        std::uint32_t index;
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            retired = previous_;
+            index = currentIndex_ + 1;
+        }
+
+        // The retiring generation stays readable until its
+        // objects are in the slow tier
+        if (retired)
+            demote (*retired);
+        auto next = openGeneration (index);
+
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            previous_ = std::move (current_);
+            current_ = std::move (next);
+            currentIndex_ = index;
+        }
+
+        // Removed once the last fetch using it is done
+        if (retired)
+            retired->setDeletePath ();
+    }
+    catch (std::exception const& e)
+    {
+        if (journal_.fatal) journal_.fatal <<
+            "Demoting the fast tier failed: " << e.what ();
+    }
+
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        started_ = clock_type::now ();
+        demoting_ = false;
+    }
+    cond_.notify_all ();
+}
+
+//------------------------------------------------------------------------------
+
+std::shared_ptr<NodeObject>
+DatabaseTieredImp::fetchFrom (uint256 const& hash)
+{
+    auto const tiers = getTiers ();
+    auto object = fetchInternal (*tiers.current, hash);
+    if (object)
+        return object;
+
+    if (tiers.previous)
+        object = fetchInternal (*tiers.previous, hash);
+    if (! object)
+        object = fetchInternal (*tiers.slow, hash);
+    if (object)
+        promote (*tiers.current, object);
+    return object;
+}
+
+bool
+DatabaseTieredImp::fetchFrom (uint256 const& hash, FetchCallback const& f)
+{
+    auto const tiers = getTiers ();
+    if (fetchInternal (*tiers.current, hash, f))
+        return true;
+
+    if (! promote_)
+        return (tiers.previous && fetchInternal (*tiers.previous, hash, f)) ||
+            fetchInternal (*tiers.slow, hash, f);
+
+    // Promoting needs a NodeObject anyway
+    std::shared_ptr<NodeObject> object;
+    if (tiers.previous)
+        object = fetchInternal (*tiers.previous, hash);
+    if (! object)
+        object = fetchInternal (*tiers.slow, hash);
+    if (! object)
+        return false;
+    promote (*tiers.current, object);
+    auto const& data = object->getData ();
+    f (object->getType (), data.data (), data.size ());
+    return true;
+}
+
+bool
+DatabaseTieredImp::canFetchBatch ()
+{
+    auto const tiers = getTiers ();
+    return tiers.current->canFetchBatch () &&
+        (! tiers.previous || tiers.previous->canFetchBatch ()) &&
+            tiers.slow->canFetchBatch ();
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseTieredImp::fetchBatchFrom (std::vector<uint256> const& hashes)
+{
+    auto const tiers = getTiers ();
+    auto objects = fetchBatchInternal (*tiers.current, hashes);
+
+    for (auto const& backend : { tiers.previous, tiers.slow })
+    {
+        if (! backend)
+            continue;
+
+        std::vector<std::size_t> misses;
+        std::vector<uint256> keys;
+        for (std::size_t i = 0; i < objects.size (); ++i)
+        {
+            if (! objects[i])
+            {
+                misses.push_back (i);
+                keys.push_back (hashes[i]);
+            }
+        }
+        if (keys.empty ())
+            break;
+
+        auto found = fetchBatchInternal (*backend, keys);
+        for (std::size_t i = 0; i < keys.size (); ++i)
+        {
+            if (found[i])
+            {
+                promote (*tiers.current, found[i]);
+                objects[misses[i]] = std::move (found[i]);
+            }
+        }
+    }
+
+    return objects;
+}
+
+void
+DatabaseTieredImp::for_each (
+    std::function <void (std::shared_ptr<NodeObject>)> f)
+{
+    auto const tiers = getTiers ();
+    tiers.slow->for_each (f);
+    if (tiers.previous)
+        tiers.previous->for_each (f);
+    tiers.current->for_each (f);
+}
+
+bool
+DatabaseTieredImp::canVisitRange ()
+{
+    auto const tiers = getTiers ();
+    return tiers.current->canVisitRange () &&
+        (! tiers.previous || tiers.previous->canVisitRange ()) &&
+            tiers.slow->canVisitRange ();
+}
+
+void
+DatabaseTieredImp::for_each (uint256 const& first, uint256 const& last,
+    std::function <bool (std::shared_ptr<NodeObject>)> f)
+{
+    auto const tiers = getTiers ();
+    bool stopped = false;
+    for (auto const& backend : { tiers.slow, tiers.previous, tiers.current })
+    {
+        if (stopped)
+            break;
+        if (! backend)
+            continue;
+        backend->for_each (first, last,
+            [&](std::shared_ptr<NodeObject> object)
+            {
+                stopped = ! f (std::move (object));
+                return ! stopped;
+            });
+    }
+}
+
+std::int32_t
+DatabaseTieredImp::getWriteLoad () const
+{
+    auto const tiers = getTiers ();
+    return tiers.current->getWriteLoad () + tiers.slow->getWriteLoad ();
+}
+
+FilterCounts
+DatabaseTieredImp::getFilterCounts () const
+{
+    auto const tiers = getTiers ();
+    FilterCounts counts = tiers.current->getFilterCounts ();
+    if (tiers.previous)
+        counts += tiers.previous->getFilterCounts ();
+    counts += tiers.slow->getFilterCounts ();
+    return counts;
+}
+
+}
+}
@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+#define RIPPLE_NODESTORE_DATABASETIEREDIMP_H_INCLUDED
+
+#include <ripple/nodestore/impl/DatabaseImp.h>
+#include <ripple/nodestore/Task.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A database which keeps recently written objects on fast media.
+
+    Objects are stored in the fast tier, a series of generations of a
+    fast backend such as Memory, or NuDB on an SSD. Each generation is
+    written for `age` seconds. Then a new one is started, and the one
+    before it is demoted: its objects are copied to the slow tier and it
+    is deleted. So an object stays on fast media for between one and two
+    ages after it was written.
+
+    Fetches try the current generation, then the previous one, then the
+    slow tier. With promotion, an object found in an older place is
+    copied into the current generation, so objects which keep being read
+    stay on fast media.
+
+    Each generation has a numbered directory under the fast tier's path,
+    and is reopened on start. Generations which keep nothing on disk,
+    such as Memory, are demoted when the database is closed. If the
+    server stops without closing it, up to two ages of objects are lost,
+    and the ledgers holding them have to be acquired again.
+*/
+class DatabaseTieredImp
+    : public DatabaseImp
+    , private Task
+{
+public:
+    DatabaseTieredImp (std::string const& name,
+        Scheduler& scheduler,
+        int readThreads,
+        Section const& fastParameters,
+        std::unique_ptr <Backend> slowBackend,
+        beast::Journal journal);
+
+    ~DatabaseTieredImp ();
+
+    std::string
+    getName () const override
+    {
+        return getTiers ().slow->getName ();
+    }
+
+    void
+    close () override;
+
+    void
+    store (NodeObjectType type, Blob&& data,
+        uint256 const& hash) override
+    {
+        storeInternal (type, std::move (data), hash, *getTiers ().current);
+    }
+
+    void
+    storeBatch (Batch const& batch) override
+    {
+        storeBatchInternal (batch, *getTiers ().current);
+    }
+
+    std::shared_ptr<NodeObject>
+    fetchFrom (uint256 const& hash) override;
+
+    bool
+    fetchFrom (uint256 const& hash, FetchCallback const& f) override;
+
+    bool
+    canFetchBatch () override;
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom (std::vector<uint256> const& hashes) override;
+
+    void
+    for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override;
+
+    bool
+    canVisitRange () override;
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override;
+
+    std::int32_t
+    getWriteLoad () const override;
+
+    FilterCounts
+    getFilterCounts () const override;
+
+    /** Sweep the caches, and start demoting if the current generation
+        is old enough.
+    */
+    void
+    sweep () override;
+
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    struct Tiers
+    {
+        std::shared_ptr <Backend> current;
+        std::shared_ptr <Backend> previous;
+        std::shared_ptr <Backend> slow;
+    };
+
+    Tiers
+    getTiers () const
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        return Tiers {current_, previous_, slow_};
+    }
+
+    std::string
+    generationPath (std::uint32_t index) const;
+
+    std::shared_ptr <Backend>
+    openGeneration (std::uint32_t index);
+
+    void
+    demote (Backend& backend);
+
+    void
+    promote (Backend& current, std::shared_ptr<NodeObject> const& object);
+
+    void
+    performScheduledTask () override;
+
+    Scheduler& scheduler_;
+    beast::Journal journal_;
+    Section const fastParameters_;
+    std::string const fastPath_;
+    std::chrono::seconds age_ {600};
+    bool promote_ = true;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::shared_ptr <Backend> current_;
+    std::shared_ptr <Backend> previous_;
+    std::shared_ptr <Backend> slow_;
+    std::uint32_t currentIndex_ = 0;
+    clock_type::time_point started_;
+    bool demoting_ = false;
+    bool closed_ = false;
+};
+
+}
+}
+
+#endif
@@ -47,6 +47,13 @@ public:
     /** Create a NodeObject from this data. */
     std::shared_ptr<NodeObject> createObject ();
 
+    /** The decoded payload, which refers to the raw data. */
+    /** @{ */
+    NodeObjectType getType () const noexcept { return m_objectType; }
+    void const* getData () const noexcept { return m_objectData; }
+    std::size_t getSize () const noexcept { return m_dataBytes; }
+    /** @} */
+
 private:
     bool m_success;
 
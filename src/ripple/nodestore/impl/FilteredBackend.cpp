@@ -0,0 +1,315 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
+#include <beast/threads/Thread.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace ripple {
+namespace NodeStore {
+
+static
+std::string
+filterFile (std::string const& path)
+{
+    return (boost::filesystem::path (path) / "nodestore.filter").string ();
+}
+
+FilteredBackend::FilteredBackend (std::unique_ptr <Backend> backend,
+        std::uint64_t keys, std::string const& path,
+            beast::Journal journal)
+    : backend_ (std::move (backend))
+    , file_ (filterFile (path))
+    , journal_ (journal)
+{
+    std::uint64_t objects = 0;
+    filter_ = BloomFilter::load (file_, objects);
+    if (filter_ && objects <= filter_->capacity () &&
+        keys <= filter_->capacity ())
+    {
+        objects_ = objects;
+        ready_ = true;
+        if (journal_.info) journal_.info <<
+            "Loaded key filter for '" << getName () << "'";
+    }
+    else
+    {
+        // Leave room for the backend to grow
+        filter_ = std::make_unique <BloomFilter> (
+            std::max (keys, 2 * objects));
+        if (backend_->canVisitRange ())
+        {
+            builder_ = std::thread (&FilteredBackend::build, this);
+        }
+        else if (journal_.warning)
+        {
+            journal_.warning <<
+                "Key filter for '" << getName () <<
+                    "' will be built when it is closed";
+        }
+    }
+
+    // A filter left on disk would miss the keys stored after this,
+    // if the server stopped without saving it again.
+    boost::system::error_code ec;
+    boost::filesystem::remove (file_, ec);
+}
+
+FilteredBackend::~FilteredBackend ()
+{
+    stop ();
+    save ();
+}
+
+void
+FilteredBackend::discard (std::string const& path)
+{
+    boost::system::error_code ec;
+    boost::filesystem::remove (filterFile (path), ec);
+}
+
+void
+FilteredBackend::close ()
+{
+    stop ();
+    save ();
+    backend_->close ();
+}
+
+Status
+FilteredBackend::fetch (void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    if (! ready_)
+        return backend_->fetch (key, pObject);
+
+    if (! filter_->mayContain (uint256::fromVoid (key)))
+    {
+        ++skipped_;
+        pObject->reset ();
+        return notFound;
+    }
+
+    Status const status = backend_->fetch (key, pObject);
+    if (status == ok)
+        ++hits_;
+    else if (status == notFound)
+        ++falsePositives_;
+    return status;
+}
+
+Status
+FilteredBackend::fetchPayload (void const* key, FetchCallback const& f)
+{
+    if (! ready_)
+        return backend_->fetchPayload (key, f);
+
+    if (! filter_->mayContain (uint256::fromVoid (key)))
+    {
+        ++skipped_;
+        return notFound;
+    }
+
+    Status const status = backend_->fetchPayload (key, f);
+    if (status == ok)
+        ++hits_;
+    else if (status == notFound)
+        ++falsePositives_;
+    return status;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+FilteredBackend::fetchBatch (std::size_t n, void const* const* keys)
+{
+    if (! ready_)
+        return backend_->fetchBatch (n, keys);
+
+    std::vector<std::shared_ptr<NodeObject>> objects (n);
+
+    // Only read the keys which pass the filter
+    std::vector<std::size_t> index;
+    std::vector<void const*> passed;
+    index.reserve (n);
+    passed.reserve (n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (filter_->mayContain (uint256::fromVoid (keys[i])))
+        {
+            index.push_back (i);
+            passed.push_back (keys[i]);
+        }
+    }
+    skipped_ += n - passed.size ();
+
+    if (passed.empty ())
+        return objects;
+
+    auto found = backend_->fetchBatch (passed.size (), passed.data ());
+    for (std::size_t i = 0; i < found.size (); ++i)
+    {
+        if (found[i])
+            ++hits_;
+        else
+            ++falsePositives_;
+        objects[index[i]] = std::move (found[i]);
+    }
+    return objects;
+}
+
+void
+FilteredBackend::store (std::shared_ptr<NodeObject> const& object)
+{
+    // Insert first, so the object is never filtered out once stored
+    if (filter_->insert (object->getHash ()))
+        ++objects_;
+    backend_->store (object);
+}
+
+void
+FilteredBackend::storeBatch (Batch const& batch)
+{
+    for (auto const& object : batch)
+        if (filter_->insert (object->getHash ()))
+            ++objects_;
+    backend_->storeBatch (batch);
+}
+
+FilterCounts
+FilteredBackend::getFilterCounts ()
+{
+    FilterCounts counts;
+    counts.filters = 1;
+    counts.building = ready_ ? 0 : 1;
+    counts.skipped = skipped_;
+    counts.hits = hits_;
+    counts.falsePositives = falsePositives_;
+    return counts;
+}
+
+void
+FilteredBackend::setDeletePath ()
+{
+    deletePath_ = true;
+    backend_->setDeletePath ();
+}
+
+void
+FilteredBackend::build ()
+{
+    beast::Thread::setCurrentThreadName ("filter");
+
+    auto const start = std::chrono::steady_clock::now ();
+    std::uint64_t n = 0;
+    try
+    {
+        // Objects stored meanwhile are added by store, and may be
+        // counted twice, which only errs toward a larger filter.
+        backend_->for_each (uint256 (), ~uint256 (),
+            [&](std::shared_ptr<NodeObject> object)
+            {
+                if (stopping_)
+                    return false;
+                filter_->insert (object->getHash ());
+                ++n;
+                return true;
+            });
+    }
+    catch (std::exception const& e)
+    {
+        if (journal_.error) journal_.error <<
+            "Unable to build key filter for '" << getName () <<
+                "': " << e.what ();
+        return;
+    }
+    if (stopping_)
+        return;
+    objects_ += n;
+    ready_ = true;
+
+    if (journal_.info) journal_.info <<
+        "Built key filter for '" << getName () << "' from " << n <<
+            " objects in " << std::chrono::duration_cast <
+                std::chrono::seconds> (std::chrono::steady_clock::now () -
+                    start).count () << "s, " << filter_->size () << " bytes";
+}
+
+void
+FilteredBackend::stop ()
+{
+    stopping_ = true;
+    if (builder_.joinable ())
+        builder_.join ();
+}
+
+void
+FilteredBackend::save ()
+{
+    if (saved_ || deletePath_)
+        return;
+    saved_ = true;
+
+    // Backends which keep nothing on disk have no directory
+    boost::system::error_code ec;
+    if (! boost::filesystem::is_directory (
+            boost::filesystem::path (file_).parent_path (), ec))
+        return;
+
+    if (! ready_)
+    {
+        // A build stopped part way is of no use
+        if (backend_->canVisitRange ())
+            return;
+
+        auto const start = std::chrono::steady_clock::now ();
+        std::uint64_t n = 0;
+        backend_->for_each ([&](std::shared_ptr<NodeObject> object)
+        {
+            filter_->insert (object->getHash ());
+            ++n;
+        });
+        objects_ = n;
+
+        if (journal_.info) journal_.info <<
+            "Built key filter for '" << getName () << "' from " << n <<
+                " objects in " << std::chrono::duration_cast <
+                    std::chrono::seconds> (std::chrono::steady_clock::now () -
+                        start).count () << "s, " << filter_->size () <<
+                            " bytes";
+    }
+
+    if (objects_ > filter_->capacity ())
+    {
+        if (journal_.warning) journal_.warning <<
+            "Key filter for '" << getName () << "' holds " << objects_ <<
+                " objects but is sized for " << filter_->capacity () <<
+                    ", it will be rebuilt when next opened";
+    }
+
+    if (! filter_->save (file_, objects_))
+    {
+        if (journal_.warning) journal_.warning <<
+            "Unable to save key filter '" << file_ << "'";
+        boost::filesystem::remove (file_, ec);
+    }
+}
+
+}
+}
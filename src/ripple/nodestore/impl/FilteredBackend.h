@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+#define RIPPLE_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/impl/BloomFilter.h>
+#include <beast/utility/Journal.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A backend which screens fetches with a filter of its keys.
+
+    Every key stored is added to a Bloom filter. A fetch for a key which
+    the filter has never seen returns notFound without reading the
+    backend, which saves the disk probes made for objects we don't have,
+    for example while acquiring a ledger.
+
+    When the backend is closed, the filter is saved in its directory and
+    read back when it is next opened. The saved file is removed when it
+    is loaded, so after a crash the filter is rebuilt by visiting every
+    object in the backend. Until it is complete every fetch is passed to
+    the backend. Backends which can be visited while in use build it on
+    a thread of its own; others build it when they are closed, ready for
+    the next time they are opened.
+
+    The saved file records how many objects the filter holds. When that
+    is more than the filter was sized for, it is rebuilt with room for
+    twice as many.
+*/
+class FilteredBackend
+    : public Backend
+{
+public:
+    /** Create the filter for a backend.
+        @param backend The backend to wrap.
+        @param keys The least number of objects the filter is sized for.
+        @param path The directory of the backend.
+    */
+    FilteredBackend (std::unique_ptr <Backend> backend,
+        std::uint64_t keys, std::string const& path,
+            beast::Journal journal);
+
+    ~FilteredBackend ();
+
+    /** Remove a saved filter from a backend's directory.
+        This is called when a backend is opened without a filter, since
+        objects stored then would be missing from the saved filter.
+    */
+    static
+    void
+    discard (std::string const& path);
+
+    std::string
+    getName () override
+    {
+        return backend_->getName ();
+    }
+
+    void
+    close () override;
+
+    Status
+    fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    Status
+    fetchPayload (void const* key, FetchCallback const& f) override;
+
+    bool
+    canFetchBatch () override
+    {
+        return backend_->canFetchBatch ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::size_t n, void const* const* keys) override;
+
+    void
+    store (std::shared_ptr<NodeObject> const& object) override;
+
+    void
+    storeBatch (Batch const& batch) override;
+
+    void
+    for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each (f);
+    }
+
+    bool
+    canVisitRange () override
+    {
+        return backend_->canVisitRange ();
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each (first, last, f);
+    }
+
+    int
+    getWriteLoad () override
+    {
+        return backend_->getWriteLoad ();
+    }
+
+    FilterCounts
+    getFilterCounts () override;
+
+    void
+    setDeletePath () override;
+
+    void
+    verify () override
+    {
+        backend_->verify ();
+    }
+
+private:
+    void
+    build ();
+
+    void
+    stop ();
+
+    void
+    save ();
+
+    std::unique_ptr <Backend> backend_;
+    std::unique_ptr <BloomFilter> filter_;
+    std::string const file_;
+    beast::Journal journal_;
+    bool saved_ = false;
+    bool deletePath_ = false;
+
+    // Set when the filter holds every key in the backend
+    std::atomic <bool> ready_ {false};
+    std::atomic <bool> stopping_ {false};
+    std::thread builder_;
+
+    // The number of objects in the filter
+    std::atomic <std::uint64_t> objects_ {0};
+
+    std::atomic <std::uint64_t> skipped_ {0};
+    std::atomic <std::uint64_t> hits_ {0};
+    std::atomic <std::uint64_t> falsePositives_ {0};
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,343 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/Importer.h>
+#include <beast/threads/Thread.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <sstream>
+
+namespace ripple {
+namespace NodeStore {
+
+Importer::Importer (Database& source, Database& dest,
+        Setup const& setup, beast::Journal journal)
+    : source_ (source)
+    , dest_ (dest)
+    , setup_ (setup)
+    , journal_ (journal)
+{
+    assert (setup_.threads > 0);
+    assert (setup_.partitions > 0 && setup_.partitions <= 65536);
+}
+
+Importer::~Importer ()
+{
+    stop ();
+    wait ();
+}
+
+void
+Importer::start ()
+{
+    assert (threads_.empty ());
+
+    loadCheckpoint ();
+
+    int const remaining = setup_.partitions - finished ();
+    if (remaining == 0)
+    {
+        if (journal_.info) journal_.info <<
+            "Import from '" << source_.getName () << "' is already complete";
+        return;
+    }
+
+    if (journal_.info) journal_.info <<
+        "Importing from '" << source_.getName () << "', " <<
+            remaining << " of " << setup_.partitions << " ranges left";
+
+    next_ = 0;
+    stop_ = false;
+
+    if (! source_.canVisitRange ())
+    {
+        threads_.emplace_back (&Importer::copyAll, this);
+        return;
+    }
+
+    int const threads = std::min (setup_.threads, remaining);
+    threads_.reserve (threads);
+    for (int i = 0; i < threads; ++i)
+        threads_.emplace_back (&Importer::copyRanges, this);
+}
+
+void
+Importer::stop ()
+{
+    stop_ = true;
+}
+
+bool
+Importer::wait ()
+{
+    for (auto& t : threads_)
+        t.join ();
+    threads_.clear ();
+
+    bool const done = ! error_ && finished () == setup_.partitions;
+    if (done)
+        removeCheckpoint ();
+    if (journal_.info) journal_.info <<
+        "Import " << (done ? "complete, " : "stopped, ") <<
+            objects_ << " objects copied";
+    return done;
+}
+
+int
+Importer::finished () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return static_cast<int> (
+        std::count (finished_.begin (), finished_.end (), true));
+}
+
+std::pair <uint256, uint256>
+Importer::range (int partition, int partitions)
+{
+    assert (partition >= 0 && partition < partitions);
+    assert (partitions <= 65536);
+
+    // Split on the first two bytes of the key
+    auto const prefix = [partitions](int i)
+    {
+        return static_cast <std::uint32_t> (
+            (static_cast <std::uint64_t> (i) << 16) / partitions);
+    };
+    std::uint32_t const lo = prefix (partition);
+    std::uint32_t const hi = prefix (partition + 1) - 1;
+
+    std::pair <uint256, uint256> result;
+    result.first.zero ();
+    result.first.begin ()[0] = static_cast <std::uint8_t> (lo >> 8);
+    result.first.begin ()[1] = static_cast <std::uint8_t> (lo & 0xff);
+    std::fill (result.second.begin (), result.second.end (), 0xff);
+    result.second.begin ()[0] = static_cast <std::uint8_t> (hi >> 8);
+    result.second.begin ()[1] = static_cast <std::uint8_t> (hi & 0xff);
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+// The checkpoint has a header line followed by the number of each
+// finished range on its own line. The file is rewritten on start, which
+// drops a last line that was cut short when the server stopped.
+//
+void
+Importer::loadCheckpoint ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    finished_.assign (setup_.partitions, false);
+    if (setup_.checkpoint.empty ())
+        return;
+
+    std::string const header = "import " +
+        std::to_string (setup_.partitions) + " " + source_.getName ();
+
+    {
+        std::ifstream in (setup_.checkpoint);
+        std::string line;
+        if (std::getline (in, line))
+        {
+            if (line == header)
+            {
+                while (std::getline (in, line) && ! in.eof ())
+                {
+                    std::istringstream is (line);
+                    int i;
+                    if ((is >> i) && is.eof () &&
+                            i >= 0 && i < setup_.partitions)
+                        finished_[i] = true;
+                }
+            }
+            else if (journal_.warning)
+            {
+                journal_.warning <<
+                    "Import checkpoint '" << setup_.checkpoint <<
+                        "' is for another import, starting over";
+            }
+        }
+    }
+
+    checkpoint_.close ();
+    checkpoint_.clear ();
+    checkpoint_.open (setup_.checkpoint, std::ios::trunc);
+    checkpoint_ << header << '\n';
+    for (int i = 0; i < setup_.partitions; ++i)
+        if (finished_[i])
+            checkpoint_ << i << '\n';
+    checkpoint_.flush ();
+    if (! checkpoint_)
+        throw std::runtime_error ("nodestore: can't write import "
+            "checkpoint '" + setup_.checkpoint + "'");
+}
+
+void
+Importer::removeCheckpoint ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    if (! checkpoint_.is_open ())
+        return;
+    checkpoint_.close ();
+    if (std::remove (setup_.checkpoint.c_str ()) != 0 && journal_.warning)
+        journal_.warning <<
+            "Can't remove import checkpoint '" << setup_.checkpoint << "'";
+}
+
+void
+Importer::markFinished (int partition)
+{
+    int n;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        finished_[partition] = true;
+        if (checkpoint_.is_open ())
+            checkpoint_ << partition << std::endl;
+        n = static_cast<int> (
+            std::count (finished_.begin (), finished_.end (), true));
+    }
+
+    if (journal_.debug) journal_.debug <<
+        "Imported range " << partition << ", " << n << " of " <<
+            setup_.partitions << " done, " << objects_ << " objects";
+}
+
+void
+Importer::write (Batch& batch)
+{
+    dest_.storeBatch (batch);
+    objects_ += batch.size ();
+    batch.clear ();
+}
+
+void
+Importer::onError (std::exception const& e)
+{
+    if (journal_.fatal) journal_.fatal <<
+        "Import failed: " << e.what ();
+    error_ = true;
+    stop_ = true;
+}
+
+void
+Importer::copyAll ()
+{
+    beast::Thread::setCurrentThreadName ("import");
+
+    try
+    {
+        Batch batch;
+        batch.reserve (batchWritePreallocationSize);
+
+        source_.for_each ([&](std::shared_ptr<NodeObject> object)
+        {
+            batch.push_back (std::move (object));
+            if (batch.size () >= batchWritePreallocationSize)
+                write (batch);
+        });
+
+        if (! batch.empty ())
+            write (batch);
+
+        for (int i = 0; i < setup_.partitions; ++i)
+            markFinished (i);
+    }
+    catch (std::exception const& e)
+    {
+        onError (e);
+    }
+}
+
+void
+Importer::copyRanges ()
+{
+    beast::Thread::setCurrentThreadName ("import");
+
+    try
+    {
+        while (! stop_)
+        {
+            int const i = next_++;
+            if (i >= setup_.partitions)
+                break;
+
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                if (finished_[i])
+                    continue;
+            }
+
+            if (copyRange (i))
+                markFinished (i);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        onError (e);
+    }
+}
+
+bool
+Importer::copyRange (int partition)
+{
+    auto const keys = range (partition, setup_.partitions);
+
+    Batch batch;
+    batch.reserve (batchWritePreallocationSize);
+
+    bool stopped = false;
+    source_.for_each (keys.first, keys.second,
+        [&](std::shared_ptr<NodeObject> object)
+        {
+            if (stop_)
+            {
+                stopped = true;
+                return false;
+            }
+
+            batch.push_back (std::move (object));
+            if (batch.size () >= batchWritePreallocationSize)
+                write (batch);
+            return true;
+        });
+
+    if (! batch.empty ())
+        write (batch);
+
+    return ! stopped;
+}
+
+//------------------------------------------------------------------------------
+
+Importer::Setup
+setup_Importer (Section const& section)
+{
+    Importer::Setup setup;
+    get_if_exists (section, "threads", setup.threads);
+    get_if_exists (section, "partitions", setup.partitions);
+    get_if_exists (section, "checkpoint", setup.checkpoint);
+    setup.threads = std::max (setup.threads, 1);
+    setup.partitions = std::min (std::max (setup.partitions, 1), 65536);
+    return setup;
+}
+
+}
+}
@@ -21,6 +21,10 @@
 #include <ripple/nodestore/impl/ManagerImp.h>
 #include <ripple/nodestore/impl/DatabaseImp.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.h>
+#include <ripple/nodestore/impl/DatabaseShardImp.h>
+#include <ripple/nodestore/impl/DatabaseTieredImp.h>
+#include <ripple/nodestore/impl/FilteredBackend.h>
+#include <ripple/nodestore/impl/TracingBackend.h>
 #include <ripple/basics/StringUtilities.h>
 #include <beast/utility/ci_char_traits.h>
 #include <beast/cxx14/memory.h> // <memory>
@@ -82,6 +86,30 @@ ManagerImp::make_Backend (
         missing_backend ();
     }
 
+    // Screen fetches for missing objects with a filter of the keys
+    std::string const path (get<std::string>(parameters, "path"));
+    std::uint64_t filterObjects = 0;
+    if (get_if_exists (parameters, "filter_objects", filterObjects) &&
+        filterObjects > 0)
+    {
+        backend = std::make_unique <FilteredBackend> (std::move (backend),
+            filterObjects, path, journal);
+    }
+    else if (! path.empty ())
+    {
+        FilteredBackend::discard (path);
+    }
+
+    // Record what is asked of the backend, for replaying in benchmarks
+    std::string const trace (get<std::string>(parameters, "trace"));
+    if (! trace.empty ())
+    {
+        std::uint64_t traceSize = 1024;
+        get_if_exists (parameters, "trace_size", traceSize);
+        backend = std::make_unique <TracingBackend> (
+            std::move (backend), trace, traceSize * 1024 * 1024);
+    }
+
     return backend;
 }
 
@@ -113,6 +141,31 @@ ManagerImp::make_DatabaseRotating (
             readThreads, writableBackend, archiveBackend, journal);
 }
 
+std::unique_ptr <Database>
+ManagerImp::make_DatabaseTiered (
+        std::string const& name,
+        Scheduler& scheduler,
+        beast::Journal journal,
+        int readThreads,
+        Section const& fastParameters,
+        Section const& slowParameters)
+{
+    return std::make_unique <DatabaseTieredImp> (name, scheduler,
+            readThreads, fastParameters,
+                make_Backend (slowParameters, scheduler, journal), journal);
+}
+
+std::unique_ptr <DatabaseShard>
+ManagerImp::make_DatabaseShard (
+        std::string const& name,
+        Scheduler& scheduler,
+        Section const& parameters,
+        beast::Journal journal)
+{
+    return std::make_unique <DatabaseShardImp> (name, scheduler,
+            parameters, journal);
+}
+
 Factory*
 ManagerImp::find (std::string const& name)
 {
@@ -77,6 +77,22 @@ public:
         std::shared_ptr <Backend> writableBackend,
         std::shared_ptr <Backend> archiveBackend,
         beast::Journal journal) override;
+
+    std::unique_ptr <Database>
+    make_DatabaseTiered (
+        std::string const& name,
+        Scheduler& scheduler,
+        beast::Journal journal,
+        int readThreads,
+        Section const& fastParameters,
+        Section const& slowParameters) override;
+
+    std::unique_ptr <DatabaseShard>
+    make_DatabaseShard (
+        std::string const& name,
+        Scheduler& scheduler,
+        Section const& parameters,
+        beast::Journal journal) override;
 };
 
 }
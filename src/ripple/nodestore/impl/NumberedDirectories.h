@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_NUMBEREDDIRECTORIES_H_INCLUDED
+#define RIPPLE_NODESTORE_NUMBEREDDIRECTORIES_H_INCLUDED
+
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Returns the numbers which name subdirectories of a directory.
+    Other entries are ignored. The numbers are sorted.
+*/
+inline
+std::vector <std::uint32_t>
+numberedDirectories (boost::filesystem::path const& dir)
+{
+    std::vector <std::uint32_t> result;
+    for (auto const& entry : boost::filesystem::directory_iterator (dir))
+    {
+        auto const name = entry.path ().filename ().string ();
+        if (! boost::filesystem::is_directory (entry.status ()) ||
+            name.empty () || name.size () > 10 || ! std::all_of (
+                name.begin (), name.end (), [](unsigned char c)
+                {
+                    return std::isdigit (c);
+                }))
+            continue;
+        auto const n = std::stoull (name);
+        if (n <= std::numeric_limits <std::uint32_t>::max ())
+            result.push_back (static_cast <std::uint32_t> (n));
+    }
+    std::sort (result.begin (), result.end ());
+    return result;
+}
+
+}
+}
+
+#endif
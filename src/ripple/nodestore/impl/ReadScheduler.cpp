@@ -0,0 +1,225 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/ReadScheduler.h>
+#include <beast/threads/Thread.h>
+#include <cassert>
+
+namespace ripple {
+namespace NodeStore {
+
+ReadScheduler::ReadScheduler (int threads, Handler handler)
+    : handler_ (std::move (handler))
+{
+    threads_.reserve (threads);
+    for (int i = 0; i < threads; ++i)
+        threads_.emplace_back (&ReadScheduler::run, this);
+}
+
+ReadScheduler::~ReadScheduler ()
+{
+    stop ();
+}
+
+void
+ReadScheduler::stop ()
+{
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        stop_ = true;
+        workCond_.notify_all ();
+        doneCond_.notify_all ();
+    }
+
+    for (auto& t : threads_)
+        t.join ();
+    threads_.clear ();
+}
+
+void
+ReadScheduler::post (uint256 const& hash, ReadPriority priority)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    post (hash, priority, nullptr);
+}
+
+void
+ReadScheduler::postAndWait (
+    std::vector <uint256> const& hashes, ReadPriority priority)
+{
+    auto const group = std::make_shared <Group> ();
+
+    std::unique_lock <std::mutex> lock (mutex_);
+    for (auto const& hash : hashes)
+        post (hash, priority, group);
+    waitFor (lock, group);
+}
+
+void
+ReadScheduler::wait ()
+{
+    auto const group = std::make_shared <Group> ();
+
+    std::unique_lock <std::mutex> lock (mutex_);
+    for (auto& queue : queues_)
+    {
+        for (auto& e : queue)
+        {
+            e.second.groups.push_back (group);
+            ++group->pending;
+        }
+    }
+    for (auto request : active_)
+    {
+        request->groups.push_back (group);
+        ++group->pending;
+    }
+    waitFor (lock, group);
+}
+
+std::size_t
+ReadScheduler::size (ReadPriority priority) const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return queues_[priority].size ();
+}
+
+std::size_t
+ReadScheduler::size () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return waiting ();
+}
+
+//------------------------------------------------------------------------------
+
+void
+ReadScheduler::post (uint256 const& hash, ReadPriority priority,
+    std::shared_ptr <Group> const& group)
+{
+    assert (priority >= 0 && priority < readPriorities);
+
+    Request* request = nullptr;
+
+    for (int i = 0; i < readPriorities; ++i)
+    {
+        auto const iter = queues_[i].find (hash);
+        if (iter == queues_[i].end ())
+            continue;
+
+        if (i <= priority)
+        {
+            // Already queued at the same or a more urgent priority
+            request = &iter->second;
+        }
+        else
+        {
+            // Promote it
+            request = &queues_[priority].emplace (
+                hash, std::move (iter->second)).first->second;
+            queues_[i].erase (iter);
+        }
+        break;
+    }
+
+    if (! request)
+    {
+        request = &queues_[priority][hash];
+        request->posted = clock_type::now ();
+        workCond_.notify_one ();
+    }
+
+    if (group)
+    {
+        request->groups.push_back (group);
+        ++group->pending;
+    }
+}
+
+void
+ReadScheduler::waitFor (std::unique_lock <std::mutex>& lock,
+    std::shared_ptr <Group> const& group)
+{
+    while (! stop_ && group->pending != 0)
+        doneCond_.wait (lock);
+}
+
+std::size_t
+ReadScheduler::waiting () const
+{
+    std::size_t n = 0;
+    for (auto const& queue : queues_)
+        n += queue.size ();
+    return n;
+}
+
+// Entry point for async read threads
+void
+ReadScheduler::run ()
+{
+    beast::Thread::setCurrentThreadName ("prefetch");
+
+    std::unique_lock <std::mutex> lock (mutex_);
+    for (;;)
+    {
+        while (! stop_ && waiting () == 0)
+            workCond_.wait (lock);
+
+        if (stop_)
+            break;
+
+        int priority = 0;
+        while (queues_[priority].empty ())
+            ++priority;
+
+        // Read in key order to make the back end more efficient
+        auto& queue = queues_[priority];
+        auto iter = queue.upper_bound (last_[priority]);
+        if (iter == queue.end ())
+            iter = queue.begin ();
+
+        uint256 const hash = iter->first;
+        Request request = std::move (iter->second);
+        queue.erase (iter);
+        last_[priority] = hash;
+        active_.insert (&request);
+
+        FetchReport report;
+        report.isAsync = true;
+        report.priority = static_cast<ReadPriority> (priority);
+        report.queued = std::chrono::duration_cast <std::chrono::milliseconds> (
+            clock_type::now () - request.posted);
+        report.queueDepth = waiting ();
+
+        lock.unlock ();
+        handler_ (hash, report);
+        lock.lock ();
+
+        active_.erase (&request);
+        for (auto const& group : request.groups)
+        {
+            if (--group->pending == 0)
+                doneCond_.notify_all ();
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_READSCHEDULER_H_INCLUDED
+#define RIPPLE_NODESTORE_READSCHEDULER_H_INCLUDED
+
+#include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/Types.h>
+#include <ripple/basics/base_uint.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Performs queued reads on a pool of threads.
+
+    Each priority class has its own queue. A thread always takes its next
+    read from the most urgent class which has work, and within a class reads
+    are handed out in key order to make the back end more efficient.
+
+    Posting a key which is already queued does not queue a second read. If
+    the new priority is more urgent, the read moves to the more urgent class.
+*/
+class ReadScheduler
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    /** Called on a pool thread to perform a read.
+        The report has isAsync, priority, queued and queueDepth filled in.
+    */
+    using Handler = std::function <void (uint256 const&, FetchReport const&)>;
+
+    ReadScheduler (int threads, Handler handler);
+
+    ~ReadScheduler ();
+
+    ReadScheduler (ReadScheduler const&) = delete;
+    ReadScheduler& operator= (ReadScheduler const&) = delete;
+
+    /** Stop and join the threads.
+        Reads still queued are not performed, and callers waiting for
+        reads return. Calling this more than once has no effect.
+    */
+    void
+    stop ();
+
+    /** Queue a read. */
+    void
+    post (uint256 const& hash, ReadPriority priority);
+
+    /** Queue reads and wait until they have all been performed. */
+    void
+    postAndWait (std::vector <uint256> const& hashes, ReadPriority priority);
+
+    /** Wait until every read queued or in progress has been performed. */
+    void
+    wait ();
+
+    /** Returns the number of reads waiting in a class. */
+    std::size_t
+    size (ReadPriority priority) const;
+
+    /** Returns the number of reads waiting in all classes. */
+    std::size_t
+    size () const;
+
+    /** Returns the number of pool threads. */
+    int
+    threads () const
+    {
+        return static_cast<int> (threads_.size ());
+    }
+
+private:
+    // Callers waiting for a set of reads
+    struct Group
+    {
+        std::size_t pending = 0;
+    };
+
+    struct Request
+    {
+        clock_type::time_point posted;
+        std::vector <std::shared_ptr <Group>> groups;
+    };
+
+    using Queue = std::map <uint256, Request>;
+
+    void
+    post (uint256 const& hash, ReadPriority priority,
+        std::shared_ptr <Group> const& group);
+
+    void
+    waitFor (std::unique_lock <std::mutex>& lock,
+        std::shared_ptr <Group> const& group);
+
+    std::size_t
+    waiting () const;
+
+    void
+    run ();
+
+    Handler handler_;
+
+    std::mutex mutable mutex_;
+    std::condition_variable workCond_;  // Reads queued, or stopping
+    std::condition_variable doneCond_;  // A group finished
+    std::array <Queue, readPriorities> queues_;
+    std::array <uint256, readPriorities> last_; // Last key read per class
+    std::set <Request*> active_;        // Reads in progress
+    bool stop_ = false;
+
+    std::vector <std::thread> threads_;
+};
+
+}
+}
+
+#endif
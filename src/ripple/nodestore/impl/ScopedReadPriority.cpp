@@ -0,0 +1,56 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/nodestore/ScopedReadPriority.h>
+#include <boost/thread/tss.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+static
+void
+cleanup (ScopedReadPriority*)
+{
+}
+
+static
+boost::thread_specific_ptr<ScopedReadPriority> scopedReadPriorityPtr (&cleanup);
+
+ScopedReadPriority::ScopedReadPriority (ReadPriority priority)
+    : prev_ (scopedReadPriorityPtr.get ())
+    , priority_ (priority)
+{
+    scopedReadPriorityPtr.reset (this);
+}
+
+ScopedReadPriority::~ScopedReadPriority ()
+{
+    scopedReadPriorityPtr.reset (prev_);
+}
+
+ReadPriority
+ScopedReadPriority::get ()
+{
+    if (auto const p = scopedReadPriorityPtr.get ())
+        return p->priority_;
+    return readNormal;
+}
+
+}
+}
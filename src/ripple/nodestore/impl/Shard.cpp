@@ -0,0 +1,270 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/Shard.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/utility/ci_char_traits.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <cassert>
+#include <sstream>
+
+namespace ripple {
+namespace NodeStore {
+
+Shard::Shard (std::uint32_t index, std::uint32_t ledgersPerShard,
+        boost::filesystem::path const& dir, Section const& parameters,
+            bool compact, Scheduler& scheduler, beast::Journal journal)
+    : index_ (index)
+    , ledgersPerShard_ (ledgersPerShard)
+    , firstSeq_ (index * ledgersPerShard + 1)
+    , dir_ (dir)
+    , parameters_ (parameters)
+    , compact_ (compact)
+    , scheduler_ (scheduler)
+    , journal_ (journal)
+{
+    assert (ledgersPerShard_ > 0);
+
+    boost::filesystem::create_directories (dir_);
+
+    // A Mapped backend is sealed when closed, so it only
+    // ever holds a complete shard.
+    auto const type = boost::algorithm::to_lower_copy (
+        get<std::string>(parameters_, "type"));
+    assert (type != "mapped");
+    auto const mappedDir = dir_ / "mapped";
+    if (boost::filesystem::exists (mappedDir / "mapped.key"))
+    {
+        // The server stopped before the old backend was removed
+        boost::filesystem::remove_all (dir_ / type);
+        backend_ = makeBackend ("mapped");
+        compacted_ = true;
+    }
+    else
+    {
+        // The server stopped in the middle of compacting
+        boost::filesystem::remove_all (mappedDir);
+        backend_ = makeBackend (type);
+    }
+
+    // The control file is rewritten on open, which drops a last
+    // line that was cut short when the server stopped.
+    std::string const header = "shard " + std::to_string (index_) +
+        " " + std::to_string (ledgersPerShard_);
+    auto const controlPath = (dir_ / "control.txt").string ();
+
+    stored_.assign (ledgersPerShard_, false);
+    {
+        std::ifstream in (controlPath);
+        std::string line;
+        if (std::getline (in, line))
+        {
+            if (line != header)
+                throw std::runtime_error ("nodestore: shard '" +
+                    dir_.string () + "' was made with other settings");
+
+            while (std::getline (in, line) && ! in.eof ())
+            {
+                std::istringstream is (line);
+                std::uint32_t seq;
+                if ((is >> seq) && is.eof () &&
+                    seq >= firstSeq () && seq <= lastSeq () &&
+                        ! stored_[seq - firstSeq_])
+                {
+                    stored_[seq - firstSeq_] = true;
+                    ++storedCount_;
+                }
+            }
+        }
+    }
+
+    control_.open (controlPath, std::ios::trunc);
+    control_ << header << '\n';
+    for (std::uint32_t i = 0; i < ledgersPerShard_; ++i)
+        if (stored_[i])
+            control_ << (firstSeq_ + i) << '\n';
+    control_.flush ();
+    if (! control_)
+        throw std::runtime_error ("nodestore: can't write '" +
+            controlPath + "'");
+
+    if (complete () && compact_ && ! compacted_)
+        finalize ();
+}
+
+Shard::~Shard ()
+{
+    std::unique_lock <std::mutex> lock (mutex_);
+    finalized_.wait (lock, [this] { return ! finalizing_; });
+}
+
+bool
+Shard::complete () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return storedCount_ == ledgersPerShard_;
+}
+
+bool
+Shard::hasLedger (std::uint32_t seq) const
+{
+    if (seq < firstSeq () || seq > lastSeq ())
+        return false;
+    std::lock_guard <std::mutex> lock (mutex_);
+    return stored_[seq - firstSeq_];
+}
+
+std::shared_ptr <Backend>
+Shard::backend () const
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    return backend_;
+}
+
+bool
+Shard::setStored (std::uint32_t seq)
+{
+    assert (seq >= firstSeq () && seq <= lastSeq ());
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    if (stored_[seq - firstSeq_])
+        return false;
+    stored_[seq - firstSeq_] = true;
+    ++storedCount_;
+    control_ << seq << std::endl;
+    return storedCount_ == ledgersPerShard_;
+}
+
+void
+Shard::finalize ()
+{
+    assert (complete ());
+
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        if (finalizing_)
+            return;
+        finalizing_ = true;
+    }
+    scheduler_.scheduleTask (*this);
+}
+
+void
+Shard::performScheduledTask ()
+{
+    try
+    {
+        if (auto const backend = this->backend ())
+            backend->verify ();
+
+        if (journal_.info) journal_.info <<
+            "Shard " << index_ << " with ledgers " << firstSeq () <<
+                " to " << lastSeq () << " is complete";
+
+        if (compact_ && ! compacted_)
+            compact ();
+    }
+    catch (std::exception const& e)
+    {
+        if (journal_.error) journal_.error <<
+            "Shard " << index_ << " could not be finalized: " << e.what ();
+    }
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    finalizing_ = false;
+    finalized_.notify_all ();
+}
+
+void
+Shard::close ()
+{
+    std::unique_lock <std::mutex> lock (mutex_);
+    finalized_.wait (lock, [this] { return ! finalizing_; });
+    if (backend_)
+        backend_->close ();
+    control_.close ();
+}
+
+std::shared_ptr <Backend>
+Shard::makeBackend (std::string const& type)
+{
+    Section parameters (parameters_);
+    parameters.set ("type", type);
+    parameters.set ("path", (dir_ / type).string ());
+    return Manager::instance().make_Backend (
+        parameters, scheduler_, journal_);
+}
+
+// The shard can't be read while it is copied, since a backend
+// which visits all its objects can't be used at the same time.
+void
+Shard::compact ()
+{
+    std::shared_ptr <Backend> source;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        source.swap (backend_);
+    }
+
+    std::uint64_t objects = 0;
+    try
+    {
+        auto dest = makeBackend ("mapped");
+        Batch batch;
+        batch.reserve (batchWritePreallocationSize);
+        source->for_each ([&](std::shared_ptr<NodeObject> object)
+        {
+            batch.push_back (std::move (object));
+            if (batch.size () >= batchWritePreallocationSize)
+            {
+                dest->storeBatch (batch);
+                objects += batch.size ();
+                batch.clear ();
+            }
+        });
+        dest->storeBatch (batch);
+        objects += batch.size ();
+
+        // Closing seals it
+        dest->close ();
+    }
+    catch (...)
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        backend_ = std::move (source);
+        throw;
+    }
+
+    auto mapped = makeBackend ("mapped");
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        backend_ = std::move (mapped);
+        compacted_ = true;
+    }
+
+    source->setDeletePath ();
+    source->close ();
+
+    if (journal_.info) journal_.info <<
+        "Shard " << index_ << " compacted, " << objects << " objects";
+}
+
+}
+}
@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_SHARD_H_INCLUDED
+#define RIPPLE_NODESTORE_SHARD_H_INCLUDED
+
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/Scheduler.h>
+#include <ripple/basics/BasicConfig.h>
+#include <beast/utility/Journal.h>
+#include <boost/filesystem.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** The objects of a range of ledgers, in a backend of their own.
+
+    A shard lives in a directory named after its index. The backend is
+    in a subdirectory named after its type, and control.txt records
+    which of the ledgers have been stored, one sequence number a line.
+    When the last ledger is stored the backend is verified, and may be
+    copied into a Mapped backend in the 'mapped' subdirectory, which
+    then replaces it. This is done as a scheduled task.
+*/
+class Shard
+    : private Task
+{
+public:
+    /** Open or create a shard.
+
+        @param parameters The backend parameters. The path is ignored.
+        @param compact Whether to copy a complete shard into a Mapped
+                       backend.
+    */
+    Shard (std::uint32_t index, std::uint32_t ledgersPerShard,
+        boost::filesystem::path const& dir, Section const& parameters,
+            bool compact, Scheduler& scheduler, beast::Journal journal);
+
+    ~Shard ();
+
+    Shard (Shard const&) = delete;
+    Shard& operator= (Shard const&) = delete;
+
+    std::uint32_t
+    index () const
+    {
+        return index_;
+    }
+
+    /** Returns the sequence of the first ledger in the shard. */
+    std::uint32_t
+    firstSeq () const
+    {
+        return firstSeq_;
+    }
+
+    /** Returns the sequence of the last ledger in the shard. */
+    std::uint32_t
+    lastSeq () const
+    {
+        return firstSeq_ + ledgersPerShard_ - 1;
+    }
+
+    bool
+    complete () const;
+
+    bool
+    hasLedger (std::uint32_t seq) const;
+
+    /** Returns the backend holding the objects.
+        A compacted shard swaps its backend, so callers hold a reference.
+    */
+    std::shared_ptr <Backend>
+    backend () const;
+
+    /** Record that a ledger has been stored.
+        @return `true` if this completed the shard.
+    */
+    bool
+    setStored (std::uint32_t seq);
+
+    /** Schedule verifying the backend of a complete shard,
+        and compacting it.
+    */
+    void
+    finalize ();
+
+    /** Close the backend, once a scheduled finalize is done. */
+    void
+    close ();
+
+private:
+    void
+    performScheduledTask () override;
+
+    std::shared_ptr <Backend>
+    makeBackend (std::string const& type);
+
+    void
+    compact ();
+
+    std::uint32_t const index_;
+    std::uint32_t const ledgersPerShard_;
+    std::uint32_t const firstSeq_;
+    boost::filesystem::path const dir_;
+    Section const parameters_;
+    bool const compact_;
+    Scheduler& scheduler_;
+    beast::Journal journal_;
+
+    std::mutex mutable mutex_;
+    std::shared_ptr <Backend> backend_;
+    std::vector <bool> stored_;
+    std::uint32_t storedCount_ = 0;
+    std::ofstream control_;
+    bool compacted_ = false;
+    bool finalizing_ = false;
+    std::condition_variable finalized_;
+};
+
+}
+}
+
+#endif
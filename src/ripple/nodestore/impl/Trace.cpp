@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/Trace.h>
+#include <beast/ByteOrder.h>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+static char const traceSignature[] = "RIPLTRC1";
+
+enum
+{
+    signatureBytes = 8,
+
+    // Records are written when this many bytes are buffered
+    traceBufferBytes = 64 * 1024
+};
+
+std::shared_ptr <TraceWriter>
+TraceWriter::open (std::string const& path, std::uint64_t limit)
+{
+    static std::mutex mutex;
+    static std::map <std::string, std::weak_ptr <TraceWriter>> writers;
+
+    std::lock_guard <std::mutex> lock (mutex);
+    auto& entry = writers[path];
+    auto writer = entry.lock ();
+    if (! writer)
+    {
+        writer.reset (new TraceWriter (path, limit));
+        entry = writer;
+    }
+    return writer;
+}
+
+TraceWriter::TraceWriter (std::string const& path, std::uint64_t limit)
+    : path_ (path)
+    , limit_ (limit)
+{
+    bool append = false;
+    {
+        std::ifstream in (path_, std::ios::binary);
+        char signature[signatureBytes];
+        if (in.read (signature, signatureBytes) &&
+                std::memcmp (signature, traceSignature, signatureBytes) == 0)
+            append = true;
+    }
+
+    out_.open (path_, std::ios::binary |
+        (append ? std::ios::app : std::ios::trunc));
+    if (append)
+    {
+        boost::system::error_code ec;
+        size_ = boost::filesystem::file_size (path_, ec);
+    }
+    else
+    {
+        out_.write (traceSignature, signatureBytes);
+        size_ = signatureBytes;
+    }
+    if (! out_)
+        throw std::runtime_error (
+            "nodestore: can't write trace '" + path_ + "'");
+    buffer_.reserve (traceBufferBytes);
+}
+
+TraceWriter::~TraceWriter ()
+{
+    write ();
+}
+
+void
+TraceWriter::append (TraceRecord::Op op, NodeObjectType type,
+    std::size_t size, void const* key)
+{
+    std::uint8_t record[recordBytes];
+    record[0] = op;
+    record[1] = static_cast <std::uint8_t> (type);
+    std::uint32_t const n = beast::ByteOrder::swapIfLittleEndian (
+        static_cast <std::uint32_t> (size));
+    std::memcpy (record + 2, &n, 4);
+    std::memcpy (record + 6, key, 32);
+
+    std::lock_guard <std::mutex> lock (mutex_);
+    if (stopped_)
+        return;
+    buffer_.insert (buffer_.end (), record, record + recordBytes);
+    if (buffer_.size () >= traceBufferBytes)
+        write ();
+}
+
+void
+TraceWriter::flush ()
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+    write ();
+    out_.flush ();
+}
+
+void
+TraceWriter::write ()
+{
+    if (buffer_.empty ())
+        return;
+    out_.write (reinterpret_cast <char const*> (buffer_.data ()),
+        buffer_.size ());
+    size_ += buffer_.size ();
+    buffer_.clear ();
+
+    if (limit_ > 0 && size_ >= limit_)
+        rotate ();
+}
+
+void
+TraceWriter::rotate ()
+{
+    out_.close ();
+
+    // Replaces the trace renamed before
+    boost::system::error_code ec;
+    boost::filesystem::rename (path_, path_ + ".1", ec);
+    if (ec)
+    {
+        stopped_ = true;
+        return;
+    }
+
+    out_.open (path_, std::ios::binary | std::ios::trunc);
+    out_.write (traceSignature, signatureBytes);
+    size_ = signatureBytes;
+    if (! out_)
+        stopped_ = true;
+}
+
+//------------------------------------------------------------------------------
+
+TraceReader::TraceReader (std::string const& path)
+    : in_ (path, std::ios::binary)
+{
+    char signature[signatureBytes];
+    if (! in_.read (signature, signatureBytes) ||
+            std::memcmp (signature, traceSignature, signatureBytes) != 0)
+        throw std::runtime_error (
+            "nodestore: '" + path + "' is not a trace");
+}
+
+bool
+TraceReader::next (TraceRecord& record)
+{
+    std::uint8_t buf[TraceWriter::recordBytes];
+    if (! in_.read (reinterpret_cast <char*> (buf), sizeof (buf)))
+        return false;
+    record.op = static_cast <TraceRecord::Op> (buf[0]);
+    record.type = static_cast <NodeObjectType> (buf[1]);
+    record.size = beast::ByteOrder::bigEndianInt (buf + 2);
+    record.key = uint256::fromVoid (buf + 6);
+    return true;
+}
+
+}
+}
@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/TracingBackend.h>
+
+namespace ripple {
+namespace NodeStore {
+
+TracingBackend::TracingBackend (std::unique_ptr <Backend> backend,
+        std::string const& path, std::uint64_t limit)
+    : backend_ (std::move (backend))
+    , trace_ (TraceWriter::open (path, limit))
+{
+}
+
+void
+TracingBackend::close ()
+{
+    trace_->flush ();
+    backend_->close ();
+}
+
+void
+TracingBackend::onFetch (void const* key,
+    std::shared_ptr<NodeObject> const& object)
+{
+    if (object)
+        trace_->append (TraceRecord::fetch, object->getType (),
+            object->getData ().size (), key);
+    else
+        trace_->append (TraceRecord::miss, hotUNKNOWN, 0, key);
+}
+
+Status
+TracingBackend::fetch (void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    Status const status = backend_->fetch (key, pObject);
+    onFetch (key, status == ok ? *pObject : nullptr);
+    return status;
+}
+
+Status
+TracingBackend::fetchPayload (void const* key, FetchCallback const& f)
+{
+    bool found = false;
+    Status const status = backend_->fetchPayload (key,
+        [&](NodeObjectType type, void const* data, std::size_t size)
+        {
+            found = true;
+            trace_->append (TraceRecord::fetch, type, size, key);
+            f (type, data, size);
+        });
+    if (! found)
+        trace_->append (TraceRecord::miss, hotUNKNOWN, 0, key);
+    return status;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+TracingBackend::fetchBatch (std::size_t n, void const* const* keys)
+{
+    auto objects = backend_->fetchBatch (n, keys);
+    for (std::size_t i = 0; i < n; ++i)
+        onFetch (keys[i], objects[i]);
+    return objects;
+}
+
+void
+TracingBackend::store (std::shared_ptr<NodeObject> const& object)
+{
+    trace_->append (TraceRecord::store, object->getType (),
+        object->getData ().size (), object->getHash ().data ());
+    backend_->store (object);
+}
+
+void
+TracingBackend::storeBatch (Batch const& batch)
+{
+    for (auto const& object : batch)
+        trace_->append (TraceRecord::store, object->getType (),
+            object->getData ().size (), object->getHash ().data ());
+    backend_->storeBatch (batch);
+}
+
+}
+}
@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_TRACINGBACKEND_H_INCLUDED
+#define RIPPLE_NODESTORE_TRACINGBACKEND_H_INCLUDED
+
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/Trace.h>
+#include <memory>
+#include <string>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A backend which records the operations made on it in a trace.
+
+    Each fetch, including each key of a batch fetch, and each store is
+    appended to the trace, which a benchmark can replay against any
+    backend.
+
+    @see TraceWriter
+*/
+class TracingBackend
+    : public Backend
+{
+public:
+    /** Create the tracing for a backend.
+        @param limit The size at which the trace file is renamed.
+        @see TraceWriter::open
+    */
+    TracingBackend (std::unique_ptr <Backend> backend,
+        std::string const& path, std::uint64_t limit);
+
+    std::string
+    getName () override
+    {
+        return backend_->getName ();
+    }
+
+    void
+    close () override;
+
+    Status
+    fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    Status
+    fetchPayload (void const* key, FetchCallback const& f) override;
+
+    bool
+    canFetchBatch () override
+    {
+        return backend_->canFetchBatch ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::size_t n, void const* const* keys) override;
+
+    void
+    store (std::shared_ptr<NodeObject> const& object) override;
+
+    void
+    storeBatch (Batch const& batch) override;
+
+    void
+    for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each (f);
+    }
+
+    bool
+    canVisitRange () override
+    {
+        return backend_->canVisitRange ();
+    }
+
+    void
+    for_each (uint256 const& first, uint256 const& last,
+        std::function <bool (std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each (first, last, f);
+    }
+
+    int
+    getWriteLoad () override
+    {
+        return backend_->getWriteLoad ();
+    }
+
+    FilterCounts
+    getFilterCounts () override
+    {
+        return backend_->getFilterCounts ();
+    }
+
+    void
+    setDeletePath () override
+    {
+        backend_->setDeletePath ();
+    }
+
+    void
+    verify () override
+    {
+        backend_->verify ();
+    }
+
+private:
+    void
+    onFetch (void const* key, std::shared_ptr<NodeObject> const& object);
+
+    std::unique_ptr <Backend> backend_;
+    std::shared_ptr <TraceWriter> trace_;
+};
+
+}
+}
+
+#endif
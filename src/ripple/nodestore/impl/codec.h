@@ -21,19 +21,56 @@
 #define RIPPLE_NODESTORE_CODEC_H_INCLUDED
 
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/dictionary.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <beast/nudb/common.h>
 #include <beast/nudb/detail/field.h>
 #include <beast/nudb/detail/varint.h>
 #include <lz4/lib/lz4.h>
 #include <snappy.h>
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
+#include <memory>
+#include <string>
 #include <utility>
 
 namespace ripple {
 namespace NodeStore {
 
+/** How nodeobject_codec stores values.
+
+    none        Values are stored as they are.
+    lz4         Inner nodes are compacted, other values use lz4.
+    dictionary  Like lz4, using a trained codec_dictionary.
+*/
+enum class nodeobject_compression
+{
+    none,
+    lz4,
+    dictionary
+};
+
+/** Parse a compression name.
+
+    @return `false` if the name is not recognized.
+*/
+template <class = void>
+bool
+parse_compression (std::string const& name,
+    nodeobject_compression& type)
+{
+    if (name == "none")
+        type = nodeobject_compression::none;
+    else if (name == "lz4")
+        type = nodeobject_compression::lz4;
+    else if (name == "dictionary")
+        type = nodeobject_compression::dictionary;
+    else
+        return false;
+    return true;
+}
+
 namespace detail {
 
 template <class BufferFactory>
@@ -129,6 +166,89 @@ lz4_compress (void const* in,
     return result;
 }
 
+// Dictionary compressed data is the dictionary id,
+// the uncompressed size and an lz4 block.
+//
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+lz4_dict_decompress (void const* in, std::size_t in_size,
+    codec_dictionary const* dict, BufferFactory&& bf)
+{
+    using beast::nudb::codec_error;
+    using namespace beast::nudb::detail;
+    auto const hs = field<std::uint32_t>::size;
+    if (in_size < hs)
+        throw codec_error(
+            "lz4 dictionary decompress");
+    istream is(in, hs);
+    std::uint32_t id;
+    read<std::uint32_t>(is, id);
+    if (! dict || dict->id() != id)
+        throw codec_error(
+            "nodeobject codec: unknown dictionary");
+    std::uint8_t const* p = reinterpret_cast<
+        std::uint8_t const*>(in) + hs;
+    in_size -= hs;
+    std::pair<void const*, std::size_t> result;
+    auto const n = read_varint(
+        p, in_size, result.second);
+    if (n == 0)
+        throw codec_error(
+            "lz4 dictionary decompress");
+    void* const out = bf(result.second);
+    result.first = out;
+    if (LZ4_decompress_safe_usingDict(
+        reinterpret_cast<char const*>(p) + n,
+            reinterpret_cast<char*>(out),
+                static_cast<int>(in_size - n),
+                    static_cast<int>(result.second),
+                        dict->data(), static_cast<int>(
+                            dict->size())) !=
+                                static_cast<int>(result.second))
+        throw codec_error(
+            "lz4 dictionary decompress");
+    return result;
+}
+
+// Writes the compressed form of in to out, which must hold
+// lz4_dict_bound(in_size) bytes, and returns the size written.
+//
+template <class = void>
+std::size_t
+lz4_dict_compress (void const* in, std::size_t in_size,
+    codec_dictionary const& dict, std::uint8_t* out)
+{
+    using beast::nudb::codec_error;
+    using namespace beast::nudb::detail;
+    auto const hs = field<std::uint32_t>::size;
+    {
+        ostream os(out, hs);
+        write<std::uint32_t>(os, dict.id());
+    }
+    auto const n = write_varint(
+        out + hs, in_size);
+    LZ4_stream_t stream = dict.stream();
+    auto const out_size = LZ4_compress_fast_continue(
+        &stream, reinterpret_cast<char const*>(in),
+            reinterpret_cast<char*>(out + hs + n),
+                static_cast<int>(in_size),
+                    LZ4_compressBound(in_size), 1);
+    if (out_size == 0)
+        throw codec_error(
+            "lz4 dictionary compress");
+    return hs + n + out_size;
+}
+
+inline
+std::size_t
+lz4_dict_bound (std::size_t in_size)
+{
+    using namespace beast::nudb::detail;
+    return field<std::uint32_t>::size +
+        varint_traits<std::size_t>::max +
+            LZ4_compressBound(in_size);
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -138,12 +258,14 @@ lz4_compress (void const* in,
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = lz4 compressed with a dictionary
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
 nodeobject_decompress (void const* in,
-    std::size_t in_size, BufferFactory&& bf)
+    std::size_t in_size, BufferFactory&& bf,
+        codec_dictionary const* dict = nullptr)
 {
     using beast::nudb::codec_error;
     using namespace beast::nudb::detail;
@@ -234,6 +356,12 @@ nodeobject_decompress (void const* in,
         write(os, is(512), 512);
         break;
     }
+    case 4: // lz4 with dictionary
+    {
+        result = lz4_dict_decompress(
+            p, in_size, dict, bf);
+        break;
+    }
     default:
         throw codec_error(
             "nodeobject codec: bad type=" +
@@ -259,14 +387,29 @@ zero32()
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
 nodeobject_compress (void const* in,
-    std::size_t in_size, BufferFactory&& bf)
+    std::size_t in_size, BufferFactory&& bf,
+        nodeobject_compression compression =
+            nodeobject_compression::lz4,
+                codec_dictionary const* dict = nullptr)
 {
     using beast::nudb::codec_error;
     using namespace beast::nudb::detail;
 
-    std::size_t type = 1;
+    std::size_t type;
+    switch (compression)
+    {
+    case nodeobject_compression::none:
+        type = 0;
+        break;
+    case nodeobject_compression::dictionary:
+        type = dict ? 4 : 1;
+        break;
+    default:
+        type = 1;
+        break;
+    }
     // Check for inner node
-    if (in_size == 525)
+    if (type != 0 && in_size == 525)
     {
         istream is(in, in_size);
         std::uint32_t index;
@@ -365,6 +508,25 @@ nodeobject_compress (void const* in,
         result.second = vn + lzr.second;
         break;
     }
+    case 4: // lz4 with dictionary
+    {
+        // Values the dictionary doesn't help are stored uncompressed
+        std::uint8_t* p = reinterpret_cast<
+            std::uint8_t*>(bf(vn + std::max(
+                in_size, lz4_dict_bound(in_size))));
+        result.first = p;
+        result.second = vn + lz4_dict_compress(
+            in, in_size, *dict, p + vn);
+        if (result.second < vn + in_size)
+        {
+            std::memcpy(p, vi.data(), vn);
+            break;
+        }
+        auto const n = write_varint(p, 0U);
+        std::memcpy(p + n, in, in_size);
+        result.second = n + in_size;
+        break;
+    }
     default:
         throw std::logic_error(
             "nodeobject codec: unknown=" +
@@ -474,12 +636,33 @@ public:
     }
 };
 
+/** Codec for node objects.
+
+    Values written with any compression can be read back by any
+    nodeobject_codec, except that values compressed with a dictionary
+    need a codec holding that same dictionary.
+*/
 class nodeobject_codec
 {
+private:
+    nodeobject_compression compression_ =
+        nodeobject_compression::lz4;
+    std::shared_ptr<codec_dictionary const> dict_;
+
 public:
-    template <class... Args>
+    nodeobject_codec() = default;
+
+    /** Create a codec.
+
+        @param compression How values are compressed.
+        @param dict The dictionary, or nullptr. If compression is
+                    dictionary and there is no dictionary, lz4 is used.
+    */
     explicit
-    nodeobject_codec(Args&&... args)
+    nodeobject_codec (nodeobject_compression compression,
+        std::shared_ptr<codec_dictionary const> dict = nullptr)
+        : compression_ (compression)
+        , dict_ (std::move(dict))
     {
     }
 
@@ -489,13 +672,25 @@ public:
         return "nodeobject";
     }
 
+    nodeobject_compression
+    compression() const
+    {
+        return compression_;
+    }
+
+    std::shared_ptr<codec_dictionary const> const&
+    dictionary() const
+    {
+        return dict_;
+    }
+
     template <class BufferFactory>
     std::pair<void const*, std::size_t>
     decompress (void const* in,
         std::size_t in_size, BufferFactory&& bf) const
     {
         return detail::nodeobject_decompress(
-            in, in_size, bf);
+            in, in_size, bf, dict_.get());
     }
 
     template <class BufferFactory>
@@ -504,7 +699,7 @@ public:
         std::size_t in_size, BufferFactory&& bf) const
     {
         return detail::nodeobject_compress(
-            in, in_size, bf);
+            in, in_size, bf, compression_, dict_.get());
     }
 };
 
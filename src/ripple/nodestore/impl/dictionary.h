@@ -0,0 +1,296 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_DICTIONARY_H_INCLUDED
+#define RIPPLE_NODESTORE_DICTIONARY_H_INCLUDED
+
+#include <beast/hash/xxhasher.h>
+#include <lz4/lib/lz4.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A compression dictionary for node objects.
+
+    The dictionary is a block of bytes which the compressor treats as
+    if it came right before each value, so a value may be encoded as
+    references into the dictionary. Node objects repeat the same
+    ledger entry fields, flags and account IDs, which a dictionary
+    trained on a sample of the store captures.
+
+    LZ4 looks back at most 64KB, so only the last 64KB are kept.
+*/
+class codec_dictionary
+{
+public:
+    enum
+    {
+        max_size = 64 * 1024
+    };
+
+private:
+    std::vector<char> data_;
+    std::uint32_t id_;
+    LZ4_stream_t stream_;
+
+public:
+    codec_dictionary (codec_dictionary const&) = delete;
+    codec_dictionary& operator= (codec_dictionary const&) = delete;
+
+    codec_dictionary (void const* data, std::size_t size)
+    {
+        if (size == 0)
+            throw std::runtime_error(
+                "nodestore: empty dictionary");
+        auto const p = reinterpret_cast<char const*>(data);
+        auto const n = std::min<std::size_t>(size, max_size);
+        data_.assign(p + size - n, p + size);
+        beast::xxhasher h;
+        h(data_.data(), data_.size());
+        id_ = static_cast<std::uint32_t>(
+            static_cast<std::size_t>(h));
+        LZ4_resetStream(&stream_);
+        LZ4_loadDict(&stream_, data_.data(),
+            static_cast<int>(data_.size()));
+    }
+
+    /** Identifies the dictionary in compressed values. */
+    std::uint32_t
+    id() const
+    {
+        return id_;
+    }
+
+    char const*
+    data() const
+    {
+        return data_.data();
+    }
+
+    std::size_t
+    size() const
+    {
+        return data_.size();
+    }
+
+    /** Returns an LZ4 stream with the dictionary loaded.
+
+        Compressing updates the stream, so each value is compressed
+        with a copy. This avoids hashing the dictionary every time.
+    */
+    LZ4_stream_t const&
+    stream() const
+    {
+        return stream_;
+    }
+};
+
+/** Returns the dictionary stored in a file.
+
+    @return nullptr if the file does not exist.
+*/
+inline
+std::shared_ptr<codec_dictionary const>
+load_dictionary (std::string const& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (! in.is_open())
+        return nullptr;
+    std::vector<char> const v(
+        (std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+    if (in.bad())
+        throw std::runtime_error(
+            "nodestore: can't read dictionary " + path);
+    return std::make_shared<codec_dictionary>(
+        v.data(), v.size());
+}
+
+inline
+void
+save_dictionary (std::string const& path,
+    codec_dictionary const& dict)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(dict.data(), dict.size());
+    out.close();
+    if (! out)
+        throw std::runtime_error(
+            "nodestore: can't write dictionary " + path);
+}
+
+//------------------------------------------------------------------------------
+
+/** Builds a codec_dictionary from sample values.
+
+    Every 8 byte run in the samples is counted. The samples are then
+    divided into as many slices as there are segments in the
+    dictionary, and from each slice the segment whose runs are most
+    frequent is chosen. The counts of chosen runs are cleared, so later
+    segments add content the dictionary doesn't already have.
+
+    The dictionary is filled from the back, so the segments chosen
+    first, which cover the most common content, end up last.
+*/
+class dictionary_trainer
+{
+private:
+    enum
+    {
+        // Length of a counted run
+        run_size = 8,
+
+        // Length of a dictionary segment
+        segment_size = 64,
+
+        // log2 of the number of run counters
+        table_bits = 20
+    };
+
+    std::vector<char> data_;
+
+public:
+    /** Add a sample. */
+    void
+    add (void const* data, std::size_t size)
+    {
+        auto const p = reinterpret_cast<char const*>(data);
+        data_.insert(data_.end(), p, p + size);
+    }
+
+    /** Returns the number of bytes sampled. */
+    std::size_t
+    size() const
+    {
+        return data_.size();
+    }
+
+    /** Build a dictionary of at most size bytes.
+
+        @return nullptr if there are no samples.
+    */
+    std::shared_ptr<codec_dictionary const>
+    train (std::size_t size = codec_dictionary::max_size) const
+    {
+        size = std::min<std::size_t>(size, codec_dictionary::max_size);
+        if (data_.empty() || size == 0)
+            return nullptr;
+        if (data_.size() <= size)
+            return std::make_shared<codec_dictionary>(
+                data_.data(), data_.size());
+
+        std::vector<std::uint32_t> freq(
+            std::size_t(1) << table_bits);
+        std::size_t const runs = data_.size() - run_size + 1;
+        for (std::size_t i = 0; i < runs; ++i)
+            ++freq[slot(i)];
+
+        auto const segments = std::max<std::size_t>(
+            1, size / segment_size);
+        auto const slice = std::max<std::size_t>(
+            segment_size, data_.size() / segments);
+
+        std::vector<char> dict(size);
+        std::size_t tail = size;
+        std::vector<std::uint16_t> active(freq.size());
+        for (std::size_t begin = 0; tail > 0 &&
+            begin + segment_size <= data_.size(); begin += slice)
+        {
+            auto const end = std::min(
+                begin + slice, data_.size());
+            auto const best = best_segment(
+                begin, end, freq, active);
+            if (best.second == 0)
+                continue;
+            for (std::size_t i = best.first;
+                    i + run_size <= best.first + segment_size; ++i)
+                freq[slot(i)] = 0;
+            auto const n = std::min<std::size_t>(segment_size, tail);
+            tail -= n;
+            std::memcpy(dict.data() + tail,
+                data_.data() + best.first, n);
+        }
+        if (tail == size)
+            return nullptr;
+        return std::make_shared<codec_dictionary>(
+            dict.data() + tail, size - tail);
+    }
+
+private:
+    std::size_t
+    slot (std::size_t i) const
+    {
+        std::uint64_t v;
+        std::memcpy(&v, data_.data() + i, run_size);
+        return static_cast<std::size_t>(
+            (v * 0xCF1BBCDCB7A56463ULL) >> (64 - table_bits));
+    }
+
+    // Returns the start and score of the segment in [begin, end)
+    // whose distinct runs have the highest total count.
+    std::pair<std::size_t, std::uint64_t>
+    best_segment (std::size_t begin, std::size_t end,
+        std::vector<std::uint32_t> const& freq,
+            std::vector<std::uint16_t>& active) const
+    {
+        std::pair<std::size_t, std::uint64_t> best(begin, 0);
+        if (end - begin < segment_size)
+            return best;
+        std::size_t const window = segment_size - run_size + 1;
+        std::size_t const last = end - run_size + 1;
+        std::uint64_t score = 0;
+        std::size_t first = begin;
+        for (std::size_t i = begin; i < last; ++i)
+        {
+            auto const s = slot(i);
+            if (active[s]++ == 0)
+                score += freq[s];
+            if (i - first + 1 > window)
+            {
+                auto const t = slot(first++);
+                if (--active[t] == 0)
+                    score -= freq[t];
+            }
+            if (i - first + 1 == window && score > best.second)
+                best = { first, score };
+        }
+        while (first < last)
+        {
+            auto const t = slot(first++);
+            --active[t];
+        }
+        return best;
+    }
+};
+
+} // NodeStore
+} // ripple
+
+#endif
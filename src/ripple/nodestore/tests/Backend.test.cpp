@@ -21,7 +21,11 @@
 #include <ripple/nodestore/tests/Base.test.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/dictionary.h>
 #include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
 
 namespace ripple {
 namespace NodeStore {
@@ -32,21 +36,41 @@ class Backend_test : public TestBase
 {
 public:
     void testBackend (std::string const& type, std::int64_t const seedValue,
-                      int numObjectsToTest = 2000)
+                      int numObjectsToTest = 2000,
+                      std::string const& compression = "")
     {
         DummyScheduler scheduler;
 
-        testcase ("Backend type=" + type);
+        testcase ("Backend type=" + type +
+            (compression.empty () ? "" : " compression=" + compression));
 
         Section params;
         beast::UnitTestUtilities::TempDirectory path ("node_db");
         params.set ("type", type);
         params.set ("path", path.getFullPathName ().toStdString ());
+        if (! compression.empty ())
+            params.set ("compression", compression);
 
         // Create a batch
         Batch batch;
         createPredictableBatch (batch, numObjectsToTest, seedValue);
 
+        if (compression == "dictionary")
+        {
+            dictionary_trainer trainer;
+            EncodedBlob encoded;
+            for (auto const& object : batch)
+            {
+                encoded.prepare (object);
+                trainer.add (encoded.getData (), encoded.getSize ());
+            }
+            auto const dir = boost::filesystem::path (
+                path.getFullPathName ().toStdString ());
+            boost::filesystem::create_directories (dir);
+            save_dictionary ((dir / "nudb.dict").string (),
+                *trainer.train ());
+        }
+
         beast::Journal j;
 
         {
@@ -71,6 +95,14 @@ public:
                 fetchCopyOfBatch (*backend, &copy, batch);
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
+
+            if (backend->canFetchBatch ())
+            {
+                // Read it back in with one batch
+                Batch copy;
+                fetchBatchCopyOfBatch (*backend, &copy, batch);
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
         }
 
         {
@@ -86,6 +118,33 @@ public:
             std::sort (copy.begin (), copy.end (), LessThan{});
             expect (areBatchesEqual (batch, copy), "Should be equal");
         }
+
+        {
+            // Re-open the backend and read it back in with one batch
+            std::unique_ptr <Backend> backend = Manager::instance().make_Backend (
+                params, scheduler, j);
+
+            if (backend->canFetchBatch ())
+            {
+                Batch copy;
+                fetchBatchCopyOfBatch (*backend, &copy, batch);
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+
+                // Keys which aren't in the backend come back as nullptr
+                Batch others;
+                createPredictableBatch (others, 100, seedValue + 1);
+                std::vector <void const*> keys;
+                for (auto const& object : others)
+                    keys.push_back (object->getHash ().cbegin ());
+                auto const objects = backend->fetchBatch (keys.size (), keys.data ());
+                expect (objects.size () == keys.size (), "Wrong size");
+                expect (std::all_of (objects.begin (), objects.end (),
+                    [](std::shared_ptr<NodeObject> const& object)
+                    {
+                        return object == nullptr;
+                    }), "Should be missing");
+            }
+        }
     }
 
     //--------------------------------------------------------------------------
@@ -95,6 +154,9 @@ public:
         int const seedValue = 50;
 
         testBackend ("nudb", seedValue);
+        testBackend ("nudb", seedValue, 2000, "none");
+        testBackend ("nudb", seedValue, 2000, "dictionary");
+        testBackend ("mapped", seedValue);
 
     #if RIPPLE_ROCKSDB_AVAILABLE
         testBackend ("rocksdb", seedValue);
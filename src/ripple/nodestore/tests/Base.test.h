@@ -180,6 +180,29 @@ public:
         }
     }
 
+    // Get a copy of a batch in a backend with one batch fetch
+    void fetchBatchCopyOfBatch (Backend& backend, Batch* pCopy, Batch const& batch)
+    {
+        pCopy->clear ();
+        pCopy->reserve (batch.size ());
+
+        std::vector <void const*> keys;
+        for (int i = 0; i < batch.size (); ++i)
+            keys.push_back (batch [i]->getHash ().cbegin ());
+
+        auto objects = backend.fetchBatch (keys.size (), keys.data ());
+
+        expect (objects.size () == batch.size (), "Wrong size");
+
+        for (auto& object : objects)
+        {
+            expect (object != nullptr, "Should not be null");
+
+            if (object != nullptr)
+                pCopy->push_back (std::move (object));
+        }
+    }
+
     void fetchMissing(Backend& backend, Batch const& batch)
     {
         for (int i = 0; i < batch.size (); ++i)
@@ -23,6 +23,10 @@
 #include <ripple/nodestore/Manager.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <beast/nudb/detail/buffer.h>
+#include <beast/random/xor_shift_engine.h>
+#include <cstring>
 
 namespace ripple {
 namespace NodeStore {
@@ -77,6 +81,107 @@ public:
         }
     }
 
+    // Compress and decompress a value, returning the compressed size
+    std::size_t roundTrip (nodeobject_codec const& codec,
+        void const* data, std::size_t size)
+    {
+        beast::nudb::detail::buffer buf;
+        beast::nudb::detail::buffer buf2;
+        auto const out = codec.compress (data, size, buf);
+        auto const in = codec.decompress (out.first, out.second, buf2);
+        expect (in.second == size &&
+            std::memcmp (in.first, data, size) == 0, "Should round trip");
+        return out.second;
+    }
+
+    // Checks each nodeobject_compression
+    void testCodec (std::int64_t const seedValue)
+    {
+        testcase ("codec");
+
+        // Values which share most of their bytes, like ledger entries
+        beast::xor_shift_engine gen (seedValue);
+        std::vector <Blob> values;
+        for (int i = 0; i < 2000; ++i)
+        {
+            Blob v (120);
+            for (int j = 0; j < v.size (); ++j)
+                v[j] = static_cast <std::uint8_t> (j * 7);
+            for (int j = 40; j < 60; ++j)
+                v[j] = static_cast <std::uint8_t> (gen ());
+            values.push_back (std::move (v));
+        }
+
+        dictionary_trainer trainer;
+        for (int i = 0; i < values.size () / 2; ++i)
+            trainer.add (values[i].data (), values[i].size ());
+        auto const dict = trainer.train (4096);
+        expect (dict != nullptr, "Should have a dictionary");
+        if (! dict)
+            return;
+        expect (dict->size () <= 4096, "Dictionary too big");
+
+        nodeobject_codec const none (nodeobject_compression::none);
+        nodeobject_codec const lz4 (nodeobject_compression::lz4);
+        nodeobject_codec const withDict (
+            nodeobject_compression::dictionary, dict);
+
+        std::size_t raw = 0;
+        std::size_t lz4Size = 0;
+        std::size_t dictSize = 0;
+        for (int i = values.size () / 2; i < values.size (); ++i)
+        {
+            auto const& v = values[i];
+            raw += v.size ();
+            expect (roundTrip (none, v.data (), v.size ()) == v.size () + 1);
+            lz4Size += roundTrip (lz4, v.data (), v.size ());
+            dictSize += roundTrip (withDict, v.data (), v.size ());
+        }
+        // lz4 finds nothing to reuse inside one value
+        expect (dictSize < lz4Size, "dictionary should beat lz4");
+        expect (dictSize < raw / 2, "dictionary should compress");
+
+        // Values from the other codecs can be read with the dictionary
+        {
+            Batch batch;
+            createPredictableBatch (batch, numObjectsToTest, seedValue);
+            EncodedBlob encoded;
+            for (auto const& object : batch)
+            {
+                encoded.prepare (object);
+                beast::nudb::detail::buffer buf;
+                beast::nudb::detail::buffer buf2;
+                auto const out = lz4.compress (
+                    encoded.getData (), encoded.getSize (), buf);
+                auto const in = withDict.decompress (
+                    out.first, out.second, buf2);
+                expect (in.second == encoded.getSize () &&
+                    std::memcmp (in.first, encoded.getData (),
+                        in.second) == 0, "Should decompress");
+
+                // Random values don't compress and are stored as is
+                roundTrip (withDict, encoded.getData (), encoded.getSize ());
+            }
+        }
+
+        // A dictionary value can't be read without the dictionary
+        {
+            auto const& v = values.back ();
+            beast::nudb::detail::buffer buf;
+            beast::nudb::detail::buffer buf2;
+            auto const out = withDict.compress (v.data (), v.size (), buf);
+            try
+            {
+                lz4.decompress (out.first, out.second, buf2);
+                fail ("Missing dictionary");
+            }
+            catch (beast::nudb::codec_error const&)
+            {
+                pass ();
+            }
+        }
+    }
+
     void run ()
     {
         std::int64_t const seedValue = 50;
@@ -84,6 +189,8 @@ public:
         testBatches (seedValue);
 
         testBlobs (seedValue);
+
+        testCodec (seedValue);
     }
 };
 
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <beast/unit_test/suite.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+class BatchWriter_test : public beast::unit_test::suite
+{
+public:
+    // Runs each task on a new thread
+    class ThreadScheduler : public DummyScheduler
+    {
+        std::mutex mutex_;
+        std::vector <std::thread> threads_;
+
+    public:
+        ~ThreadScheduler ()
+        {
+            join ();
+        }
+
+        void scheduleTask (Task& task) override
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            threads_.emplace_back ([&task]() { task.performScheduledTask (); });
+        }
+
+        void join ()
+        {
+            std::vector <std::thread> threads;
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                threads.swap (threads_);
+            }
+            for (auto& t : threads)
+                t.join ();
+        }
+    };
+
+    // Records the size of each commit, optionally blocking or slowly
+    class Writer : public BatchWriter::Callback
+    {
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool open_ = true;
+
+    public:
+        std::vector <std::size_t> batches;
+        std::atomic <int> delay {0};
+
+        void close ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            open_ = false;
+        }
+
+        void open ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            open_ = true;
+            cond_.notify_all ();
+        }
+
+        void writeBatch (Batch const& batch) override
+        {
+            std::unique_lock <std::mutex> lock (mutex_);
+            while (! open_)
+                cond_.wait (lock);
+            batches.push_back (batch.size ());
+            lock.unlock ();
+            if (delay > 0)
+                std::this_thread::sleep_for (
+                    std::chrono::milliseconds (delay));
+        }
+
+        std::size_t total ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            std::size_t n = 0;
+            for (auto const size : batches)
+                n += size;
+            return n;
+        }
+    };
+
+    static std::shared_ptr <NodeObject> makeObject (int i)
+    {
+        Blob data (32, static_cast <unsigned char> (i));
+        return NodeObject::createObject (
+            hotUNKNOWN, std::move (data), uint256 (i));
+    }
+
+    void testSynchronous ()
+    {
+        testcase ("synchronous");
+
+        DummyScheduler scheduler;
+        Writer writer;
+        {
+            BatchWriter bw (writer, scheduler);
+            for (int i = 0; i < 10; ++i)
+                bw.store (makeObject (i));
+            expect (bw.getWriteLoad () == 0);
+        }
+        expect (writer.batches.size () == 10);
+        expect (writer.total () == 10);
+    }
+
+    void testPipelined ()
+    {
+        testcase ("pipelined");
+
+        ThreadScheduler scheduler;
+        Writer writer;
+        writer.close ();
+        {
+            BatchWriter bw (writer, scheduler);
+
+            // A commit is held open while more objects
+            // go into the other buffer without waiting
+            for (int i = 0; i < 1000; ++i)
+                bw.store (makeObject (i));
+            expect (bw.getWriteLoad () == 1000);
+            writer.open ();
+        }
+        scheduler.join ();
+        expect (writer.total () == 1000);
+    }
+
+    void testLimit ()
+    {
+        testcase ("limit");
+
+        ThreadScheduler scheduler;
+        Writer writer;
+        BatchWriter bw (writer, scheduler);
+        std::size_t const initial = bw.getWriteLimit ();
+
+        // A backlog grows the commits
+        writer.close ();
+        for (int i = 0; i < 10000; ++i)
+            bw.store (makeObject (i));
+        writer.open ();
+        scheduler.join ();
+        expect (writer.total () == 10000);
+        for (auto const size : writer.batches)
+            expect (size <= 10000 / 2, "Commit too large");
+        std::size_t const grown = bw.getWriteLimit ();
+        expect (grown > initial, "Should grow");
+
+        // Slow commits shrink them
+        writer.delay = 150;
+        bw.store (makeObject (0));
+        scheduler.join ();
+        expect (bw.getWriteLimit () == grown / 2, "Should shrink");
+    }
+
+    void run ()
+    {
+        testSynchronous ();
+        testPipelined ();
+        testLimit ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BatchWriter,NodeStore,ripple);
+
+}
+}
@@ -148,6 +148,54 @@ public:
                 std::sort (copy.begin (), copy.end (), LessThan{});
                 expect (areBatchesEqual (batch, copy), "Should be equal");
             }
+
+            {
+                // Re-open the database and read it back in with one batch
+                std::unique_ptr <Database> db = Manager::instance().make_Database (
+                    "test", scheduler, j, 2, nodeParams);
+
+                std::vector <uint256> hashes;
+                for (auto const& object : batch)
+                    hashes.push_back (object->getHash ());
+                hashes.push_back (uint256 ());
+
+                auto objects = db->fetchBatch (hashes);
+                expect (objects.size () == hashes.size (), "Wrong size");
+                expect (objects.back () == nullptr, "Should be missing");
+                objects.pop_back ();
+
+                Batch copy;
+                for (auto& object : objects)
+                    if (object != nullptr)
+                        copy.push_back (std::move (object));
+
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
+
+            {
+                // Re-open the database and read the payloads in place
+                std::unique_ptr <Database> db = Manager::instance().make_Database (
+                    "test", scheduler, j, 2, nodeParams);
+
+                Batch copy;
+                for (auto const& object : batch)
+                {
+                    db->fetchPayload (object->getHash (),
+                        [&](NodeObjectType type, void const* data,
+                            std::size_t size)
+                        {
+                            auto const p = static_cast <
+                                std::uint8_t const*> (data);
+                            copy.push_back (NodeObject::createObject (type,
+                                Blob (p, p + size), object->getHash ()));
+                        });
+                }
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+
+                expect (! db->fetchPayload (uint256 (),
+                    [](NodeObjectType, void const*, std::size_t) {}),
+                        "Should be missing");
+            }
         }
     }
 
@@ -156,6 +204,7 @@ public:
     void runBackendTests (std::int64_t const seedValue)
     {
         testNodeStore ("nudb", true, seedValue);
+        testNodeStore ("mapped", true, seedValue);
 
     #if RIPPLE_ROCKSDB_AVAILABLE
         testNodeStore ("rocksdb", true, seedValue);
@@ -168,6 +217,12 @@ public:
     {
         testImport ("nudb", "nudb", seedValue);
 
+        // The memory backend can visit ranges, so this import is parallel
+        testImport ("nudb", "memory", seedValue);
+
+        // The mapped backend is written once by an import
+        testImport ("mapped", "nudb", seedValue);
+
     #if RIPPLE_ROCKSDB_AVAILABLE
         testImport ("rocksdb", "rocksdb", seedValue);
     #endif
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+class DatabaseShard_test : public TestBase
+{
+public:
+    // Stores the objects of a ledger, a slice of the batch
+    static void storeLedger (DatabaseShard& db, Batch const& batch,
+        std::uint32_t seq, std::size_t perLedger)
+    {
+        auto const first = (seq - 1) * perLedger;
+        for (auto i = first; i < first + perLedger; ++i)
+        {
+            Blob data (batch[i]->getData ());
+            db.store (batch[i]->getType (), std::move (data),
+                batch[i]->getHash (), seq);
+        }
+        db.setStored (seq);
+    }
+
+    // Returns the number of objects of a ledger which can be fetched
+    static std::size_t countFound (DatabaseShard& db, Batch const& batch,
+        std::uint32_t seq, std::size_t perLedger)
+    {
+        std::size_t n = 0;
+        auto const first = (seq - 1) * perLedger;
+        for (auto i = first; i < first + perLedger; ++i)
+        {
+            auto const object = db.fetch (batch[i]->getHash (), seq);
+            if (object && isSame (object, batch[i]))
+                ++n;
+        }
+        return n;
+    }
+
+    void testShards (std::string const& type, bool compact,
+        std::int64_t const seedValue)
+    {
+        testcase ("type=" + type + " compact=" + (compact ? "1" : "0"));
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory shard_db ("shard_db");
+        auto const path = boost::filesystem::path (
+            shard_db.getFullPathName ().toStdString ());
+        Section params;
+        params.set ("type", type);
+        params.set ("path", path.string ());
+        params.set ("ledgers_per_shard", "4");
+        params.set ("compact", compact ? "1" : "0");
+
+        std::size_t const perLedger = 50;
+        Batch batch;
+        createPredictableBatch (batch, 8 * perLedger, seedValue);
+
+        {
+            auto db = Manager::instance().make_DatabaseShard (
+                "test", scheduler, params, j);
+            expect (db->ledgersPerShard () == 4);
+            expect (db->seqToShardIndex (1) == 0);
+            expect (db->seqToShardIndex (4) == 0);
+            expect (db->seqToShardIndex (5) == 1);
+
+            for (std::uint32_t seq = 1; seq <= 6; ++seq)
+                storeLedger (*db, batch, seq, perLedger);
+
+            expect (db->getCompleteShards () == "0", "Shard 0 is complete");
+            expect (db->hasLedger (6), "Should have ledger 6");
+            expect (! db->hasLedger (7), "Should not have ledger 7");
+            expect (countFound (*db, batch, 2, perLedger) == perLedger);
+            expect (countFound (*db, batch, 6, perLedger) == perLedger);
+
+            // Routed by sequence, an object of another shard isn't found
+            expect (! db->fetch (batch.front ()->getHash (), 5));
+            expect (db->fetch (batch.front ()->getHash ()) != nullptr);
+
+            db->validate ();
+            db->close ();
+        }
+
+        expect (boost::filesystem::exists (
+            path / "0" / "mapped" / "mapped.key") == compact,
+                "Complete shards are compacted if asked");
+        expect (boost::filesystem::exists (path / "0" / type) != compact,
+            "A compacted shard's backend is removed");
+
+        // Finish the second shard after opening again
+        {
+            auto db = Manager::instance().make_DatabaseShard (
+                "test", scheduler, params, j);
+            expect (db->hasLedger (5), "Should have ledger 5");
+            expect (countFound (*db, batch, 5, perLedger) == perLedger);
+
+            for (std::uint32_t seq = 7; seq <= 8; ++seq)
+                storeLedger (*db, batch, seq, perLedger);
+            expect (db->getCompleteShards () == "0-1", "Should be complete");
+            for (std::uint32_t seq = 1; seq <= 8; ++seq)
+                expect (countFound (*db, batch, seq, perLedger) == perLedger);
+        }
+
+        // Changing the shard size is refused
+        params.set ("ledgers_per_shard", "8");
+        try
+        {
+            Manager::instance().make_DatabaseShard (
+                "test", scheduler, params, j);
+            fail ("Should refuse other settings");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+
+        // A Mapped backend can't be written once closed
+        params.set ("type", "mapped");
+        params.set ("ledgers_per_shard", "4");
+        try
+        {
+            Manager::instance().make_DatabaseShard (
+                "test", scheduler, params, j);
+            fail ("Should refuse type=mapped");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        testShards ("nudb", true, seedValue);
+        testShards ("nudb", false, seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DatabaseShard,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,141 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+class DatabaseTiered_test : public TestBase
+{
+public:
+    // Returns the number of objects in a batch found in a backend
+    static std::size_t countFound (Section const& params, Batch const& batch)
+    {
+        DummyScheduler scheduler;
+        auto backend = Manager::instance ().make_Backend (
+            params, scheduler, beast::Journal ());
+        std::size_t n = 0;
+        for (auto const& object : batch)
+        {
+            std::shared_ptr<NodeObject> found;
+            if (backend->fetch (object->getHash ().data (), &found) == ok &&
+                    isSame (found, object))
+                ++n;
+        }
+        return n;
+    }
+
+    void testTiers (std::string const& fastType, bool promote,
+        std::int64_t const seedValue)
+    {
+        testcase ("fast=" + fastType + " promote=" + (promote ? "1" : "0"));
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory node_db ("node_db");
+        auto const path = boost::filesystem::path (
+            node_db.getFullPathName ().toStdString ());
+
+        // Demote on every sweep
+        Section fastParams;
+        fastParams.set ("type", fastType);
+        fastParams.set ("path", (path / "fast").string ());
+        fastParams.set ("age", "0");
+        fastParams.set ("promote", promote ? "1" : "0");
+
+        Section slowParams;
+        slowParams.set ("type", "nudb");
+        slowParams.set ("path", (path / "slow").string ());
+
+        Batch older;
+        createPredictableBatch (older, numObjectsToTest, seedValue);
+        Batch newer;
+        createPredictableBatch (newer, numObjectsToTest, seedValue + 1);
+
+        {
+            auto db = Manager::instance ().make_DatabaseTiered (
+                "test", scheduler, j, 2, fastParams, slowParams);
+
+            storeBatch (*db, older);
+            db->sweep ();
+            storeBatch (*db, newer);
+            db->sweep ();
+
+            Batch copy;
+            fetchCopyOfBatch (*db, &copy, older);
+            expect (areBatchesEqual (older, copy), "Should be equal");
+            fetchCopyOfBatch (*db, &copy, newer);
+            expect (areBatchesEqual (newer, copy), "Should be equal");
+        }
+
+        bool const persistent = fastType != "memory";
+
+        // Only the generation before the previous one was demoted,
+        // unless the fast tier keeps nothing on disk
+        expect (countFound (slowParams, older) == older.size (),
+            "Older objects should be demoted");
+        expect (countFound (slowParams, newer) ==
+            (persistent ? 0 : newer.size ()),
+                "Newer objects should be demoted on close");
+
+        {
+            // Reopened, the objects are read from both tiers
+            auto db = Manager::instance ().make_DatabaseTiered (
+                "test", scheduler, j, 2, fastParams, slowParams);
+
+            Batch copy;
+            fetchCopyOfBatch (*db, &copy, older);
+            expect (areBatchesEqual (older, copy), "Should be equal");
+            fetchCopyOfBatch (*db, &copy, newer);
+            expect (areBatchesEqual (newer, copy), "Should be equal");
+        }
+
+        if (persistent)
+        {
+            // Objects read from the slow tier were copied to the
+            // current generation
+            Section params (fastParams);
+            params.set ("path", (path / "fast" / "2").string ());
+            expect (countFound (params, older) ==
+                (promote ? older.size () : 0), "Promotion");
+        }
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        testTiers ("nudb", true, seedValue);
+        testTiers ("nudb", false, seedValue);
+        testTiers ("memory", true, seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DatabaseTiered,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,294 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/BloomFilter.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <thread>
+
+namespace ripple {
+namespace NodeStore {
+
+class FilteredBackend_test : public TestBase
+{
+public:
+    void testBloomFilter (std::int64_t const seedValue)
+    {
+        testcase ("BloomFilter");
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        Batch others;
+        createPredictableBatch (others, numObjectsToTest, seedValue + 1);
+
+        BloomFilter filter (batch.size ());
+        for (auto const& object : batch)
+            filter.insert (object->getHash ());
+
+        int missing = 0;
+        for (auto const& object : batch)
+            if (! filter.mayContain (object->getHash ()))
+                ++missing;
+        expect (missing == 0, "Should never miss a key");
+
+        int falsePositives = 0;
+        for (auto const& object : others)
+            if (filter.mayContain (object->getHash ()))
+                ++falsePositives;
+        expect (falsePositives < others.size () / 20,
+            "Too many false positives: " + std::to_string (falsePositives));
+
+        // A saved filter has its own size, and its count of objects
+        beast::UnitTestUtilities::TempDirectory dir ("filter");
+        auto const dirPath = boost::filesystem::path (
+            dir.getFullPathName ().toStdString ());
+        boost::filesystem::create_directories (dirPath);
+        auto const file = (dirPath / "test.filter").string ();
+        expect (filter.save (file, batch.size ()), "Should save");
+
+        std::uint64_t objects = 0;
+        auto const copy = BloomFilter::load (file, objects);
+        expect (copy != nullptr, "Should load");
+        if (copy)
+        {
+            expect (copy->size () == filter.size ());
+            for (auto const& object : batch)
+                if (! copy->mayContain (object->getHash ()))
+                    ++missing;
+            expect (missing == 0, "Should never miss a key");
+        }
+        expect (objects == batch.size ());
+
+        boost::filesystem::resize_file (file, filter.size ());
+        expect (BloomFilter::load (file, objects) == nullptr,
+            "Should reject a damaged file");
+        expect (BloomFilter::load ((dirPath / "missing").string (),
+            objects) == nullptr, "Should reject a missing file");
+    }
+
+    void testBackend (std::string const& type, std::int64_t const seedValue)
+    {
+        testcase ("FilteredBackend type=" + type);
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory path ("node_db");
+        auto const dir = boost::filesystem::path (
+            path.getFullPathName ().toStdString ());
+        auto const file = dir / "nodestore.filter";
+        Section params;
+        params.set ("type", type);
+        params.set ("path", dir.string ());
+        params.set ("filter_objects", std::to_string (numObjectsToTest));
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        Batch others;
+        createPredictableBatch (others, numObjectsToTest, seedValue + 1);
+
+        auto const fetchOthers = [&](Backend& backend)
+        {
+            for (auto const& object : others)
+            {
+                std::shared_ptr<NodeObject> found;
+                expect (backend.fetch (object->getHash ().cbegin (),
+                    &found) == notFound, "Should be missing");
+            }
+        };
+
+        // Backends which can't be visited in use build it when closed
+        auto const expectBuilding = [&](Backend& backend)
+        {
+            if (backend.canVisitRange ())
+                waitForFilter (backend);
+            else
+                expect (backend.getFilterCounts ().building == 1,
+                    "Should be building");
+        };
+
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expectBuilding (*backend);
+            storeBatch (*backend, batch);
+
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+            fetchOthers (*backend);
+            if (! backend->canVisitRange ())
+                expect (backend->getFilterCounts ().skipped == 0,
+                    "Should pass every read");
+        }
+
+        // Reopened from the saved filter
+        expect (boost::filesystem::exists (file), "Should be saved");
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expect (! boost::filesystem::exists (file), "Should be removed");
+
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+            fetchOthers (*backend);
+            expectFiltered (*backend, batch, others);
+        }
+
+        // Rebuilt from the backend, as after a crash
+        boost::filesystem::remove (file);
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expectBuilding (*backend);
+
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+
+            if (backend->canFetchBatch ())
+            {
+                fetchBatchCopyOfBatch (*backend, &copy, batch);
+                expect (areBatchesEqual (batch, copy), "Should be equal");
+            }
+        }
+
+        // Rebuilt larger when it holds more objects than it was sized for
+        boost::filesystem::remove (file);
+        params.set ("filter_objects", "10");
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expectBuilding (*backend);
+        }
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expectBuilding (*backend);
+        }
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expect (backend->getFilterCounts ().building == 0,
+                "Should be loaded");
+
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, batch);
+            expect (areBatchesEqual (batch, copy), "Should be equal");
+            fetchOthers (*backend);
+            expectFiltered (*backend, batch, others);
+        }
+
+        // Opening without a filter discards the saved one
+        expect (boost::filesystem::exists (file), "Should be saved");
+        params.set ("filter_objects", "0");
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            expect (! boost::filesystem::exists (file), "Should be removed");
+            expect (backend->getFilterCounts ().filters == 0);
+        }
+    }
+
+    // Built in the background for backends which can be visited in use
+    void testBackground (std::int64_t const seedValue)
+    {
+        testcase ("FilteredBackend background");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        Section params;
+        params.set ("type", "memory");
+        params.set ("path", "filter_test");
+        params.set ("filter_objects", std::to_string (numObjectsToTest));
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        Batch others;
+        createPredictableBatch (others, numObjectsToTest, seedValue + 1);
+
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (params, scheduler, j);
+            storeBatch (*backend, batch);
+        }
+
+        std::unique_ptr <Backend> backend =
+            Manager::instance().make_Backend (params, scheduler, j);
+        waitForFilter (*backend);
+
+        Batch copy;
+        fetchCopyOfBatch (*backend, &copy, batch);
+        expect (areBatchesEqual (batch, copy), "Should be equal");
+        for (auto const& object : others)
+        {
+            std::shared_ptr<NodeObject> found;
+            backend->fetch (object->getHash ().cbegin (), &found);
+        }
+        expectFiltered (*backend, batch, others);
+
+        backend->setDeletePath ();
+    }
+
+    void waitForFilter (Backend& backend)
+    {
+        for (int i = 0; i < 10000 &&
+                backend.getFilterCounts ().building != 0; ++i)
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+        expect (backend.getFilterCounts ().building == 0, "Should be built");
+    }
+
+    // Fetches of the batch were passed and most of the others skipped
+    void expectFiltered (Backend& backend, Batch const& batch,
+        Batch const& others)
+    {
+        auto const counts = backend.getFilterCounts ();
+        expect (counts.filters == 1);
+        expect (counts.building == 0, "Should be built");
+        expect (counts.hits == batch.size ());
+        expect (counts.skipped + counts.falsePositives == others.size ());
+        expect (counts.skipped > counts.falsePositives,
+            "Should skip most reads");
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        testBloomFilter (seedValue);
+        testBackend ("nudb", seedValue);
+        testBackground (seedValue);
+
+    #if RIPPLE_ROCKSDB_AVAILABLE
+        testBackend ("rocksdb", seedValue);
+    #endif
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FilteredBackend,NodeStore,ripple);
+
+}
+}
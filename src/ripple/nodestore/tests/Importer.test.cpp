@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Importer.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ripple {
+namespace NodeStore {
+
+class Importer_test : public TestBase
+{
+public:
+    void testRanges ()
+    {
+        testcase ("ranges");
+
+        uint256 ones;
+        std::fill (ones.begin (), ones.end (), 0xff);
+
+        for (int partitions : { 1, 3, 256, 1000, 65536 })
+        {
+            auto prev = Importer::range (0, partitions);
+            expect (prev.first == beast::zero, "Should start at zero");
+            for (int i = 1; i < partitions; ++i)
+            {
+                auto const r = Importer::range (i, partitions);
+                expect (r.first <= r.second, "Empty range");
+                expect (++prev.second == r.first, "Ranges should meet");
+                prev = r;
+            }
+            expect (prev.second == ones, "Should end at the last key");
+        }
+    }
+
+    // Returns the number of objects in a batch found in a database
+    static int countFound (Database& db, Batch const& batch)
+    {
+        int n = 0;
+        for (auto const& object : batch)
+            if (db.fetch (object->getHash ()))
+                ++n;
+        return n;
+    }
+
+    void testCheckpoint (std::int64_t const seedValue)
+    {
+        testcase ("checkpoint");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory src_db ("src_db");
+        Section srcParams;
+        srcParams.set ("type", "memory");
+        srcParams.set ("path", src_db.getFullPathName ().toStdString ());
+
+        beast::UnitTestUtilities::TempDirectory dest_db ("dest_db");
+        auto const destPath = dest_db.getFullPathName ().toStdString ();
+        Section destParams;
+        destParams.set ("type", "nudb");
+        destParams.set ("path", destPath);
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+
+        std::unique_ptr <Database> src = Manager::instance().make_Database (
+            "test", scheduler, j, 2, srcParams);
+        storeBatch (*src, batch);
+
+        std::unique_ptr <Database> dest = Manager::instance().make_Database (
+            "test", scheduler, j, 2, destParams);
+
+        Importer::Setup setup;
+        setup.threads = 3;
+        setup.partitions = 16;
+        setup.checkpoint = (boost::filesystem::path (destPath) /
+            "import.checkpoint").string ();
+
+        // Pretend the first half was copied, and that the
+        // server stopped while writing the next range
+        {
+            std::ofstream out (setup.checkpoint);
+            out << "import 16 " << src->getName () << '\n';
+            for (int i = 0; i < 8; ++i)
+                out << i << '\n';
+            out << "1";
+        }
+
+        Batch firstHalf;
+        Batch secondHalf;
+        auto const middle = Importer::range (8, 16).first;
+        for (auto const& object : batch)
+            (object->getHash () < middle ? firstHalf : secondHalf).push_back (
+                object);
+
+        {
+            Importer importer (*src, *dest, setup, j);
+            expect (importer.run (), "Should finish");
+            expect (importer.objects () == secondHalf.size ());
+            expect (importer.finished () == setup.partitions);
+        }
+        expect (countFound (*dest, firstHalf) == 0, "Should be skipped");
+        expect (countFound (*dest, secondHalf) == secondHalf.size (),
+            "Should be copied");
+
+        // A finished import removes its checkpoint
+        expect (! boost::filesystem::exists (setup.checkpoint),
+            "Checkpoint should be removed");
+
+        // A checkpoint from another import is ignored
+        {
+            {
+                std::ofstream out (setup.checkpoint);
+                out << "import 16 other\n";
+                for (int i = 0; i < 16; ++i)
+                    out << i << '\n';
+            }
+            Importer importer (*src, *dest, setup, j);
+            expect (importer.run (), "Should finish");
+            expect (importer.objects () == batch.size ());
+        }
+        expect (countFound (*dest, batch) == batch.size (),
+            "Should be copied");
+    }
+
+    void testStop (std::int64_t const seedValue)
+    {
+        testcase ("stop");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory src_db ("src_db");
+        Section srcParams;
+        srcParams.set ("type", "memory");
+        srcParams.set ("path", src_db.getFullPathName ().toStdString ());
+
+        beast::UnitTestUtilities::TempDirectory dest_db ("dest_db");
+        Section destParams;
+        destParams.set ("type", "memory");
+        destParams.set ("path", dest_db.getFullPathName ().toStdString ());
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+
+        std::unique_ptr <Database> src = Manager::instance().make_Database (
+            "test", scheduler, j, 2, srcParams);
+        storeBatch (*src, batch);
+
+        std::unique_ptr <Database> dest = Manager::instance().make_Database (
+            "test", scheduler, j, 2, destParams);
+
+        Importer importer (*src, *dest, Importer::Setup (), j);
+        importer.stop ();
+        importer.start ();
+        importer.stop ();
+        importer.wait ();
+        expect (importer.objects () <= batch.size ());
+
+        // Starting again finishes the job
+        expect (importer.run (), "Should finish");
+        expect (countFound (*dest, batch) == batch.size (),
+            "Should be copied");
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        testRanges ();
+        testCheckpoint (seedValue);
+        testStop (seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Importer,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+
+namespace ripple {
+namespace NodeStore {
+
+class MappedBackend_test : public TestBase
+{
+public:
+    void testSealed (std::int64_t const seedValue)
+    {
+        testcase ("sealed");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory node_db ("node_db");
+        auto const path = boost::filesystem::path (
+            node_db.getFullPathName ().toStdString ());
+        Section params;
+        params.set ("type", "mapped");
+        params.set ("path", path.string ());
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler, j);
+            expect (! backend->canFetchBatch (), "Should not be sealed");
+            storeBatch (*backend, batch);
+        }
+        expect (boost::filesystem::exists (path / "mapped.key"),
+            "Should be sealed");
+
+        auto backend = Manager::instance().make_Backend (
+            params, scheduler, j);
+        expect (backend->canFetchBatch (), "Should be sealed");
+        backend->verify ();
+
+        try
+        {
+            backend->store (batch.front ());
+            fail ("Should be read only");
+        }
+        catch (std::logic_error const&)
+        {
+            pass ();
+        }
+
+        // Visit half the key space, in order
+        uint256 first;
+        uint256 last;
+        first.zero ();
+        std::fill (last.begin (), last.end (), 0xff);
+        last.begin ()[0] = 0x7f;
+
+        Batch expected;
+        for (auto const& object : batch)
+            if (object->getHash () <= last)
+                expected.push_back (object);
+        std::sort (expected.begin (), expected.end (), LessThan{});
+
+        Batch visited;
+        backend->for_each (first, last,
+            [&visited](std::shared_ptr<NodeObject> object)
+            {
+                visited.push_back (std::move (object));
+                return true;
+            });
+        expect (areBatchesEqual (expected, visited), "Should be equal");
+    }
+
+    void testResume (std::int64_t const seedValue)
+    {
+        testcase ("resume");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory node_db ("node_db");
+        auto const path = boost::filesystem::path (
+            node_db.getFullPathName ().toStdString ());
+        Section params;
+        params.set ("type", "mapped");
+        params.set ("path", path.string ());
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, seedValue);
+        Batch firstHalf (batch.begin (), batch.begin () + batch.size () / 2);
+        Batch secondHalf (batch.begin () + batch.size () / 2, batch.end ());
+
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler, j);
+            storeBatch (*backend, firstHalf);
+        }
+
+        // Pretend the server stopped before sealing,
+        // in the middle of writing a record
+        boost::filesystem::remove (path / "mapped.key");
+        {
+            std::ofstream out ((path / "mapped.dat").string (),
+                std::ios::binary | std::ios::app);
+            out << "partial record";
+        }
+
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler, j);
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, firstHalf);
+            expect (areBatchesEqual (firstHalf, copy), "Should be kept");
+            storeBatch (*backend, secondHalf);
+        }
+
+        auto backend = Manager::instance().make_Backend (
+            params, scheduler, j);
+        backend->verify ();
+        Batch copy;
+        fetchCopyOfBatch (*backend, &copy, batch);
+        expect (areBatchesEqual (batch, copy), "Should be equal");
+    }
+
+    void run ()
+    {
+        std::int64_t const seedValue = 50;
+
+        testSealed (seedValue);
+        testResume (seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MappedBackend,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/impl/ReadScheduler.h>
+#include <ripple/nodestore/ScopedReadPriority.h>
+#include <beast/unit_test/suite.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+class ReadScheduler_test : public beast::unit_test::suite
+{
+public:
+    // Holds the read threads until released
+    class Gate
+    {
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool open_ = false;
+
+    public:
+        void wait ()
+        {
+            std::unique_lock <std::mutex> lock (mutex_);
+            while (! open_)
+                cond_.wait (lock);
+        }
+
+        void open ()
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            open_ = true;
+            cond_.notify_all ();
+        }
+    };
+
+    using Reads = std::vector <std::pair <uint256, FetchReport>>;
+
+    void testPriority ()
+    {
+        testcase ("priority");
+
+        Gate gate;
+        std::mutex mutex;
+        Reads reads;
+
+        ReadScheduler rs (1,
+            [&](uint256 const& hash, FetchReport const& report)
+            {
+                gate.wait ();
+                std::lock_guard <std::mutex> lock (mutex);
+                reads.emplace_back (hash, report);
+            });
+        expect (rs.threads () == 1);
+
+        // The first read holds the thread while the rest are queued
+        rs.post (uint256 (1), readNormal);
+        while (rs.size () != 0)
+            std::this_thread::yield ();
+
+        rs.post (uint256 (5), readBackground);
+        rs.post (uint256 (4), readBackground);
+        rs.post (uint256 (3), readNormal);
+        rs.post (uint256 (2), readUrgent);
+        rs.post (uint256 (6), readBackground);
+        rs.post (uint256 (2), readBackground);   // already queued
+        rs.post (uint256 (6), readUrgent);       // promoted
+        expect (rs.size () == 5);
+        expect (rs.size (readUrgent) == 2);
+        expect (rs.size (readNormal) == 1);
+        expect (rs.size (readBackground) == 2);
+
+        gate.open ();
+        rs.wait ();
+        expect (rs.size () == 0);
+
+        std::vector <uint256> const order = { uint256 (1), uint256 (2),
+            uint256 (6), uint256 (3), uint256 (4), uint256 (5) };
+        expect (reads.size () == order.size ());
+        for (std::size_t i = 0; i < std::min (reads.size (), order.size ()); ++i)
+        {
+            expect (reads[i].first == order[i], "wrong order");
+            expect (reads[i].second.isAsync);
+        }
+
+        expect (reads[1].second.priority == readUrgent);
+        expect (reads[1].second.queueDepth == 4);
+        expect (reads[5].second.priority == readBackground);
+        expect (reads[5].second.queueDepth == 0);
+    }
+
+    void testPostAndWait ()
+    {
+        testcase ("postAndWait");
+
+        std::mutex mutex;
+        std::vector <uint256> done;
+
+        ReadScheduler rs (4,
+            [&](uint256 const& hash, FetchReport const&)
+            {
+                std::lock_guard <std::mutex> lock (mutex);
+                done.push_back (hash);
+            });
+
+        std::vector <uint256> hashes;
+        for (int i = 0; i < 1000; ++i)
+            hashes.push_back (uint256 (i));
+
+        rs.postAndWait (hashes, ScopedReadPriority::get ());
+
+        std::lock_guard <std::mutex> lock (mutex);
+        std::sort (done.begin (), done.end ());
+        expect (done == hashes);
+    }
+
+    void testScopedPriority ()
+    {
+        testcase ("ScopedReadPriority");
+
+        expect (ScopedReadPriority::get () == readNormal);
+        {
+            ScopedReadPriority p1 (readBackground);
+            expect (ScopedReadPriority::get () == readBackground);
+            {
+                ScopedReadPriority p2 (readUrgent);
+                expect (ScopedReadPriority::get () == readUrgent);
+            }
+            expect (ScopedReadPriority::get () == readBackground);
+        }
+        expect (ScopedReadPriority::get () == readNormal);
+    }
+
+    void run ()
+    {
+        testPriority ();
+        testPostAndWait ();
+        testScopedPriority ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ReadScheduler,ripple_core,ripple);
+
+}
+}
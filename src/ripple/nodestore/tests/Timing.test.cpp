@@ -30,6 +30,7 @@
 #include <boost/algorithm/string.hpp>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -383,6 +384,75 @@ public:
         backend->close();
     }
 
+    // Fetch existing keys without creating NodeObjects
+    void
+    do_payload (Section const& config, Params const& params)
+    {
+        beast::Journal journal;
+        DummyScheduler scheduler;
+        auto backend = make_Backend (config, scheduler, journal);
+        expect (backend != nullptr);
+
+        class Body
+        {
+        private:
+            suite& suite_;
+            Backend& backend_;
+            Sequence seq1_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body (std::size_t id, suite& s,
+                    Params const& params, Backend& backend)
+                : suite_(s)
+                , backend_ (backend)
+                , seq1_ (1)
+                , gen_ (id + 1)
+                , dist_ (0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                try
+                {
+                    auto const obj = seq1_.obj(dist_(gen_));
+                    auto const& expected = obj->getData();
+                    bool same = false;
+                    backend_.fetchPayload(obj->getHash().data(),
+                        [&](NodeObjectType type,
+                            void const* data, std::size_t size)
+                        {
+                            same = type == obj->getType() &&
+                                size == expected.size() &&
+                                std::memcmp(data, expected.data(),
+                                    size) == 0;
+                        });
+                    suite_.expect (same);
+                }
+                catch(std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        try
+        {
+            parallel_for_id<Body>(params.items, params.threads,
+                std::ref(*this), std::ref(params), std::ref(*backend));
+        }
+        catch(...)
+        {
+        #if NODESTORE_TIMING_DO_VERIFY
+            backend->verify();
+        #endif
+            throw;
+        }
+        backend->close();
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing (Section const& config, Params const& params)
@@ -721,6 +791,7 @@ public:
             {
                  { "Insert",    &Timing_test::do_insert }
                 ,{ "Fetch",     &Timing_test::do_fetch }
+                ,{ "Payload",   &Timing_test::do_payload }
                 ,{ "Missing",   &Timing_test::do_missing }
                 ,{ "Mixed",     &Timing_test::do_mixed }
                 ,{ "Work",      &Timing_test::do_work }
@@ -0,0 +1,458 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/nodestore/tests/Base.test.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/Trace.h>
+#include <ripple/unity/rocksdb.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/thread.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace ripple {
+namespace NodeStore {
+
+class Trace_test : public TestBase
+{
+public:
+    static
+    std::string
+    tracePath (beast::UnitTestUtilities::TempDirectory const& dir)
+    {
+        boost::filesystem::path const path (
+            dir.getFullPathName ().toStdString ());
+        boost::filesystem::create_directories (path);
+        return (path / "trace").string ();
+    }
+
+    void testFile ()
+    {
+        testcase ("file");
+
+        beast::UnitTestUtilities::TempDirectory dir ("trace");
+        auto const path = tracePath (dir);
+
+        Batch batch;
+        createPredictableBatch (batch, 1000, 1);
+
+        {
+            auto const writer = TraceWriter::open (path, 0);
+            expect (writer == TraceWriter::open (path, 0), "Should be shared");
+            for (auto const& object : batch)
+                writer->append (TraceRecord::store, object->getType (),
+                    object->getData ().size (), object->getHash ().data ());
+        }
+
+        // Reopening appends
+        TraceWriter::open (path, 0)->append (TraceRecord::miss, hotUNKNOWN,
+            0, batch.front ()->getHash ().data ());
+
+        TraceReader reader (path);
+        TraceRecord record;
+        bool same = true;
+        for (auto const& object : batch)
+        {
+            same = same && reader.next (record) &&
+                record.op == TraceRecord::store &&
+                record.type == object->getType () &&
+                record.size == object->getData ().size () &&
+                record.key == object->getHash ();
+        }
+        expect (same, "Should read the records in order");
+        expect (reader.next (record) && record.op == TraceRecord::miss &&
+            record.key == batch.front ()->getHash (), "Should be appended");
+        expect (! reader.next (record), "Should end");
+
+        {
+            std::ofstream out (path, std::ios::trunc);
+            out << "not a trace";
+        }
+        try
+        {
+            TraceReader bad (path);
+            fail ("Should throw");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    void testRotate ()
+    {
+        testcase ("rotate");
+
+        beast::UnitTestUtilities::TempDirectory dir ("trace");
+        auto const path = tracePath (dir);
+
+        Batch batch;
+        createPredictableBatch (batch, 100, 1);
+
+        auto const count = [](std::string const& file)
+        {
+            TraceReader reader (file);
+            TraceRecord record;
+            std::size_t n = 0;
+            while (reader.next (record))
+                ++n;
+            return n;
+        };
+
+        auto const writer = TraceWriter::open (path,
+            10 * TraceWriter::recordBytes);
+        for (int i = 0; i < 3; ++i)
+        {
+            for (auto const& object : batch)
+                writer->append (TraceRecord::store, object->getType (),
+                    object->getData ().size (), object->getHash ().data ());
+            writer->flush ();
+        }
+        writer->append (TraceRecord::miss, hotUNKNOWN,
+            0, batch.front ()->getHash ().data ());
+        writer->flush ();
+
+        // Only the last full trace is kept
+        expect (count (path + ".1") == batch.size (), "Should be renamed");
+        expect (count (path) == 1, "Should start again");
+    }
+
+    void testBackend ()
+    {
+        testcase ("backend");
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+
+        beast::UnitTestUtilities::TempDirectory dir ("trace");
+        auto const path = tracePath (dir);
+
+        Section params;
+        params.set ("type", "memory");
+        params.set ("path", dir.getFullPathName ().toStdString ());
+        params.set ("trace", path);
+
+        Batch batch;
+        createPredictableBatch (batch, numObjectsToTest, 2);
+        Batch others;
+        createPredictableBatch (others, 100, 3);
+
+        {
+            auto backend = Manager::instance ().make_Backend (
+                params, scheduler, j);
+            storeBatch (*backend, batch);
+
+            Batch copy;
+            fetchCopyOfBatch (*backend, &copy, batch);
+            fetchMissing (*backend, others);
+            backend->close ();
+        }
+
+        std::map <TraceRecord::Op, std::size_t> counts;
+        std::size_t sizes = 0;
+        TraceReader reader (path);
+        TraceRecord record;
+        while (reader.next (record))
+        {
+            ++counts[record.op];
+            sizes += record.size;
+        }
+
+        std::size_t expected = 0;
+        for (auto const& object : batch)
+            expected += object->getData ().size ();
+
+        expect (counts[TraceRecord::store] == batch.size (), "Stores");
+        expect (counts[TraceRecord::fetch] == batch.size (), "Fetches");
+        expect (counts[TraceRecord::miss] == others.size (), "Misses");
+        expect (sizes == 2 * expected, "Sizes");
+    }
+
+    void run ()
+    {
+        testFile ();
+        testRotate ();
+        testBackend ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Trace,NodeStore,ripple);
+
+//------------------------------------------------------------------------------
+
+/*  Replays a trace against backends.
+
+    The argument is a list of sections separated by semicolons. The
+    section with a trace key gives the options, and each other section
+    configures a backend:
+
+        trace=/path/to/trace,threads=8;type=nudb;type=memory
+
+    Objects which the trace fetches before storing were in the database
+    when the trace began, so they are stored first. The backend is then
+    reopened, and the operations are shared out to the threads in trace
+    order. Payloads have the traced sizes and random contents.
+
+    Stores can't be replayed against a read only backend such as Mapped.
+*/
+class Replay_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // Latencies in microseconds
+    using Latencies = std::vector <std::uint32_t>;
+
+    static
+    std::shared_ptr<NodeObject>
+    makeObject (TraceRecord const& record)
+    {
+        std::uint64_t seed;
+        std::memcpy (&seed, record.key.data (), sizeof (seed));
+        beast::xor_shift_engine gen (seed);
+        Blob value (record.size);
+        for (auto& b : value)
+            b = static_cast <std::uint8_t> (gen ());
+        return NodeObject::createObject (record.type,
+            std::move (value), record.key);
+    }
+
+    static
+    Section
+    parse (std::string const& s)
+    {
+        Section section;
+        std::vector <std::string> v;
+        boost::split (v, s, boost::algorithm::is_any_of (","));
+        section.append (v);
+        return section;
+    }
+
+    // Returns the latency below which the fraction p of operations fall
+    static
+    std::string
+    percentile (Latencies& v, double p)
+    {
+        if (v.empty ())
+            return "-";
+        auto const n = std::min (v.size () - 1,
+            static_cast <std::size_t> (p * v.size ()));
+        std::nth_element (v.begin (), v.begin () + n, v.end ());
+        return std::to_string (v[n]) + "us";
+    }
+
+    void
+    preload (Section const& config, std::vector <TraceRecord> const& trace)
+    {
+        DummyScheduler scheduler;
+        beast::Journal j;
+        auto backend = make_Backend (config, scheduler, j);
+
+        std::map <uint256, bool> seen;
+        Batch batch;
+        for (auto const& record : trace)
+        {
+            if (! seen.emplace (record.key, true).second)
+                continue;
+            if (record.op != TraceRecord::fetch)
+                continue;
+            batch.push_back (makeObject (record));
+            if (batch.size () >= batchWritePreallocationSize)
+            {
+                backend->storeBatch (batch);
+                batch.clear ();
+            }
+        }
+        if (! batch.empty ())
+            backend->storeBatch (batch);
+        backend->close ();
+    }
+
+    void
+    replay (Section const& config, std::vector <TraceRecord> const& trace,
+        std::size_t threads)
+    {
+        beast::UnitTestUtilities::TempDirectory dir ("replay_db");
+        Section params (config);
+        params.set ("path", dir.getFullPathName ().toStdString ());
+
+        preload (params, trace);
+
+        DummyScheduler scheduler;
+        beast::Journal j;
+        auto backend = make_Backend (params, scheduler, j);
+
+        std::vector <Latencies> fetches (threads);
+        std::vector <Latencies> stores (threads);
+        std::atomic <std::size_t> next (0);
+
+        auto const start = clock_type::now ();
+        {
+            std::vector <beast::unit_test::thread> t;
+            t.reserve (threads);
+            for (std::size_t id = 0; id < threads; ++id)
+            {
+                t.emplace_back (*this, [&, id]()
+                {
+                    auto& f = fetches[id];
+                    auto& s = stores[id];
+                    for (;;)
+                    {
+                        auto const i = next++;
+                        if (i >= trace.size ())
+                            break;
+                        auto const& record = trace[i];
+                        std::shared_ptr<NodeObject> object;
+                        if (record.op == TraceRecord::store)
+                            object = makeObject (record);
+
+                        auto const before = clock_type::now ();
+                        if (object)
+                            backend->store (object);
+                        else
+                            backend->fetch (record.key.data (), &object);
+                        auto const us = std::chrono::duration_cast <
+                            std::chrono::microseconds> (
+                                clock_type::now () - before).count ();
+
+                        (record.op == TraceRecord::store ? s : f).push_back (
+                            static_cast <std::uint32_t> (us));
+                    }
+                });
+            }
+            for (auto& _ : t)
+                _.join ();
+        }
+        backend->close ();
+        auto const elapsed = std::chrono::duration_cast <
+            std::chrono::duration <double>> (clock_type::now () - start);
+
+        Latencies f;
+        Latencies s;
+        for (std::size_t id = 0; id < threads; ++id)
+        {
+            f.insert (f.end (), fetches[id].begin (), fetches[id].end ());
+            s.insert (s.end (), stores[id].begin (), stores[id].end ());
+        }
+
+        using std::setw;
+        std::stringstream ss;
+        ss << std::left << setw (10) <<
+            get (config, "type", std::string ()) << std::right <<
+            setw (8) << threads <<
+            setw (12) << static_cast <std::uint64_t> (
+                trace.size () / std::max (elapsed.count (), 1e-6));
+        for (auto v : { &f, &s })
+            ss << setw (9) << percentile (*v, 0.5) <<
+                setw (9) << percentile (*v, 0.99) <<
+                setw (9) << percentile (*v, 0.999);
+        log << ss.str ();
+    }
+
+    void
+    run () override
+    {
+        testcase ("Replay", suite::abort_on_fail);
+
+        std::string default_backends =
+            "type=nudb"
+        #if RIPPLE_ROCKSDB_AVAILABLE
+            ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
+                "file_size_mb=8,file_size_mult=2"
+        #endif
+            ";type=memory";
+
+        std::vector <std::string> args;
+        boost::split (args, arg (), boost::algorithm::is_any_of (";"));
+
+        Section options;
+        std::vector <Section> configs;
+        for (auto const& s : args)
+        {
+            if (s.empty ())
+                continue;
+            auto section = parse (s);
+            if (section.exists ("trace"))
+                options = section;
+            else
+                configs.push_back (section);
+        }
+
+        auto const path = get <std::string> (options, "trace");
+        if (path.empty ())
+        {
+            fail ("Pass trace=<file> as the argument");
+            return;
+        }
+        if (configs.empty ())
+        {
+            std::vector <std::string> v;
+            boost::split (v, default_backends,
+                boost::algorithm::is_any_of (";"));
+            for (auto const& s : v)
+                configs.push_back (parse (s));
+        }
+
+        std::vector <TraceRecord> trace;
+        {
+            TraceReader reader (path);
+            TraceRecord record;
+            while (reader.next (record))
+                trace.push_back (record);
+        }
+
+        std::size_t threads = 0;
+        get_if_exists (options, "threads", threads);
+        std::vector <std::size_t> const counts = threads > 0 ?
+            std::vector <std::size_t> { threads } :
+                std::vector <std::size_t> { 1, 4, 8 };
+
+        log << trace.size () << " operations from " << path;
+        {
+            using std::setw;
+            std::stringstream ss;
+            ss << std::left << setw (10) << "Backend" << std::right <<
+                setw (8) << "Threads" << setw (12) << "Ops/s" <<
+                setw (9) << "Fetch50" << setw (9) << "99" <<
+                setw (9) << "99.9" << setw (9) << "Store50" <<
+                setw (9) << "99" << setw (9) << "99.9";
+            log << ss.str ();
+        }
+        for (auto const& config : configs)
+            for (auto n : counts)
+                replay (config, trace, n);
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Replay,NodeStore,ripple);
+
+}
+}
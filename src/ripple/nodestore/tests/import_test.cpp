@@ -23,16 +23,23 @@
 #include <beast/chrono/basic_seconds_clock.h>
 #include <beast/chrono/chrono_io.h>
 #include <beast/http/rfc2616.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <beast/nudb/api.h>
 #include <beast/nudb/create.h>
 #include <beast/nudb/detail/format.h>
+#include <beast/random/xor_shift_engine.h>
 #include <beast/unit_test/suite.h>
 #include <beast/utility/ci_char_traits.h>
+#include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <limits>
 #include <map>
 #include <sstream>
+#include <vector>
 
 #include <ripple/unity/rocksdb.h>
 
@@ -997,5 +1004,204 @@ public:
 
 BEAST_DEFINE_TESTSUITE_MANUAL(update,NodeStore,ripple);
 
+//------------------------------------------------------------------------------
+
+// Trains a dictionary on a NuDB store and compares how
+// well each nodeobject_compression does on its values.
+//
+class compress_test : public beast::unit_test::suite
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct totals
+    {
+        char const* name;
+        nodeobject_codec codec;
+        std::size_t bytes = 0;
+        clock_type::duration elapsed {};
+
+        totals (char const* name_, nodeobject_codec const& codec_)
+            : name (name_)
+            , codec (codec_)
+        {
+        }
+    };
+
+    static
+    bool
+    is_inner (void const* data, std::size_t size)
+    {
+        using namespace beast::nudb::detail;
+        if (size != 525)
+            return false;
+        istream is(data, size);
+        is(9);  // index, unused, kind
+        std::uint32_t prefix;
+        read<std::uint32_t>(is, prefix);
+        return prefix == HashPrefix::innerNode;
+    }
+
+    void
+    run() override
+    {
+        testcase(abort_on_fail) << arg();
+
+        using namespace beast::nudb;
+
+        pass();
+        auto const args = parse_args(arg());
+        bool usage = args.empty();
+
+        if (! usage &&
+            args.find("path") == args.end())
+        {
+            log <<
+                "Missing parameter: path";
+            usage = true;
+        }
+
+        if (usage)
+        {
+            log <<
+                "Usage:\n" <<
+                "--unittest-arg=path=<path>[,samples=<n>][,size=<n>]"
+                    "[,items=<n>][,dict=<dict>]\n" <<
+                "path:    NuDB database directory\n" <<
+                "samples: Values to train on (default 100000)\n" <<
+                "size:    Dictionary size in bytes (default 65536)\n" <<
+                "items:   Values to measure (default all)\n" <<
+                "dict:    File to save the dictionary to\n" <<
+                "To use the dictionary copy it to <path>/nudb.dict and\n"
+                "set compression=dictionary. Never change the dictionary\n"
+                "of a database once values are written with it.";
+            return;
+        }
+
+        auto const path = args.at("path");
+        auto const get = [&args](char const* name, std::size_t value)
+        {
+            auto const iter = args.find(name);
+            if (iter == args.end())
+                return value;
+            return static_cast<std::size_t>(
+                std::stoull(iter->second));
+        };
+        std::size_t const samples = get("samples", 100000);
+        std::size_t const size = get("size",
+            codec_dictionary::max_size);
+        std::size_t const items = get("items",
+            std::numeric_limits<std::size_t>::max());
+
+        using api = beast::nudb::api<
+            beast::xxhasher, nodeobject_codec>;
+        auto const dp = (boost::filesystem::path(
+            path) / "nudb.dat").string();
+        nodeobject_codec const current(
+            nodeobject_compression::lz4, load_dictionary(
+                (boost::filesystem::path(path) /
+                    "nudb.dict").string()));
+
+        log <<
+            "path:    " << path << "\n"
+            "samples: " << samples << "\n"
+            "size:    " << size;
+
+        // Pick the samples uniformly from the leaf values
+        std::vector<Blob> reservoir;
+        {
+            beast::xor_shift_engine gen;
+            std::size_t n = 0;
+            api::visit(dp,
+                [&](void const*, std::size_t,
+                    void const* data, std::size_t size)
+                {
+                    if (is_inner(data, size))
+                        return true;
+                    auto const p = reinterpret_cast<
+                        std::uint8_t const*>(data);
+                    if (reservoir.size() < samples)
+                        reservoir.emplace_back(p, p + size);
+                    else
+                    {
+                        auto const i = gen() % (n + 1);
+                        if (i < samples)
+                            reservoir[i].assign(p, p + size);
+                    }
+                    ++n;
+                    return true;
+                }, current);
+        }
+
+        auto const start = clock_type::now();
+        dictionary_trainer trainer;
+        for (auto const& v : reservoir)
+            trainer.add(v.data(), v.size());
+        auto const dict = trainer.train(size);
+        if (! dict)
+        {
+            log << "No values to train on";
+            return;
+        }
+        log <<
+            "Trained " << dict->size() << " byte dictionary on " <<
+                trainer.size() << " bytes in " << detail::fmtdur(
+                    clock_type::now() - start);
+        if (args.find("dict") != args.end())
+            save_dictionary(args.at("dict"), *dict);
+
+        std::vector<totals> results = {
+            { "none", nodeobject_codec(
+                nodeobject_compression::none) },
+            { "lz4", nodeobject_codec(
+                nodeobject_compression::lz4) },
+            { "dictionary", nodeobject_codec(
+                nodeobject_compression::dictionary, dict) } };
+
+        std::size_t n = 0;
+        std::size_t raw = 0;
+        beast::nudb::detail::buffer buf;
+        beast::nudb::detail::buffer buf2;
+        api::visit(dp,
+            [&](void const*, std::size_t,
+                void const* data, std::size_t size)
+            {
+                for (auto& r : results)
+                {
+                    auto const out = r.codec.compress(
+                        data, size, buf);
+                    r.bytes += out.second;
+                    auto const t0 = clock_type::now();
+                    auto const check = r.codec.decompress(
+                        out.first, out.second, buf2);
+                    r.elapsed += clock_type::now() - t0;
+                    expect(check.second == size &&
+                        std::memcmp(check.first, data, size) == 0,
+                            "codec error");
+                }
+                raw += size;
+                return ++n < items;
+            }, current);
+
+        log <<
+            n << " values, " << raw << " bytes";
+        for (auto const& r : results)
+        {
+            using namespace std::chrono;
+            std::stringstream ss;
+            ss << std::left << std::setw(12) << r.name <<
+                std::setw(16) << r.bytes << std::fixed <<
+                    std::setprecision(3) << std::setw(8) <<
+                        (r.bytes ? double(raw) / r.bytes : 0) <<
+                std::setprecision(1) << (double(raw) /
+                    (1 + duration_cast<microseconds>(
+                        r.elapsed).count())) << " MB/s decode";
+            log << ss.str();
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(compress,NodeStore,ripple);
+
 }
 }
@@ -19,6 +19,8 @@
 
 #include <BeastConfig.h>
 #include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/make_SSLContext.h>
@@ -29,6 +31,7 @@
 #include <ripple/overlay/impl/PeerImp.h>
 #include <ripple/overlay/impl/TMHello.h>
 #include <ripple/peerfinder/make_Manager.h>
+#include <ripple/protocol/Feature.h>
 #include <ripple/protocol/STExchange.h>
 #include <beast/ByteOrder.h>
 #include <beast/crypto/base64.h>
@@ -144,6 +147,19 @@ OverlayImpl::OverlayImpl (
         stopwatch(), deprecatedLogs().journal("PeerFinder"), config))
     , m_resolver (resolver)
     , next_id_(1)
+    , txVerifier_ (
+        [](std::function<void()> f)
+        {
+            getApp().getJobQueue().addJob (jtTRANSACTION,
+                "verifyTransactions", [f] (Job&) { f(); });
+        },
+        getApp().getHashRouter(),
+        []
+        {
+            return getApp().getLedgerMaster().getValidatedRules().enabled (
+                featureMultiSign, getConfig().features);
+        },
+        deprecatedLogs().journal("TxVerifier"))
     , timer_count_(0)
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
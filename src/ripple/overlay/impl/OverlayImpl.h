@@ -23,6 +23,7 @@
 #include <ripple/core/Job.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/impl/Manifest.h>
+#include <ripple/overlay/impl/TxVerifier.h>
 #include <ripple/server/Handoff.h>
 #include <ripple/server/ServerHandler.h>
 #include <ripple/basics/Resolver.h>
@@ -116,6 +117,7 @@ private:
     Resolver& m_resolver;
     std::atomic <Peer::id_t> next_id_;
     ManifestCache manifestCache_;
+    TxVerifier txVerifier_;
     int timer_count_;
 
     //--------------------------------------------------------------------------
@@ -155,6 +157,12 @@ public:
         return manifestCache_;
     }
 
+    TxVerifier&
+    txVerifier()
+    {
+        return txVerifier_;
+    }
+
     Setup const&
     setup() const
     {
@@ -1058,11 +1058,12 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
             }
         }
 
-        if (getApp().getJobQueue().getJobCount(jtTRANSACTION) > 100)
+        if (getApp().getJobQueue().getJobCount(jtTRANSACTION) > 100 ||
+                overlay_.txVerifier().size() > TxVerifier::maxQueued)
             p_journal_.info << "Transaction queue is full";
         else if (getApp().getLedgerMaster().getValidatedLedgerAge() > 240)
             p_journal_.trace << "No new transactions until synchronized";
-        else
+        else if (flags & SF_SIGGOOD)
         {
             std::weak_ptr<PeerImp> weak = shared_from_this();
             getApp().getJobQueue ().addJob (
@@ -1072,6 +1073,21 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
                         peer->checkTransaction(flags, stx);
                 });
         }
+        else
+        {
+            // The signature is checked in a batch with other transactions
+            std::weak_ptr<PeerImp> weak = shared_from_this();
+            overlay_.txVerifier().add (stx,
+                [weak, flags, stx] (bool good) {
+                    auto peer = weak.lock();
+                    if (! peer)
+                        return;
+                    if (good)
+                        peer->checkTransaction(flags | SF_SIGGOOD, stx);
+                    else
+                        peer->charge (Resource::feeInvalidSignature);
+                });
+        }
     }
     catch (...)
     {
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/TxVerifier.h>
+#include <ripple/app/tx/Transaction.h>
+#include <vector>
+
+namespace ripple {
+
+TxVerifier::TxVerifier (Post post, HashRouter& router,
+        std::function<bool()> allowMultiSign, beast::Journal journal)
+    : post_ (std::move (post))
+    , router_ (router)
+    , allowMultiSign_ (std::move (allowMultiSign))
+    , journal_ (journal)
+{
+}
+
+void
+TxVerifier::add (std::shared_ptr<STTx const> stx, Handler handler)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    queue_.emplace_back (std::move (stx), std::move (handler));
+
+    // Start another job only when the running ones have more than
+    // a batch each waiting for them.
+    // The job can't take from the queue until the lock is released,
+    // so it is only counted once it was added.
+    if (jobs_ < maxJobs &&
+        queue_.size () > static_cast<std::size_t> (jobs_) * batchSize)
+    {
+        post_ ([this] { run (); });
+        ++jobs_;
+    }
+}
+
+std::size_t
+TxVerifier::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return queue_.size ();
+}
+
+void
+TxVerifier::run ()
+{
+    std::vector<Item> batch;
+    batch.reserve (batchSize);
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            if (queue_.empty ())
+            {
+                --jobs_;
+                return;
+            }
+            while (! queue_.empty () && batch.size () < batchSize)
+            {
+                batch.push_back (std::move (queue_.front ()));
+                queue_.pop_front ();
+            }
+        }
+
+        bool const allowMultiSign = allowMultiSign_ ();
+
+        for (auto& item : batch)
+            item.second (verify (*item.first, allowMultiSign));
+
+        if (journal_.trace) journal_.trace <<
+            "Checked " << batch.size () << " transactions";
+        batch.clear ();
+    }
+}
+
+bool
+TxVerifier::verify (STTx const& stx, bool allowMultiSign)
+{
+    auto const id = stx.getTransactionID ();
+    bool good = false;
+    try
+    {
+        // Another peer's copy may have been checked since this one
+        // was queued, which the router's sigVerify remembers.
+        std::string reason;
+        good = checkValidity (stx, allowMultiSign,
+            router_.sigVerify (), reason);
+        if (! good && ! reason.empty ())
+        {
+            if (journal_.trace) journal_.trace <<
+                "Transaction " << id << " failed: " << reason;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        if (journal_.trace) journal_.trace <<
+            "Exception checking transaction " << id << ": " << e.what ();
+    }
+
+    // A transaction which fails the local checks is as bad
+    // as one with a bad signature.
+    if (! good)
+        router_.setFlags (id, SF_BAD);
+    return good;
+}
+
+} // ripple
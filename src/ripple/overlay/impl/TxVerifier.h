@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_TXVERIFIER_H_INCLUDED
+#define RIPPLE_OVERLAY_TXVERIFIER_H_INCLUDED
+
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/utility/Journal.h>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace ripple {
+
+/** Checks the signatures of transactions relayed by peers.
+
+    Transactions are queued and checked in batches by a few jobs, rather
+    than by a job each, so a flood of relayed transactions doesn't pay for
+    a job dispatch per transaction. The checks are those made by
+    constructing a Transaction with Validate::YES. The result is recorded
+    in the HashRouter as SF_SIGGOOD or SF_BAD, so a transaction is only
+    checked once.
+*/
+class TxVerifier
+{
+public:
+    enum
+    {
+        // Most transactions a job checks before taking more from the queue
+        batchSize = 64,
+
+        // Most jobs checking transactions at once
+        maxJobs = 4,
+
+        // Transactions waiting beyond which peers' transactions are dropped
+        maxQueued = 1000
+    };
+
+    /** Called with `true` if the transaction's signature is good. */
+    using Handler = std::function<void(bool)>;
+
+    /** Runs a function on a job. */
+    using Post = std::function<void(std::function<void()>)>;
+
+    /** Create a verifier.
+        @param post Starts the jobs which check transactions.
+        @param allowMultiSign Returns whether multi-signing is enabled.
+    */
+    TxVerifier (Post post, HashRouter& router,
+        std::function<bool()> allowMultiSign, beast::Journal journal);
+
+    TxVerifier (TxVerifier const&) = delete;
+    TxVerifier& operator= (TxVerifier const&) = delete;
+
+    /** Queue a transaction to be checked.
+        The handler is called from a job once the signature is checked.
+    */
+    void
+    add (std::shared_ptr<STTx const> stx, Handler handler);
+
+    /** Returns the number of transactions waiting to be checked. */
+    std::size_t
+    size () const;
+
+private:
+    using Item = std::pair<std::shared_ptr<STTx const>, Handler>;
+
+    void
+    run ();
+
+    bool
+    verify (STTx const& stx, bool allowMultiSign);
+
+    Post post_;
+    HashRouter& router_;
+    std::function<bool()> allowMultiSign_;
+    beast::Journal journal_;
+
+    std::mutex mutable mutex_;
+    std::deque<Item> queue_;
+    int jobs_ = 0;
+};
+
+} // ripple
+
+#endif
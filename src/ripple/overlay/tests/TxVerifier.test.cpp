@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/overlay/impl/TxVerifier.h>
+#include <ripple/protocol/STTx.h>
+#include <beast/unit_test/suite.h>
+#include <vector>
+
+namespace ripple {
+
+class TxVerifier_test : public beast::unit_test::suite
+{
+private:
+    RippleAddress publicKey_;
+    RippleAddress privateKey_;
+
+    // Returns a signed transaction, with a bad signature if requested.
+    std::shared_ptr<STTx const>
+    makeTx (std::uint32_t seq, bool good)
+    {
+        auto stx = std::make_shared<STTx> (ttACCOUNT_SET);
+        stx->setAccountID (sfAccount, calcAccountID (publicKey_));
+        stx->setSigningPubKey (publicKey_);
+        stx->setFieldU32 (sfSequence, seq);
+        stx->sign (privateKey_);
+        // Changing a field after signing breaks the signature
+        if (! good)
+            stx->setFieldU32 (sfSequence, seq + 1000000);
+        return stx;
+    }
+
+public:
+    void
+    testSignatures ()
+    {
+        HashRouter router (HashRouter::getDefaultHoldTime ());
+        std::vector<std::function<void()>> jobs;
+        TxVerifier verifier (
+            [&jobs](std::function<void()> f) { jobs.push_back (f); },
+            router, [] { return false; }, beast::Journal ());
+
+        auto const good = makeTx (1, true);
+        auto const bad = makeTx (2, false);
+
+        int called = 0;
+        verifier.add (good, [&](bool result)
+        {
+            ++called;
+            expect (result, "Good signature rejected");
+        });
+        verifier.add (bad, [&](bool result)
+        {
+            ++called;
+            expect (! result, "Bad signature accepted");
+        });
+
+        expect (jobs.size () == 1, "Expected one job");
+        expect (called == 0, "Checked before the job ran");
+        for (auto& job : jobs)
+            job ();
+        expect (called == 2, "Every handler should be called");
+
+        auto const goodFlags = router.getFlags (
+            good->getTransactionID ());
+        expect ((goodFlags & SF_SIGGOOD) && ! (goodFlags & SF_BAD),
+            "Good transaction should be marked SF_SIGGOOD");
+        auto const badFlags = router.getFlags (
+            bad->getTransactionID ());
+        expect ((badFlags & SF_BAD) && ! (badFlags & SF_SIGGOOD),
+            "Bad transaction should be marked SF_BAD");
+    }
+
+    void
+    testBatching ()
+    {
+        HashRouter router (HashRouter::getDefaultHoldTime ());
+        std::vector<std::function<void()>> jobs;
+        TxVerifier verifier (
+            [&jobs](std::function<void()> f) { jobs.push_back (f); },
+            router, [] { return false; }, beast::Journal ());
+
+        std::size_t const count = 200;
+        std::vector<int> calls (count);
+        std::size_t wrong = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            bool const good = (i % 3) != 0;
+            verifier.add (makeTx (static_cast<std::uint32_t> (i + 1), good),
+                [&calls, &wrong, i, good](bool result)
+                {
+                    ++calls[i];
+                    if (result != good)
+                        ++wrong;
+                });
+        }
+
+        // A job is started for each full batch waiting, up to the limit
+        expect (jobs.size () == 4, "Expected four jobs");
+        expect (verifier.size () == count, "Transactions should wait");
+
+        for (auto& job : jobs)
+            job ();
+        expect (verifier.size () == 0, "Transactions left unchecked");
+        expect (wrong == 0, "Transactions checked wrongly");
+        std::size_t once = 0;
+        for (auto n : calls)
+            if (n == 1)
+                ++once;
+        expect (once == count, "Every handler should be called once");
+
+        // The jobs have finished, so the next transaction starts one
+        jobs.clear ();
+        verifier.add (makeTx (count + 1, true), [](bool) {});
+        expect (jobs.size () == 1, "Expected a new job");
+        for (auto& job : jobs)
+            job ();
+        expect (verifier.size () == 0, "Transaction left unchecked");
+    }
+
+    void
+    run () override
+    {
+        RippleAddress seed;
+        seed.setSeedRandom ();
+        auto const generator = RippleAddress::createGeneratorPublic (seed);
+        publicKey_ = RippleAddress::createAccountPublic (generator, 1);
+        privateKey_ = RippleAddress::createAccountPrivate (
+            generator, seed, 1);
+
+        testSignatures ();
+        testBatching ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxVerifier,overlay,ripple);
+
+} // ripple
@@ -112,6 +112,7 @@ JSS ( command );                    // in: RPCHandler
 JSS ( comment );                    // in: UnlAdd
 JSS ( complete );                   // out: NetworkOPs, InboundLedger
 JSS ( complete_ledgers );           // out: NetworkOPs, PeerImp
+JSS ( complete_shards );            // out: GetCounts
 JSS ( consensus );                  // out: NetworkOPs, LedgerConsensus
 JSS ( converge_time );              // out: NetworkOPs
 JSS ( converge_time_s );            // out: NetworkOPs
@@ -248,6 +249,10 @@ JSS ( no_ripple );                  // out: AccountLines
 JSS ( no_ripple_peer );             // out: AccountLines
 JSS ( node );                       // in: UnlAdd, UnlDelete
 JSS ( node_binary );                // out: LedgerEntry
+JSS ( node_filter_building );       // out: GetCounts
+JSS ( node_filter_false_positives ); // out: GetCounts
+JSS ( node_filter_hits );           // out: GetCounts
+JSS ( node_filter_skips );          // out: GetCounts
 JSS ( node_hit_rate );              // out: GetCounts
 JSS ( node_read_bytes );            // out: GetCounts
 JSS ( node_reads_hit );             // out: GetCounts
@@ -387,6 +392,7 @@ JSS ( value );                      // out: STAmount
 JSS ( version );                    // out: RPCVersion
 JSS ( vetoed );                     // out: AmendmentTableImpl
 JSS ( vote );                       // in: Feature
+JSS ( warming_cache );              // out: NetworkOPs
 JSS ( warning );                    // rpc:
 JSS ( write_load );                 // out: GetCounts
 
@@ -23,6 +23,7 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/basics/UptimeTimer.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/json/json_value.h>
@@ -127,6 +128,21 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::node_written_bytes] = app.getNodeStore().getStoreSize();
     ret[jss::node_read_bytes] = app.getNodeStore().getFetchSize();
 
+    auto const filter = app.getNodeStore().getFilterCounts();
+    if (filter.filters > 0)
+    {
+        ret[jss::node_filter_building] = filter.building;
+        ret[jss::node_filter_skips] = static_cast<Json::UInt> (
+            filter.skipped);
+        ret[jss::node_filter_hits] = static_cast<Json::UInt> (
+            filter.hits);
+        ret[jss::node_filter_false_positives] = static_cast<Json::UInt> (
+            filter.falsePositives);
+    }
+
+    if (auto const shards = app.getSHAMapStore().getShardStore())
+        ret[jss::complete_shards] = shards->getCompleteShards();
+
     return ret;
 }
 
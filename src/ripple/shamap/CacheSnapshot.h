@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAP_CACHESNAPSHOT_H_INCLUDED
+#define RIPPLE_SHAMAP_CACHESNAPSHOT_H_INCLUDED
+
+#include <ripple/shamap/Family.h>
+#include <beast/utility/Journal.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** Saves and restores the working set of the tree node cache.
+
+    On shutdown the hashes of the nodes in the tree node cache are
+    written to a file. On the next start the nodes are read back from
+    the node store in batches on a background thread, so the first
+    ledgers after a restart find them in memory.
+
+    A snapshot only names nodes, it doesn't hold them, so one written
+    before a crash or for another database is harmless: nodes which
+    can't be found are skipped.
+*/
+class CacheSnapshot
+{
+public:
+    enum
+    {
+        // Number of nodes read from the node store at once
+        batchSize = 256
+    };
+
+    CacheSnapshot (shamap::Family& family, std::string const& path,
+        beast::Journal journal);
+
+    /** Stop and wait for the thread. */
+    ~CacheSnapshot ();
+
+    CacheSnapshot (CacheSnapshot const&) = delete;
+    CacheSnapshot& operator= (CacheSnapshot const&) = delete;
+
+    /** Write the hashes of the cached nodes to the file.
+        @return The number of hashes written.
+    */
+    std::size_t
+    save ();
+
+    /** Start loading the saved nodes on a thread and return.
+        @param onDone Called on the thread when loading ends.
+    */
+    void
+    start (std::function<void()> onDone = nullptr);
+
+    /** Ask the thread to stop soon. */
+    void
+    stop ();
+
+    /** Wait for the thread to finish. */
+    void
+    wait ();
+
+    /** Load the saved nodes, returning when done or stopped. */
+    void
+    run ()
+    {
+        start ();
+        wait ();
+    }
+
+    /** Returns the number of nodes put in the cache so far. */
+    std::uint64_t
+    loaded () const
+    {
+        return loaded_;
+    }
+
+private:
+    void
+    load (std::function<void()> onDone);
+
+    void
+    fetch (std::vector<uint256> const& keys);
+
+    shamap::Family& family_;
+    std::string const path_;
+    beast::Journal journal_;
+
+    std::thread thread_;
+    std::atomic<bool> stop_ {false};
+    std::atomic<std::uint64_t> loaded_ {0};
+};
+
+} // ripple
+
+#endif
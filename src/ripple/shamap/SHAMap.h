@@ -203,7 +203,15 @@ public:
     bool compare (SHAMap const& otherMap,
                   Delta& differences, int maxCount) const;
 
-    int flushDirty (NodeObjectType t, std::uint32_t seq);
+    /** Convert all modified nodes to shared nodes and write them.
+
+        When `threads` is greater than one, the dirty subtrees below
+        the root are hashed and written concurrently. The resulting
+        tree and hashes are identical to a serial flush.
+
+        @return The number of nodes flushed.
+    */
+    int flushDirty (NodeObjectType t, std::uint32_t seq, int threads = 1);
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
     bool deepCompare (SHAMap & other) const;
 
@@ -232,6 +240,8 @@ private:
 
     // database operations
     std::shared_ptr<SHAMapAbstractNode> fetchNodeFromDB (uint256 const& hash) const;
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> fetchNodesFromDB (
+        std::vector<uint256> const& hashes) const;
     std::shared_ptr<SHAMapAbstractNode> fetchNodeNT (uint256 const& hash) const;
     std::shared_ptr<SHAMapAbstractNode> fetchNodeNT (
         SHAMapNodeID const& id,
@@ -276,6 +286,10 @@ private:
     std::shared_ptr<SHAMapAbstractNode> descend (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
     std::shared_ptr<SHAMapAbstractNode> descendThrow (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
+    // Hook up all the children of the specified node that we have,
+    // reading the ones which aren't cached with one batch
+    void descendAll (SHAMapInnerNode*) const;
+
     // Descend with filter
     SHAMapAbstractNode* descendAsync (SHAMapInnerNode* parent, int branch,
         SHAMapNodeID const& childID, SHAMapSyncFilter* filter, bool& pending) const;
@@ -301,6 +315,9 @@ private:
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
                      bool isFirstMap, Delta & differences, int & maxCount) const;
     int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int walkSubTreeParallel (NodeObjectType t, std::uint32_t seq, int threads);
+    int flushInner (std::shared_ptr<SHAMapInnerNode>& node,
+                    bool doWrite, NodeObjectType t, std::uint32_t seq) const;
 };
 
 inline
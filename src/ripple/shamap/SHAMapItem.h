@@ -41,6 +41,7 @@ public:
     SHAMapItem (uint256 const& tag, Blob const & data);
     SHAMapItem (uint256 const& tag, Serializer const& s);
     SHAMapItem (uint256 const& tag, Serializer&& s);
+    SHAMapItem (uint256 const& tag, Slice const& data);
 
     Slice slice() const;
 
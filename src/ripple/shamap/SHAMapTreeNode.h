@@ -25,6 +25,8 @@
 #include <ripple/basics/TaggedCache.h>
 #include <beast/utility/Journal.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -79,10 +81,21 @@ public:
     virtual std::string getString (SHAMapNodeID const&) const;
     virtual std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const = 0;
 
+    /** Parse a node.
+        The node doesn't refer to rawNode once this returns, so it
+        may be memory owned by a backend.
+    */
     static std::shared_ptr<SHAMapAbstractNode>
-        make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat format,
+        make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
              uint256 const& hash, bool hashValid);
 
+    static std::shared_ptr<SHAMapAbstractNode>
+        make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat format,
+             uint256 const& hash, bool hashValid)
+    {
+        return make (makeSlice (rawNode), seq, format, hash, hashValid);
+    }
+
     // debugging
 #ifdef BEAST_DEBUG
     static void dump (SHAMapNodeID const&, beast::Journal journal);
@@ -92,12 +105,52 @@ public:
 class SHAMapInnerNode
     : public SHAMapAbstractNode
 {
-    uint256                         mHashes[16];
-    std::shared_ptr<SHAMapAbstractNode> mChildren[16];
-    int                             mIsBranch = 0;
+    // The hash and child of one branch
+    //
+    // Once a node is shared (sequence zero) its children can only go
+    // from unset to set, and then never change. A child is published
+    // by storing its address with release semantics after child has
+    // been assigned, so readers never need a lock: if they see a
+    // non-null address, child is complete and will not be modified.
+    struct Slot
+    {
+        uint256                                     hash;
+        std::shared_ptr<SHAMapAbstractNode>         child;
+        std::atomic<SHAMapAbstractNode*>            published;
+
+        Slot ();
+        Slot (Slot&& other);
+        Slot& operator= (Slot&& other);
+
+        void set (std::shared_ptr<SHAMapAbstractNode> const& node);
+    };
+
+    // Only branches in use have a slot. Nodes with few branches pack
+    // their slots in branch order (sparse). Once a node has more than
+    // maxSparse branches it switches to sixteen slots indexed directly
+    // by branch (dense), so busy nodes never shift slots around.
+    static int const                maxSparse = 8;
+
+    std::unique_ptr<Slot[]>         mSlots;
+    std::uint16_t                   mIsBranch = 0;
+    std::uint8_t                    mCapacity = 0;
     std::uint32_t                   mFullBelowGen = 0;
 
-    static std::mutex               childLock;
+    // Serializes publishing children, striped by node
+    static std::array<std::mutex, 64> childLocks;
+
+    static uint256 const& emptyHash ();
+    static int countBranches (unsigned mask);
+    static int capacityFor (int branches);
+
+    bool isDense () const;
+    int slotIndex (int m) const;
+    Slot& slot (int m);
+    Slot const& slot (int m) const;
+    void insertSlot (int m);
+    void eraseSlot (int m);
+    void setHashes (uint256 const* hashes);
+
 public:
     SHAMapInnerNode(std::uint32_t seq = 0);
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
@@ -124,7 +177,7 @@ public:
     std::string getString (SHAMapNodeID const&) const override;
 
     friend std::shared_ptr<SHAMapAbstractNode>
-        SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq,
+        SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
              SHANodeFormat format, uint256 const& hash, bool hashValid);
 };
 
@@ -252,12 +305,65 @@ SHAMapInnerNode::isEmptyBranch (int m) const
     return (mIsBranch & (1 << m)) == 0;
 }
 
+inline
+uint256 const&
+SHAMapInnerNode::emptyHash ()
+{
+    static uint256 const zero;
+    return zero;
+}
+
+inline
+int
+SHAMapInnerNode::countBranches (unsigned mask)
+{
+    mask = mask - ((mask >> 1) & 0x5555);
+    mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+    mask = (mask + (mask >> 4)) & 0x0F0F;
+    return (mask + (mask >> 8)) & 0x1F;
+}
+
+inline
+bool
+SHAMapInnerNode::isDense () const
+{
+    return mCapacity == 16;
+}
+
+inline
+int
+SHAMapInnerNode::slotIndex (int m) const
+{
+    if (isDense ())
+        return m;
+    // Sparse slots are ordered by branch
+    return countBranches (mIsBranch & ((1u << m) - 1));
+}
+
+inline
+SHAMapInnerNode::Slot&
+SHAMapInnerNode::slot (int m)
+{
+    assert (!isEmptyBranch (m));
+    return mSlots[slotIndex (m)];
+}
+
+inline
+SHAMapInnerNode::Slot const&
+SHAMapInnerNode::slot (int m) const
+{
+    assert (!isEmptyBranch (m));
+    return mSlots[slotIndex (m)];
+}
+
 inline
 uint256 const&
 SHAMapInnerNode::getChildHash (int m) const
 {
     assert ((m >= 0) && (m < 16) && (getType() == tnINNER));
-    return mHashes[m];
+    if (isEmptyBranch (m))
+        return emptyHash ();
+    return slot (m).hash;
 }
 
 inline
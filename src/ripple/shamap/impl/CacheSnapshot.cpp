@@ -0,0 +1,192 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/shamap/CacheSnapshot.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+#include <beast/threads/Thread.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace ripple {
+
+// The file is the signature followed by the sorted 32 byte node hashes.
+static char const snapshotSignature[8] =
+    { 'R', 'I', 'P', 'L', 'W', 'R', 'M', '1' };
+
+CacheSnapshot::CacheSnapshot (shamap::Family& family,
+        std::string const& path, beast::Journal journal)
+    : family_ (family)
+    , path_ (path)
+    , journal_ (journal)
+{
+}
+
+CacheSnapshot::~CacheSnapshot ()
+{
+    stop ();
+    wait ();
+}
+
+std::size_t
+CacheSnapshot::save ()
+{
+    auto keys = family_.treecache ().getKeys ();
+
+    // Sorted keys are read back in order, which
+    // suits backends that keep keys in order.
+    std::sort (keys.begin (), keys.end ());
+
+    // Write a new file and move it into place, so a crash
+    // while writing leaves the previous snapshot alone.
+    std::string const temp = path_ + ".tmp";
+    {
+        std::ofstream out (temp, std::ios::binary | std::ios::trunc);
+        out.write (snapshotSignature, sizeof (snapshotSignature));
+        for (auto const& key : keys)
+            out.write (reinterpret_cast<char const*> (
+                key.begin ()), key.size ());
+        out.close ();
+        if (! out)
+            throw std::runtime_error (
+                "shamap: can't write cache snapshot '" + temp + "'");
+    }
+    // Replaces the previous snapshot in one step
+    boost::system::error_code ec;
+    boost::filesystem::rename (temp, path_, ec);
+    if (ec)
+        throw std::runtime_error (
+            "shamap: can't write cache snapshot '" + path_ + "'");
+
+    if (journal_.info) journal_.info <<
+        "Saved " << keys.size () << " cached nodes to '" << path_ << "'";
+    return keys.size ();
+}
+
+void
+CacheSnapshot::start (std::function<void()> onDone)
+{
+    assert (! thread_.joinable ());
+    stop_ = false;
+    thread_ = std::thread (&CacheSnapshot::load, this, std::move (onDone));
+}
+
+void
+CacheSnapshot::stop ()
+{
+    stop_ = true;
+}
+
+void
+CacheSnapshot::wait ()
+{
+    if (thread_.joinable ())
+        thread_.join ();
+}
+
+void
+CacheSnapshot::load (std::function<void()> onDone)
+{
+    beast::Thread::setCurrentThreadName ("warm cache");
+
+    try
+    {
+        std::ifstream in (path_, std::ios::binary);
+        char signature[sizeof (snapshotSignature)];
+        if (! in.is_open ())
+        {
+            if (journal_.info) journal_.info <<
+                "No cache snapshot at '" << path_ << "'";
+        }
+        else if (! in.read (signature, sizeof (signature)) ||
+            std::memcmp (signature, snapshotSignature,
+                sizeof (signature)) != 0)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Ignoring '" << path_ << "', it isn't a cache snapshot";
+        }
+        else
+        {
+            auto& cache = family_.treecache ();
+            std::vector<uint256> keys;
+            keys.reserve (batchSize);
+
+            uint256 key;
+            while (! stop_ && in.read (
+                reinterpret_cast<char*> (key.begin ()), key.size ()))
+            {
+                if (cache.refreshIfPresent (key))
+                    continue;
+                keys.push_back (key);
+                if (keys.size () >= batchSize)
+                {
+                    fetch (keys);
+                    keys.clear ();
+                }
+            }
+            if (! stop_ && ! keys.empty ())
+                fetch (keys);
+
+            if (journal_.info) journal_.info <<
+                (stop_ ? "Stopped loading" : "Loaded") << " cache snapshot, " <<
+                    loaded_ << " nodes";
+        }
+    }
+    catch (std::exception const& e)
+    {
+        if (journal_.warning) journal_.warning <<
+            "Can't load cache snapshot: " << e.what ();
+    }
+
+    if (onDone)
+        onDone ();
+}
+
+void
+CacheSnapshot::fetch (std::vector<uint256> const& keys)
+{
+    auto const objects = family_.db ().fetchBatch (keys);
+    for (std::size_t i = 0; i < keys.size (); ++i)
+    {
+        if (! objects[i])
+            continue;
+
+        try
+        {
+            auto node = SHAMapAbstractNode::make (objects[i]->getData (),
+                0, snfPREFIX, keys[i], true);
+            if (node)
+            {
+                family_.treecache ().canonicalize (keys[i], node);
+                ++loaded_;
+            }
+        }
+        catch (std::exception const&)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Invalid DB node " << keys[i];
+        }
+    }
+}
+
+} // ripple
@@ -19,7 +19,12 @@
 
 #include <BeastConfig.h>
 #include <ripple/shamap/SHAMap.h>
+#include <ripple/basics/WorkerPool.h>
 #include <beast/unit_test/suite.h>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <mutex>
 
 namespace ripple {
 
@@ -172,22 +177,31 @@ SHAMap::fetchNodeFromDB (uint256 const& hash) const
 
     if (backed_)
     {
-        std::shared_ptr<NodeObject> obj = f_.db().fetch (hash);
-        if (obj)
-        {
-            try
+        // The node is parsed straight from the backend's buffer
+        bool invalid = false;
+        bool const found = f_.db().fetchPayload (hash,
+            [&](NodeObjectType, void const* data, std::size_t size)
             {
-                node = SHAMapAbstractNode::make(obj->getData(),
-                    0, snfPREFIX, hash, true);
-                if (node)
-                    canonicalize (hash, node);
-            }
-            catch (...)
-            {
-                if (journal_.warning) journal_.warning <<
-                    "Invalid DB node " << hash;
-                return std::shared_ptr<SHAMapTreeNode> ();
-            }
+                try
+                {
+                    node = SHAMapAbstractNode::make(
+                        Slice (data, size), 0, snfPREFIX, hash, true);
+                }
+                catch (...)
+                {
+                    invalid = true;
+                }
+            });
+        if (invalid)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Invalid DB node " << hash;
+            return std::shared_ptr<SHAMapTreeNode> ();
+        }
+        if (found)
+        {
+            if (node)
+                canonicalize (hash, node);
         }
         else if (ledgerSeq_ != 0)
         {
@@ -199,6 +213,39 @@ SHAMap::fetchNodeFromDB (uint256 const& hash) const
     return node;
 }
 
+// Read a group of nodes with one batch, nullptr for each one we don't have
+std::vector<std::shared_ptr<SHAMapAbstractNode>>
+SHAMap::fetchNodesFromDB (std::vector<uint256> const& hashes) const
+{
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> nodes (hashes.size ());
+
+    if (!backed_ || hashes.empty ())
+        return nodes;
+
+    auto const objects = f_.db().fetchBatch (hashes);
+    for (std::size_t i = 0; i < hashes.size (); ++i)
+    {
+        if (!objects[i])
+            continue;
+
+        try
+        {
+            nodes[i] = SHAMapAbstractNode::make(objects[i]->getData(),
+                0, snfPREFIX, hashes[i], true);
+            if (nodes[i])
+                canonicalize (hashes[i], nodes[i]);
+        }
+        catch (...)
+        {
+            if (journal_.warning) journal_.warning <<
+                "Invalid DB node " << hashes[i];
+            nodes[i].reset ();
+        }
+    }
+
+    return nodes;
+}
+
 // See if a sync filter has a node
 std::shared_ptr<SHAMapAbstractNode>
 SHAMap::checkFilter(uint256 const& hash, SHAMapNodeID const& id,
@@ -319,6 +366,35 @@ SHAMap::descend (std::shared_ptr<SHAMapInnerNode> const& parent, int branch) con
 
 // Gets the node that would be hooked to this branch,
 // but doesn't hook it up.
+void
+SHAMap::descendAll (SHAMapInnerNode* parent) const
+{
+    std::vector<uint256> want;
+    std::vector<int> branches;
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (parent->isEmptyBranch (branch) || parent->getChildPointer (branch))
+            continue;
+
+        uint256 const& hash = parent->getChildHash (branch);
+        std::shared_ptr<SHAMapAbstractNode> node = getCache (hash);
+        if (node)
+            parent->canonicalizeChild (branch, std::move(node));
+        else
+        {
+            want.push_back (hash);
+            branches.push_back (branch);
+        }
+    }
+
+    auto nodes = fetchNodesFromDB (want);
+    for (std::size_t i = 0; i < nodes.size (); ++i)
+    {
+        if (nodes[i])
+            parent->canonicalizeChild (branches[i], std::move(nodes[i]));
+    }
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMap::descendNoStore (std::shared_ptr<SHAMapInnerNode> const& parent, int branch) const
 {
@@ -945,8 +1021,10 @@ int SHAMap::unshare ()
 
 /** Convert all modified nodes to shared nodes */
 // If requested, write them to the node store
-int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
+int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq, int threads)
 {
+    if (threads > 1 && backed_)
+        return walkSubTreeParallel (t, seq, threads);
     return walkSubTree (true, t, seq);
 }
 
@@ -954,7 +1032,6 @@ int
 SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 {
     int flushed = 0;
-    Serializer s;
 
     if (!root_ || (root_->getSeq() == 0))
         return flushed;
@@ -970,13 +1047,28 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
     if (node->isEmpty())
         return flushed;
 
+    node = preFlushNode(std::move(node));
+    flushed = flushInner (node, doWrite, t, seq);
+
+    // Last inner node is the new root_
+    root_ = std::move (node);
+
+    return flushed;
+}
+
+// Flush every modified node below an inner node we own, then the
+// inner node itself. On return, node refers to the flushed node.
+int
+SHAMap::flushInner (std::shared_ptr<SHAMapInnerNode>& node,
+    bool doWrite, NodeObjectType t, std::uint32_t seq) const
+{
+    int flushed = 0;
+
     // Stack of {parent,index,child} pointers representing
     // inner nodes we are in the process of flushing
     using StackEntry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
-
     int pos = 0;
 
     // We can't flush an inner node until we flush its children
@@ -1054,10 +1146,109 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         ++pos;
     }
 
-    // Last inner node is the new root_
+    return flushed;
+}
+
+// Flush the modified subtrees below the root on a pool of threads.
+//
+// Every node with a non-zero sequence belongs to this map alone, so
+// the subtrees below the root can be hashed and written independently.
+// The tree node cache and the node store do their own locking. Once
+// all subtrees are done they are hooked back to the root in branch
+// order, giving exactly the same result as walkSubTree.
+int
+SHAMap::walkSubTreeParallel (NodeObjectType t, std::uint32_t seq, int threads)
+{
+    if (!root_ || (root_->getSeq() == 0) || root_->isLeaf())
+        return walkSubTree (true, t, seq);
+
+    auto node = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    if (node->isEmpty())
+        return 0;
+
+    node = preFlushNode(std::move(node));
+
+    std::array<std::shared_ptr<SHAMapInnerNode>, 16> subtrees;
+    std::array<int, 16> counts;
+    counts.fill (0);
+    std::vector<int> work;
+
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (node->isEmptyBranch (branch))
+            continue;
+
+        auto child = node->getChild (branch);
+        if (!child || (child->getSeq() == 0))
+            continue;
+
+        child = preFlushNode(std::move(child));
+
+        if (child->isInner ())
+        {
+            subtrees[branch] =
+                std::static_pointer_cast<SHAMapInnerNode>(std::move(child));
+            work.push_back (branch);
+        }
+        else
+        {
+            // Leaves directly below the root are cheap, do them here
+            child->updateHash();
+            child = writeNode(t, seq, std::move(child));
+            node->shareChild (branch, child);
+            counts[branch] = 1;
+        }
+    }
+
+    std::atomic<std::size_t> next (0);
+    std::mutex errorLock;
+    std::exception_ptr error;
+
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            auto const i = next++;
+            if (i >= work.size())
+                return;
+            int const branch = work[i];
+            try
+            {
+                counts[branch] = flushInner (
+                    subtrees[branch], true, t, seq);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock (errorLock);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+
+    // Shared by every map, since flushes happen at each ledger close
+    static WorkerPool pool ("SHAMap flush");
+    pool.run (static_cast<int> (std::min<std::size_t> (
+        threads, work.size())), worker);
+
+    if (error)
+        std::rethrow_exception (error);
+
+    // Merge in branch order so the result is deterministic
+    int flushed = 0;
+    for (int branch = 0; branch < 16; ++branch)
+    {
+        if (subtrees[branch])
+            node->shareChild (branch, subtrees[branch]);
+        flushed += counts[branch];
+    }
+
+    node->updateHashDeep();
+    node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
+                                                               std::move(node)));
     root_ = std::move (node);
 
-    return flushed;
+    return flushed + 1;
 }
 
 void SHAMap::dump (bool hash) const
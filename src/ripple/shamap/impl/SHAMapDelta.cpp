@@ -19,6 +19,7 @@
 
 #include <BeastConfig.h>
 #include <ripple/shamap/SHAMap.h>
+#include <array>
 
 namespace ripple {
 
@@ -241,11 +242,34 @@ void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissi
         std::shared_ptr<SHAMapInnerNode> node = std::move (nodeStack.top());
         nodeStack.pop ();
 
+        // Read the children we don't have with one batch
+        std::array<std::shared_ptr<SHAMapAbstractNode>, 16> children;
+        std::vector<uint256> want;
+        std::vector<int> branches;
         for (int i = 0; i < 16; ++i)
         {
             if (!node->isEmptyBranch (i))
             {
-                std::shared_ptr<SHAMapAbstractNode> nextNode = descendNoStore (node, i);
+                children[i] = node->getChild (i);
+                if (!children[i])
+                    children[i] = getCache (node->getChildHash (i));
+                if (!children[i])
+                {
+                    want.push_back (node->getChildHash (i));
+                    branches.push_back (i);
+                }
+            }
+        }
+
+        auto fetched = fetchNodesFromDB (want);
+        for (std::size_t j = 0; j < fetched.size (); ++j)
+            children[branches[j]] = std::move (fetched[j]);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            if (!node->isEmptyBranch (i))
+            {
+                std::shared_ptr<SHAMapAbstractNode> const& nextNode = children[i];
 
                 if (nextNode)
                 {
@@ -43,4 +43,10 @@ SHAMapItem::SHAMapItem (uint256 const& tag, Serializer&& data)
 {
 }
 
+SHAMapItem::SHAMapItem (uint256 const& tag, Slice const& data)
+    : tag_ (tag)
+    , data_(data.data(), data.data() + data.size())
+{
+}
+
 } // ripple
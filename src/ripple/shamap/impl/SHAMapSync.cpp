@@ -113,6 +113,11 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
 /** Get a list of node IDs and hashes for nodes that are part of this SHAMap
     but not available locally.  The filter can hold alternate sources of
     nodes that are not permanently stored locally
+
+    The map is walked one level at a time. Children which are not hooked
+    up, cached or in the filter are collected and read from the database
+    together with Database::fetchBatch, so that the backend sees many
+    reads at once instead of a single outstanding read per traversal.
 */
 void
 SHAMap::getMissingNodes(std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>& hashes,
@@ -138,159 +143,198 @@ SHAMap::getMissingNodes(std::vector<SHAMapNodeID>& nodeIDs, std::vector<uint256>
         return;
     }
 
-    int const maxDefer = f_.db().getDesiredAsyncReadCount ();
+    std::size_t const maxDefer = std::max (1,
+        f_.db().getDesiredAsyncReadCount ());
 
     // Track the missing hashes we have found so far
     std::set <uint256> missingHashes;
 
-
-    while (1)
+    // An inner node which is not known to be full below. Nodes are kept
+    // by level so full below can be propagated once the walk is done.
+    struct Visit
     {
-        std::vector <std::tuple <SHAMapInnerNode*, int, SHAMapNodeID>> deferredReads;
-        deferredReads.reserve (maxDefer + 16);
+        SHAMapInnerNode* node;
+        int parent;         // index in the previous level
+        bool fullBelow;     // no partial node encountered below this node
+    };
 
-        using StackEntry = std::tuple<SHAMapInnerNode*, SHAMapNodeID, int, int, bool>;
-        std::stack <StackEntry, std::vector<StackEntry>> stack;
+    std::vector <std::vector <Visit>> levels;
+    levels.emplace_back (1, Visit {
+        static_cast<SHAMapInnerNode*>(root_.get()), -1, true });
+    std::vector <SHAMapNodeID> levelIDs (1);
 
-        // Traverse the map without blocking
+    // Reads waiting for the next batch: parent, branch, child ID
+    std::vector <std::tuple <int, int, SHAMapNodeID>> deferredReads;
+    deferredReads.reserve (maxDefer);
 
-        auto node = static_cast<SHAMapInnerNode*>(root_.get());
-        SHAMapNodeID nodeID;
+    bool done = false;
 
-        // The firstChild value is selected randomly so if multiple threads
-        // are traversing the map, each thread will start at a different
-        // (randomly selected) inner node.  This increases the likelihood
-        // that the two threads will produce different request sets (which is
-        // more efficient than sending identical requests).
-        int firstChild = rand() % 256;
-        int currentChild = 0;
-        bool fullBelow = true;
+    for (std::size_t depth = 0; !done && !levels[depth].empty (); ++depth)
+    {
+        levels.emplace_back ();
+        auto& current = levels[depth];
+        auto& next = levels[depth + 1];
+        std::vector <SHAMapNodeID> nextIDs;
 
-        do
+        auto missing = [&](int parent, SHAMapNodeID const& childID,
+            uint256 const& childHash)
         {
-            while (currentChild < 16)
+            current[parent].fullBelow = false;
+            if (missingHashes.insert (childHash).second)
             {
-                int branch = (firstChild + currentChild++) % 16;
-                if (!node->isEmptyBranch (branch))
-                {
-                    uint256 const& childHash = node->getChildHash (branch);
+                nodeIDs.push_back (childID);
+                hashes.push_back (childHash);
 
-                    if (missingHashes.count (childHash) != 0)
-                    {
-                        fullBelow = false;
-                    }
-                    else if (! backed_ || ! f_.fullbelow().touch_if_exists (childHash))
-                    {
-                        SHAMapNodeID childID = nodeID.getChildNodeID (branch);
-                        bool pending = false;
-                        auto d = descendAsync (node, branch, childID, filter, pending);
-
-                        if (!d)
-                        {
-                            if (!pending)
-                            { // node is not in the database
-                                nodeIDs.push_back (childID);
-                                hashes.push_back (childHash);
-
-                                if (--max <= 0)
-                                    return;
-                            }
-                            else
-                            {
-                                // read is deferred
-                                deferredReads.emplace_back (node, branch, childID);
-                            }
-
-                            fullBelow = false; // This node is not known full below
-                        }
-                        else if (d->isInner() &&
-                                 !static_cast<SHAMapInnerNode*>(d)->isFullBelow(generation))
-                        {
-                            stack.push (std::make_tuple (node, nodeID,
-                                          firstChild, currentChild, fullBelow));
-
-                            // Switch to processing the child node
-                            node = static_cast<SHAMapInnerNode*>(d);
-                            nodeID = childID;
-                            firstChild = rand() % 256;
-                            currentChild = 0;
-                            fullBelow = true;
-                        }
-                    }
-                }
+                if (--max <= 0)
+                    done = true;
             }
+        };
 
-            // We are done with this inner node (and thus all of its children)
+        auto found = [&](int parent, int branch, SHAMapNodeID const& childID,
+            std::shared_ptr<SHAMapAbstractNode> child)
+        {
+            child = current[parent].node->canonicalizeChild (
+                branch, std::move (child));
 
-            if (fullBelow)
-            { // No partial node encountered below this node
-                node->setFullBelowGen (generation);
-                if (backed_)
-                    f_.fullbelow().insert (node->getNodeHash ());
+            if (child->isInner () &&
+                !static_cast<SHAMapInnerNode*>(child.get())->isFullBelow(generation))
+            {
+                next.push_back (Visit {
+                    static_cast<SHAMapInnerNode*>(child.get()), parent, true });
+                nextIDs.push_back (childID);
             }
+        };
 
-            if (stack.empty ())
-                node = nullptr; // Finished processing the last node, we are done
-            else
-            { // Pick up where we left off (above this node)
-                bool was;
-                std::tie(node, nodeID, firstChild, currentChild, was) = stack.top ();
-                fullBelow = was && fullBelow; // was and still is
-                stack.pop ();
+        auto readDeferred = [&]()
+        {
+            std::vector <uint256> want;
+            want.reserve (deferredReads.size ());
+            for (auto const& read : deferredReads)
+                want.push_back (current[std::get<0>(read)].node->
+                    getChildHash (std::get<1>(read)));
+
+            auto const before = std::chrono::steady_clock::now();
+            auto nodes = fetchNodesFromDB (want);
+            auto const after = std::chrono::steady_clock::now();
+
+            // Process all deferred reads
+            int hits = 0;
+            for (std::size_t i = 0; i < want.size (); ++i)
+            {
+                auto const& read = deferredReads[i];
+                auto& child = nodes[i];
+
+                if (child)
+                {
+                    ++hits;
+                    found (std::get<0>(read), std::get<1>(read),
+                        std::get<2>(read), std::move (child));
+                }
+                else if (done)
+                    current[std::get<0>(read)].fullBelow = false;
+                else
+                    missing (std::get<0>(read), std::get<2>(read), want[i]);
             }
 
-        }
-        while ((node != nullptr) && (deferredReads.size () <= maxDefer));
+            auto const elapsed = std::chrono::duration_cast
+                <std::chrono::milliseconds> (after - before);
+            auto const process_time = std::chrono::duration_cast
+                <std::chrono::milliseconds> (std::chrono::steady_clock::now() - after);
 
-        // If we didn't defer any reads, we're done
-        if (deferredReads.empty ())
-            break;
+            if ((want.size () > 50) || (elapsed.count() > 50))
+                journal_.debug << "getMissingNodes reads " <<
+                    want.size () << " nodes (" << hits << " hits) in "
+                    << elapsed.count() << " + " << process_time.count()  << " ms";
 
-        auto const before = std::chrono::steady_clock::now();
-        f_.db().waitReads();
-        auto const after = std::chrono::steady_clock::now();
+            deferredReads.clear ();
+        };
 
-        auto const elapsed = std::chrono::duration_cast
-            <std::chrono::milliseconds> (after - before);
-        auto const count = deferredReads.size ();
-
-        // Process all deferred reads
-        int hits = 0;
-        for (auto const& node : deferredReads)
+        for (int i = 0; !done && i < static_cast<int>(current.size ()); ++i)
         {
-            auto parent = std::get<0>(node);
-            auto branch = std::get<1>(node);
-            auto const& nodeID = std::get<2>(node);
-            auto const& nodeHash = parent->getChildHash (branch);
+            auto node = current[i].node;
+
+            // The firstChild value is selected randomly so if multiple threads
+            // are traversing the map, each thread will start at a different
+            // (randomly selected) inner node.  This increases the likelihood
+            // that the two threads will produce different request sets (which is
+            // more efficient than sending identical requests).
+            int firstChild = rand() % 256;
 
-            auto nodePtr = fetchNodeNT(nodeID, nodeHash, filter);
-            if (nodePtr)
+            for (int currentChild = 0; !done && currentChild < 16; ++currentChild)
             {
-                ++hits;
-                if (backed_)
-                    canonicalize (nodeHash, nodePtr);
-                nodePtr = parent->canonicalizeChild (branch, std::move(nodePtr));
+                int branch = (firstChild + currentChild) % 16;
+                if (node->isEmptyBranch (branch))
+                    continue;
+
+                uint256 const& childHash = node->getChildHash (branch);
+
+                if (missingHashes.count (childHash) != 0)
+                {
+                    current[i].fullBelow = false;
+                    continue;
+                }
+
+                if (backed_ && f_.fullbelow().touch_if_exists (childHash))
+                    continue;
+
+                SHAMapNodeID childID = levelIDs[i].getChildNodeID (branch);
+
+                std::shared_ptr<SHAMapAbstractNode> child = node->getChild (branch);
+                if (!child)
+                    child = getCache (childHash);
+                if (!child && filter)
+                    child = checkFilter (childHash, childID, filter);
+
+                if (child)
+                    found (i, branch, childID, std::move (child));
+                else if (backed_)
+                {
+                    deferredReads.emplace_back (i, branch, childID);
+                    if (deferredReads.size () >= maxDefer)
+                        readDeferred ();
+                }
+                else
+                    missing (i, childID, childHash);
             }
-            else if ((max > 0) && (missingHashes.insert (nodeHash).second))
-            {
-                nodeIDs.push_back (nodeID);
-                hashes.push_back (nodeHash);
 
-                --max;
+            if (done)
+            {
+                // Nodes we didn't finish can't be known to be full below
+                for (int j = i; j < static_cast<int>(current.size ()); ++j)
+                    current[j].fullBelow = false;
             }
         }
 
-        auto const process_time = std::chrono::duration_cast
-            <std::chrono::milliseconds> (std::chrono::steady_clock::now() - after);
+        if (!deferredReads.empty ())
+            readDeferred ();
 
-        if ((count > 50) || (elapsed.count() > 50))
-            journal_.debug << "getMissingNodes reads " <<
-                count << " nodes (" << hits << " hits) in "
-                << elapsed.count() << " + " << process_time.count()  << " ms";
+        levelIDs = std::move (nextIDs);
+    }
 
-        if (max <= 0)
-            return;
+    // Inner nodes we never got to can't be known to be full below
+    if (done)
+    {
+        for (auto& visit : levels.back ())
+            visit.fullBelow = false;
+    }
 
+    // Propagate full below from the deepest level up to the root
+    for (std::size_t depth = levels.size (); depth-- > 0;)
+    {
+        for (auto const& visit : levels[depth])
+        {
+            if (!visit.fullBelow)
+            {
+                if (visit.parent >= 0)
+                    levels[depth - 1][visit.parent].fullBelow = false;
+            }
+            else
+            {
+                visit.node->setFullBelowGen (generation);
+                if (backed_)
+                    f_.fullbelow().insert (visit.node->getNodeHash ());
+            }
+        }
     }
 
     if (nodeIDs.empty ())
@@ -765,6 +809,7 @@ SHAMap::visitDifferences(SHAMap* have,
             return;
 
         // 2) push non-matching child inner nodes
+        descendAll (node);
         for (int i = 0; i < 16; ++i)
         {
             if (!node->isEmptyBranch (i))
@@ -25,13 +25,47 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <beast/module/core/text/LexicalCast.h>
+#include <algorithm>
 #include <mutex>
 
 #include <openssl/sha.h>
 
 namespace ripple {
 
-std::mutex SHAMapInnerNode::childLock;
+std::array<std::mutex, 64> SHAMapInnerNode::childLocks;
+
+SHAMapInnerNode::Slot::Slot ()
+    : published (nullptr)
+{
+}
+
+// Moving slots only happens while a node is still being built or
+// modified, which is never concurrent with readers.
+SHAMapInnerNode::Slot::Slot (Slot&& other)
+    : hash (other.hash)
+    , child (std::move (other.child))
+    , published (other.published.load (std::memory_order_relaxed))
+{
+    other.published.store (nullptr, std::memory_order_relaxed);
+}
+
+SHAMapInnerNode::Slot&
+SHAMapInnerNode::Slot::operator= (Slot&& other)
+{
+    hash = other.hash;
+    child = std::move (other.child);
+    published.store (other.published.load (std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    other.published.store (nullptr, std::memory_order_relaxed);
+    return *this;
+}
+
+void
+SHAMapInnerNode::Slot::set (std::shared_ptr<SHAMapAbstractNode> const& node)
+{
+    child = node;
+    published.store (node.get (), std::memory_order_release);
+}
 
 SHAMapAbstractNode::~SHAMapAbstractNode() = default;
 
@@ -42,13 +76,107 @@ SHAMapInnerNode::clone(std::uint32_t seq) const
     p->mHash = mHash;
     p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    std::memcpy(p->mHashes, mHashes, sizeof(mHashes));
-    std::unique_lock <std::mutex> lock(childLock);
+    p->mCapacity = capacityFor (getBranchCount ());
+    if (p->mCapacity != 0)
+        p->mSlots.reset (new Slot[p->mCapacity]);
     for (int i = 0; i < 16; ++i)
-        p->mChildren[i] = mChildren[i];
+    {
+        if (isEmptyBranch (i))
+            continue;
+        auto& from = slot (i);
+        auto& to = p->slot (i);
+        to.hash = from.hash;
+        // Another thread may be publishing this child right now, in
+        // which case the clone simply loads it again when needed.
+        if (from.published.load (std::memory_order_acquire))
+            to.set (from.child);
+    }
     return std::move(p);
 }
 
+// The smallest layout that holds this many branches
+int
+SHAMapInnerNode::capacityFor (int branches)
+{
+    assert ((branches >= 0) && (branches <= 16));
+    return (branches > maxSparse) ? 16 : branches;
+}
+
+// Make room for branch m, which must not be in use
+void
+SHAMapInnerNode::insertSlot (int m)
+{
+    assert (isEmptyBranch (m));
+    int const count = getBranchCount ();
+
+    if (count == mCapacity)
+    {
+        // Grow geometrically until the node goes dense
+        int const capacity = capacityFor (std::max (count + 1, 2 * count));
+        std::unique_ptr<Slot[]> slots (new Slot[capacity]);
+        for (int i = 0, j = 0; i < 16; ++i)
+        {
+            if (!isEmptyBranch (i))
+                slots[(capacity == 16) ? i : j++] = std::move (slot (i));
+        }
+        mSlots = std::move (slots);
+        mCapacity = capacity;
+    }
+
+    if (!isDense ())
+    {
+        int const index = slotIndex (m);
+        for (int i = count; i > index; --i)
+            mSlots[i] = std::move (mSlots[i - 1]);
+        mSlots[index] = Slot ();
+    }
+
+    mIsBranch |= (1 << m);
+}
+
+// Release the slot for branch m, which must be in use
+void
+SHAMapInnerNode::eraseSlot (int m)
+{
+    assert (!isEmptyBranch (m));
+
+    if (isDense ())
+    {
+        mSlots[m] = Slot ();
+    }
+    else
+    {
+        int const count = getBranchCount ();
+        for (int i = slotIndex (m); i + 1 < count; ++i)
+            mSlots[i] = std::move (mSlots[i + 1]);
+        mSlots[count - 1] = Slot ();
+    }
+
+    mIsBranch &= ~ (1 << m);
+}
+
+// Set up an empty node from the sixteen hashes of its serialized form
+void
+SHAMapInnerNode::setHashes (uint256 const* hashes)
+{
+    assert (mIsBranch == 0);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (hashes[i].isNonZero ())
+            mIsBranch |= (1 << i);
+    }
+
+    mCapacity = capacityFor (getBranchCount ());
+    mSlots.reset ((mCapacity != 0) ? new Slot[mCapacity] : nullptr);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (!isEmptyBranch (i))
+            slot (i).hash = hashes[i];
+    }
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMapTreeNode::clone(std::uint32_t seq) const
 {
@@ -73,7 +201,7 @@ SHAMapTreeNode::SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
 }
 
 std::shared_ptr<SHAMapAbstractNode>
-SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat format,
+SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
                          uint256 const& hash, bool hashValid)
 {
     if (format == snfWIRE)
@@ -82,7 +210,7 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             return {};
 
         Serializer s (rawNode.data(), rawNode.size() - 1);
-        int type = rawNode.back ();
+        int type = rawNode[rawNode.size () - 1];
         int len = s.getLength ();
 
         if ((type < 0) || (type > 4))
@@ -122,14 +250,12 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
             if (len != 512)
                 throw std::runtime_error ("invalid FI node");
 
-            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            uint256 hashes[16];
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i], i * 32);
+                s.get256 (hashes[i], i * 32);
 
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -138,8 +264,8 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
         }
         else if (type == 3)
         {
-            auto ret = std::make_shared<SHAMapInnerNode>(seq);
             // compressed inner
+            uint256 hashes[16];
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -147,10 +273,11 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
                     throw std::runtime_error ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     throw std::runtime_error ("invalid CI node");
-                s.get256 (ret->mHashes[pos], i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos], i * 33);
             }
+
+            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -192,25 +319,23 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
         prefix |= rawNode[2];
         prefix <<= 8;
         prefix |= rawNode[3];
-        Serializer s (rawNode.data() + 4, rawNode.size() - 4);
+        // Parsed in place, so the only copy is into the node
+        Slice const s = rawNode + 4;
 
         if (prefix == HashPrefix::transactionID)
         {
             auto item = std::make_shared<SHAMapItem const>(
-                sha512Half(makeSlice(rawNode)),
-                    s.peekData ());
+                sha512Half(rawNode), s);
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq);
         }
         else if (prefix == HashPrefix::leafNode)
         {
-            if (s.getLength () < 32)
+            if (s.size () < 32)
                 throw std::runtime_error ("short PLN node");
 
-            uint256 u;
-            s.get256 (u, s.getLength () - 32);
-            s.chop (32);
+            auto const u = uint256::fromVoid (s.data () + s.size () - 32);
 
             if (u.isZero ())
             {
@@ -218,23 +343,22 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
                 throw std::runtime_error ("invalid PLN node");
             }
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = std::make_shared<SHAMapItem const> (
+                u, Slice (s.data (), s.size () - 32));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq);
         }
         else if (prefix == HashPrefix::innerNode)
         {
-            if (s.getLength () != 512)
+            if (s.size () != 512)
                 throw std::runtime_error ("invalid PIN node");
-            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            uint256 hashes[16];
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i], i * 32);
+                hashes[i] = uint256::fromVoid (s.data () + i * 32);
 
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -244,13 +368,12 @@ SHAMapAbstractNode::make(Blob const& rawNode, std::uint32_t seq, SHANodeFormat f
         else if (prefix == HashPrefix::txNode)
         {
             // transaction with metadata
-            if (s.getLength () < 32)
+            if (s.size () < 32)
                 throw std::runtime_error ("short TXN node");
 
-            uint256 txID;
-            s.get256 (txID, s.getLength () - 32);
-            s.chop (32);
-            auto item = std::make_shared<SHAMapItem const> (txID, s.peekData ());
+            auto const txID = uint256::fromVoid (s.data () + s.size () - 32);
+            auto item = std::make_shared<SHAMapItem const> (
+                txID, Slice (s.data (), s.size () - 32));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq);
@@ -271,10 +394,17 @@ SHAMapInnerNode::updateHash()
     uint256 nh;
     if (mIsBranch != 0)
     {
+        uint256 hashes[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            if (!isEmptyBranch (i))
+                hashes[i] = slot (i).hash;
+        }
+
         // VFALCO This code assumes the layout of a base_uint
         nh = sha512Half(HashPrefix::innerNode,
-            Slice(reinterpret_cast<unsigned char const*>(mHashes),
-                sizeof (mHashes)));
+            Slice(reinterpret_cast<unsigned char const*>(hashes),
+                sizeof (hashes)));
     }
     if (nh == mHash)
         return false;
@@ -287,8 +417,11 @@ SHAMapInnerNode::updateHashDeep()
 {
     for (auto pos = 0; pos < 16; ++pos)
     {
-        if (mChildren[pos] != nullptr)
-            mHashes[pos] = mChildren[pos]->getNodeHash();
+        if (isEmptyBranch (pos))
+            continue;
+        auto& s = slot (pos);
+        if (s.child != nullptr)
+            s.hash = s.child->getNodeHash();
     }
     updateHash();
 }
@@ -345,7 +478,7 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             s.add32 (HashPrefix::innerNode);
 
             for (int i = 0; i < 16; ++i)
-                s.add256 (mHashes[i]);
+                s.add256 (getChildHash (i));
         }
         else
         {
@@ -355,7 +488,7 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
                 for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i]);
+                        s.add256 (getChildHash (i));
                         s.add8 (i);
                     }
 
@@ -364,7 +497,7 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             else
             {
                 for (int i = 0; i < 16; ++i)
-                    s.add256 (mHashes[i]);
+                    s.add256 (getChildHash (i));
 
                 s.add8 (2);
             }
@@ -450,13 +583,7 @@ bool SHAMapInnerNode::isEmpty () const
 int SHAMapInnerNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return countBranches (mIsBranch);
 }
 
 #ifdef BEAST_DEBUG
@@ -492,7 +619,7 @@ SHAMapInnerNode::getString(const SHAMapNodeID & id) const
             ret += "\nb";
             ret += beast::lexicalCastThrow <std::string> (i);
             ret += " = ";
-            ret += to_string (mHashes[i]);
+            ret += to_string (getChildHash (i));
         }
     }
     return ret;
@@ -528,13 +655,19 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapAbstractNode> const& chil
     assert (mType == tnINNER);
     assert (mSeq != 0);
     assert (child.get() != this);
-    mHashes[m].zero();
     mHash.zero();
     if (child)
-        mIsBranch |= (1 << m);
-    else
-        mIsBranch &= ~ (1 << m);
-    mChildren[m] = child;
+    {
+        if (isEmptyBranch (m))
+            insertSlot (m);
+        auto& s = slot (m);
+        s.hash.zero();
+        s.set (child);
+    }
+    else if (!isEmptyBranch (m))
+    {
+        eraseSlot (m);
+    }
 }
 
 // finished modifying, now make shareable
@@ -546,7 +679,7 @@ void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> con
     assert (child);
     assert (child.get() != this);
 
-    mChildren[m] = child;
+    slot (m).set (child);
 }
 
 SHAMapAbstractNode*
@@ -555,8 +688,10 @@ SHAMapInnerNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::unique_lock <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    if (isEmptyBranch (branch))
+        return nullptr;
+
+    return slot (branch).published.load (std::memory_order_acquire);
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -565,8 +700,13 @@ SHAMapInnerNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::unique_lock <std::mutex> lock (childLock);
-    return mChildren[branch];
+    if (isEmptyBranch (branch))
+        return {};
+
+    auto& s = slot (branch);
+    if (! s.published.load (std::memory_order_acquire))
+        return {};
+    return s.child;
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -575,18 +715,24 @@ SHAMapInnerNode::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractNod
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
+
+    auto& s = slot (branch);
+    if (s.published.load (std::memory_order_acquire))
+        return s.child;
 
-    std::unique_lock <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    auto const stripe = (reinterpret_cast<std::uintptr_t> (this) >> 4) %
+        childLocks.size ();
+    std::lock_guard <std::mutex> lock (childLocks[stripe]);
+    if (s.published.load (std::memory_order_relaxed))
     {
         // There is already a node hooked up, return it
-        node = mChildren[branch];
+        node = s.child;
     }
     else
     {
         // Hook this node up
-        mChildren[branch] = node;
+        s.set (node);
     }
     return node;
 }
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <ripple/shamap/CacheSnapshot.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/protocol/digest.h>
+#include <beast/module/core/diagnostic/UnitTestUtilities.h>
+#include <beast/unit_test/suite.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ripple {
+namespace shamap {
+namespace tests {
+
+class CacheSnapshot_test : public beast::unit_test::suite
+{
+public:
+    void run ()
+    {
+        testcase ("save/load");
+
+        beast::Journal const j;
+        beast::UnitTestUtilities::TempDirectory dir ("cache_snapshot");
+        boost::filesystem::create_directories (
+            dir.getFullPathName ().toStdString ());
+        auto const path = (boost::filesystem::path (
+            dir.getFullPathName ().toStdString ()) / "snapshot").string ();
+
+        // Both families read the same memory database
+        TestFamily f (j);
+        SHAMap map (SHAMapType::STATE, f, j);
+        for (int i = 0; i < 500; ++i)
+        {
+            auto const key = sha512Half (i);
+            map.addItem (SHAMapItem (key,
+                Blob (key.begin (), key.end ())), false, false);
+        }
+        map.flushDirty (hotACCOUNT_NODE, 1);
+
+        auto const keys = f.treecache ().getKeys ();
+        expect (keys.size () > 500, "Should cache the flushed nodes");
+        expect (CacheSnapshot (f, path, j).save () == keys.size ());
+
+        TestFamily f2 (j);
+        {
+            CacheSnapshot snapshot (f2, path, j);
+            snapshot.run ();
+            expect (snapshot.loaded () == keys.size (),
+                "Should load every node");
+        }
+        int found = 0;
+        for (auto const& key : keys)
+            if (f2.treecache ().fetch (key))
+                ++found;
+        expect (found == keys.size (), "Should be cached");
+
+        // Nodes already in the cache are skipped
+        {
+            CacheSnapshot snapshot (f2, path, j);
+            snapshot.run ();
+            expect (snapshot.loaded () == 0);
+        }
+
+        testcase ("missing and invalid");
+
+        TestFamily f3 (j);
+        {
+            CacheSnapshot snapshot (f3, path + ".missing", j);
+            bool done = false;
+            snapshot.start ([&done] { done = true; });
+            snapshot.wait ();
+            expect (done, "Should call back");
+            expect (snapshot.loaded () == 0);
+        }
+        {
+            std::ofstream (path, std::ios::trunc) << "not a snapshot";
+            CacheSnapshot snapshot (f3, path, j);
+            snapshot.run ();
+            expect (snapshot.loaded () == 0);
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CacheSnapshot,shamap,ripple);
+
+} // tests
+} // shamap
+} // ripple
@@ -135,6 +135,76 @@ public:
             }
             expect (map.getHash() == uint256(), "bad final empty map hash");
         }
+
+        testInnerNodeLayout ();
+        testParallelFlush ();
+    }
+
+    // Inner nodes change between sparse and dense layouts as branches
+    // come and go. The hashes must not depend on the order of changes.
+    void testInnerNodeLayout ()
+    {
+        testcase ("inner node layout");
+
+        beast::Journal const j;
+        tests::TestFamily f (j);
+
+        std::vector<uint256> keys;
+        for (int i = 0; i < 64; ++i)
+        {
+            uint256 key;
+            key.begin()[0] = static_cast<unsigned char> (i * 4);
+            key.begin()[1] = static_cast<unsigned char> (i);
+            keys.push_back (key);
+        }
+
+        SHAMap forward (SHAMapType::FREE, f, beast::Journal());
+        SHAMap backward (SHAMapType::FREE, f, beast::Journal());
+        SHAMap half (SHAMapType::FREE, f, beast::Journal());
+        for (int i = 0; i < keys.size(); ++i)
+        {
+            forward.addItem (SHAMapItem (keys[i], IntToVUC (i)), false, false);
+            int const k = keys.size() - 1 - i;
+            backward.addItem (SHAMapItem (keys[k], IntToVUC (k)), false, false);
+            if (i % 2)
+                half.addItem (SHAMapItem (keys[i], IntToVUC (i)), false, false);
+        }
+        expect (forward.getHash () == backward.getHash (), "order changed hash");
+
+        for (int i = 0; i < keys.size(); i += 2)
+            forward.delItem (keys[i]);
+        expect (forward.getHash () == half.getHash (), "bad hash after removal");
+
+        for (int i = 1; i < keys.size(); i += 2)
+            forward.delItem (keys[i]);
+        expect (forward.getHash () == uint256 (), "bad empty map hash");
+    }
+
+    void testParallelFlush ()
+    {
+        testcase ("parallel flush");
+
+        beast::Journal const j;
+        tests::TestFamily f1 (j), f2 (j);
+        SHAMap serial (SHAMapType::FREE, f1, beast::Journal());
+        SHAMap parallel (SHAMapType::FREE, f2, beast::Journal());
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            Serializer s;
+            s.add32 (i);
+            SHAMapItem item (s.getSHA512Half(), IntToVUC (i));
+            serial.addItem (item, false, false);
+            parallel.addItem (item, false, false);
+        }
+
+        int const n1 = serial.flushDirty (hotACCOUNT_NODE, 2);
+        int const n2 = parallel.flushDirty (hotACCOUNT_NODE, 2, 4);
+        expect (n1 == n2, "flushed count differs");
+        expect (serial.getHash () == parallel.getHash (), "hash differs");
+        expect (f2.db().fetch (parallel.getHash ()) != nullptr,
+            "root not written");
+        expect (parallel.deepCompare (serial), "maps differ");
     }
 };
 
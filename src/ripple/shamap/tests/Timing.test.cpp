@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2012, 2013 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/tests/common.h>
+#include <ripple/protocol/Serializer.h>
+#include <beast/random/xor_shift_engine.h>
+#include <beast/unit_test/suite.h>
+#include <beast/unit_test/thread.h>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace ripple {
+namespace shamap {
+namespace tests {
+
+// Measures how concurrent reads of one SHAMap scale with threads.
+//
+// Every fetch descends from the root, so all threads touch the same
+// inner nodes near the top of the tree. "warm" reads a map whose nodes
+// are all hooked up. "cold" starts each run from the root alone, so the
+// threads also race to hook children into shared inner nodes.
+class Timing_test : public beast::unit_test::suite
+{
+public:
+#ifndef NDEBUG
+    std::size_t const items = 20000;
+    std::size_t const fetches = 100000;
+#else
+    std::size_t const items = 200000; // release
+    std::size_t const fetches = 2000000;
+#endif
+
+    using clock_type = std::chrono::steady_clock;
+
+    static
+    uint256
+    key (std::size_t n)
+    {
+        Serializer s;
+        s.add64 (n);
+        return s.getSHA512Half ();
+    }
+
+    static
+    std::string
+    to_string (clock_type::duration d)
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(3) <<
+            (std::chrono::duration_cast<std::chrono::milliseconds>(
+                d).count() / 1000.) << "s";
+        return ss.str();
+    }
+
+    clock_type::duration
+    fetchAll (SHAMap const& map, std::size_t threads)
+    {
+        std::atomic<std::size_t> next (0);
+        std::atomic<std::size_t> found (0);
+        std::size_t const chunk = 1000;
+
+        auto const start = clock_type::now ();
+        std::vector<beast::unit_test::thread> pool;
+        pool.reserve (threads);
+        for (std::size_t id = 0; id < threads; ++id)
+        {
+            pool.emplace_back (*this, [&, id]()
+            {
+                beast::xor_shift_engine gen (id + 1);
+                std::size_t n = 0;
+                for (;;)
+                {
+                    auto const begin = next.fetch_add (chunk);
+                    if (begin >= fetches)
+                        break;
+                    auto const end = std::min (begin + chunk, fetches);
+                    for (auto i = begin; i < end; ++i)
+                        if (map.fetch (key (gen() % items)))
+                            ++n;
+                }
+                found += n;
+            });
+        }
+        for (auto& t : pool)
+            t.join ();
+        auto const elapsed = clock_type::now () - start;
+
+        expect (found == fetches, "missing items");
+        return elapsed;
+    }
+
+    void
+    run () override
+    {
+        beast::Journal const j;
+        TestFamily f (j);
+
+        uint256 hash;
+        {
+            SHAMap map (SHAMapType::STATE, f, j);
+            for (std::size_t i = 0; i < items; ++i)
+                map.addItem (SHAMapItem (key (i), Blob (100,
+                    static_cast<unsigned char> (i))), false, false);
+            map.flushDirty (hotACCOUNT_NODE, 1);
+            hash = map.getHash ();
+        }
+
+        std::stringstream ss;
+        ss << std::left << std::setw(10) << "threads" <<
+            std::setw(10) << "warm" << std::setw(10) << "cold";
+        log << ss.str();
+
+        for (std::size_t threads : { 1, 2, 4, 8, 16, 32 })
+        {
+            SHAMap map (SHAMapType::STATE, hash, f, j);
+            map.fetchRoot (hash, nullptr);
+            map.setImmutable ();
+
+            auto const cold = fetchAll (map, threads);
+            auto const warm = fetchAll (map, threads);
+
+            ss.str ("");
+            ss << std::left << std::setw(10) << threads <<
+                std::setw(10) << to_string (warm) <<
+                std::setw(10) << to_string (cold);
+            log << ss.str();
+        }
+        pass ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Timing,shamap,ripple);
+
+} // tests
+} // shamap
+} // ripple
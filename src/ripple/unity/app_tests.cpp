@@ -23,9 +23,13 @@
 #include <ripple/app/tests/AmendmentTable.test.cpp>
 #include <ripple/app/tests/CrossingLimits_test.cpp>
 #include <ripple/app/tests/DeliverMin.test.cpp>
+#include <ripple/app/tests/IOBudget.test.cpp>
+#include <ripple/app/tests/LedgerPrefetcher_test.cpp>
 #include <ripple/app/tests/MultiSign.test.cpp>
 #include <ripple/app/tests/OfferStream.test.cpp>
 #include <ripple/app/tests/Offer.test.cpp>
+#include <ripple/app/tests/OpenLedger_test.cpp>
+#include <ripple/app/tests/ParallelApply_test.cpp>
 #include <ripple/app/tests/Path_test.cpp>
 #include <ripple/app/tests/Regression_test.cpp>
 #include <ripple/app/tests/SusPay_test.cpp>
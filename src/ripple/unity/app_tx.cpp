@@ -29,6 +29,7 @@
 #include <ripple/app/tx/impl/InboundTransactions.cpp>
 #include <ripple/app/tx/impl/LocalTxs.cpp>
 #include <ripple/app/tx/impl/OfferStream.cpp>
+#include <ripple/app/tx/impl/ParallelApply.cpp>
 #include <ripple/app/tx/impl/Payment.cpp>
 #include <ripple/app/tx/impl/SetAccount.cpp>
 #include <ripple/app/tx/impl/SetRegularKey.cpp>
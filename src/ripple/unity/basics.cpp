@@ -26,6 +26,7 @@
 #include <ripple/basics/impl/Log.cpp>
 #include <ripple/basics/impl/make_SSLContext.cpp>
 #include <ripple/basics/impl/RangeSet.cpp>
+#include <ripple/basics/impl/ScopedArena.cpp>
 #include <ripple/basics/impl/ResolverAsio.cpp>
 #include <ripple/basics/impl/strHex.cpp>
 #include <ripple/basics/impl/StringUtilities.cpp>
@@ -34,13 +35,18 @@
 #include <ripple/basics/impl/ThreadName.cpp>
 #include <ripple/basics/impl/Time.cpp>
 #include <ripple/basics/impl/UptimeTimer.cpp>
+#include <ripple/basics/impl/WorkerPool.cpp>
 
 #include <ripple/basics/tests/CheckLibraryVersions.test.cpp>
 #include <ripple/basics/tests/hardened_hash_test.cpp>
 #include <ripple/basics/tests/KeyCache.test.cpp>
 #include <ripple/basics/tests/RangeSet.test.cpp>
+#include <ripple/basics/tests/ScopedArena.test.cpp>
+#include <ripple/basics/tests/ShardedTaggedCache.test.cpp>
 #include <ripple/basics/tests/StringUtilities.test.cpp>
 #include <ripple/basics/tests/TaggedCache.test.cpp>
+#include <ripple/basics/tests/TaggedCacheTiming.test.cpp>
+#include <ripple/basics/tests/WorkerPool.test.cpp>
 
 #if DOXYGEN
 #include <ripple/basics/README.md>
@@ -33,6 +33,8 @@
 #include <ripple/ledger/impl/View.cpp>
 
 #include <ripple/ledger/tests/Directory_test.cpp>
+#include <ripple/ledger/tests/ItemTable_test.cpp>
 #include <ripple/ledger/tests/PaymentSandbox_test.cpp>
+#include <ripple/ledger/tests/PaymentTiming_test.cpp>
 #include <ripple/ledger/tests/SkipList_test.cpp>
 #include <ripple/ledger/tests/View_test.cpp>
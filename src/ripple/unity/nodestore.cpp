@@ -21,6 +21,7 @@
 
 #include <beast/nudb/nudb.cpp>
 
+#include <ripple/nodestore/backend/MappedFactory.cpp>
 #include <ripple/nodestore/backend/MemoryFactory.cpp>
 #include <ripple/nodestore/backend/NuDBFactory.cpp>
 #include <ripple/nodestore/backend/NullFactory.cpp>
@@ -30,16 +31,33 @@
 #include <ripple/nodestore/impl/BatchWriter.cpp>
 #include <ripple/nodestore/impl/DatabaseImp.h>
 #include <ripple/nodestore/impl/DatabaseRotatingImp.cpp>
+#include <ripple/nodestore/impl/DatabaseShardImp.cpp>
+#include <ripple/nodestore/impl/DatabaseTieredImp.cpp>
 #include <ripple/nodestore/impl/DummyScheduler.cpp>
 #include <ripple/nodestore/impl/DecodedBlob.cpp>
 #include <ripple/nodestore/impl/EncodedBlob.cpp>
+#include <ripple/nodestore/impl/FilteredBackend.cpp>
+#include <ripple/nodestore/impl/Importer.cpp>
 #include <ripple/nodestore/impl/ManagerImp.cpp>
 #include <ripple/nodestore/impl/NodeObject.cpp>
+#include <ripple/nodestore/impl/ReadScheduler.cpp>
 #include <ripple/nodestore/impl/ScopedMetrics.cpp>
+#include <ripple/nodestore/impl/ScopedReadPriority.cpp>
+#include <ripple/nodestore/impl/Shard.cpp>
+#include <ripple/nodestore/impl/Trace.cpp>
+#include <ripple/nodestore/impl/TracingBackend.cpp>
 
 #include <ripple/nodestore/tests/Backend.test.cpp>
 #include <ripple/nodestore/tests/Basics.test.cpp>
+#include <ripple/nodestore/tests/BatchWriter.test.cpp>
 #include <ripple/nodestore/tests/Database.test.cpp>
+#include <ripple/nodestore/tests/DatabaseShard.test.cpp>
+#include <ripple/nodestore/tests/DatabaseTiered.test.cpp>
+#include <ripple/nodestore/tests/FilteredBackend.test.cpp>
 #include <ripple/nodestore/tests/import_test.cpp>
+#include <ripple/nodestore/tests/Importer.test.cpp>
+#include <ripple/nodestore/tests/MappedBackend.test.cpp>
+#include <ripple/nodestore/tests/ReadScheduler.test.cpp>
 #include <ripple/nodestore/tests/Timing.test.cpp>
+#include <ripple/nodestore/tests/Trace.test.cpp>
 
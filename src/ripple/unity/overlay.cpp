@@ -26,10 +26,12 @@
 #include <ripple/overlay/impl/PeerImp.cpp>
 #include <ripple/overlay/impl/PeerSet.cpp>
 #include <ripple/overlay/impl/TMHello.cpp>
+#include <ripple/overlay/impl/TxVerifier.cpp>
 
 #include <ripple/overlay/tests/manifest_test.cpp>
 #include <ripple/overlay/tests/short_read.test.cpp>
 #include <ripple/overlay/tests/TMHello.test.cpp>
+#include <ripple/overlay/tests/TxVerifier.test.cpp>
 
 #if DOXYGEN
 #include <ripple/overlay/README.md>
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <ripple/shamap/impl/CacheSnapshot.cpp>
 #include <ripple/shamap/impl/SHAMap.cpp>
 #include <ripple/shamap/impl/SHAMapDelta.cpp>
 #include <ripple/shamap/impl/SHAMapItem.cpp>
@@ -25,6 +26,8 @@
 #include <ripple/shamap/impl/SHAMapNodeID.cpp>
 #include <ripple/shamap/impl/SHAMapSync.cpp>
 #include <ripple/shamap/impl/SHAMapTreeNode.cpp>
+#include <ripple/shamap/tests/CacheSnapshot.test.cpp>
 #include <ripple/shamap/tests/FetchPack.test.cpp>
 #include <ripple/shamap/tests/SHAMap.test.cpp>
 #include <ripple/shamap/tests/SHAMapSync.test.cpp>
+#include <ripple/shamap/tests/Timing.test.cpp>